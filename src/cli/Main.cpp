@@ -30,6 +30,7 @@
 #include <algorithm>
 #include <fstream>
 #include <iostream>
+#include <map>
 #include <ostream>
 #include <set>
 
@@ -40,6 +41,7 @@
 #include <core/common/Rtti.hpp>
 #include <core/frontend/TerminalLogger.hpp>
 #include <core/managed/Manager.hpp>
+#include <core/model/BinaryGraph.hpp>
 #include <core/model/Document.hpp>
 #include <core/model/Ontology.hpp>
 #include <core/model/Project.hpp>
@@ -48,6 +50,8 @@
 #include <core/parser/ParserScope.hpp>
 #include <core/resource/ResourceManager.hpp>
 #include <plugins/filesystem/FileLocator.hpp>
+#include <plugins/filesystem/FileResourceCache.hpp>
+#include <plugins/filesystem/MappedFile.hpp>
 #include <plugins/html/DemoOutput.hpp>
 #include <formats/osxml/OsxmlParser.hpp>
 #include <formats/osml/OsmlParser.hpp>
@@ -77,11 +81,11 @@ const char *MSG_COPYING =
     "MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the\n"
     "GNU General Public License for more details.\n";
 
-const std::set<std::string> formats{"html", "xml"};
+const std::set<std::string> formats{"html", "osbg", "xml"};
 
 static void createOutput(Handle<Document> doc, std::ostream &out,
                          const std::string &format, bool flat, Logger &logger,
-                         ResourceManager &resMgr)
+                         ResourceManager &resMgr, Handle<Project> project)
 {
 	if (format == "html") {
 		html::DemoHTMLTransformer transform;
@@ -89,7 +93,74 @@ static void createOutput(Handle<Document> doc, std::ostream &out,
 	} else if (format == "xml") {
 		xml::XmlTransformer transform;
 		transform.writeXml(doc, out, logger, resMgr, true, flat);
+	} else if (format == "osbg") {
+		// The ontologies and typesystems used by the document are written
+		// along with it, only the system typesystem is shared
+		std::string data;
+		if (BinaryGraphWriter({project->getSystemTypesystem()})
+		        .write(doc, data)) {
+			out.write(data.data(), data.size());
+		} else {
+			logger.error("The document cannot be written as binary graph");
+		}
+	}
+}
+
+static void writeManagerStatistics(const Manager &manager, std::ostream &out)
+{
+	const Manager::Statistics stats = manager.getStatistics();
+	out << "{\n"
+	    << "\t\"sweeps\": " << stats.sweeps << ",\n"
+	    << "\t\"sweepTimeTotalNs\": " << stats.sweepTimeTotal << ",\n"
+	    << "\t\"sweepTimeMaxNs\": " << stats.sweepTimeMax << ",\n"
+	    << "\t\"sweepLatencyHistogramUs\": [";
+	for (size_t i = 0; i < stats.sweepLatency.size(); i++) {
+		out << (i > 0 ? ", " : "") << stats.sweepLatency[i];
+	}
+	out << "],\n"
+	    << "\t\"objectsVisited\": " << stats.objectsVisited << ",\n"
+	    << "\t\"objectsFreed\": " << stats.objectsFreed << ",\n"
+	    << "\t\"liveObjects\": " << stats.liveObjects << ",\n"
+	    << "\t\"peakObjects\": " << stats.peakObjects << ",\n"
+	    << "\t\"markedObjects\": " << stats.markedObjects << ",\n"
+	    << "\t\"storeEntries\": " << stats.storeEntries << ",\n"
+	    << "\t\"eventEntries\": " << stats.eventEntries << ",\n"
+	    << "\t\"liveObjectsByType\": {";
+
+	// Sort the types by name to get a stable output
+	std::map<std::string, Manager::AllocationStatistics> types;
+	for (const auto &e : manager.getAllocationStatistics()) {
+		Manager::AllocationStatistics &t = types[e.first->name];
+		t.count += e.second.count;
+		t.bytes += e.second.bytes;
+	}
+	bool first = true;
+	for (const auto &e : types) {
+		out << (first ? "\n" : ",\n") << "\t\t\"" << e.first << "\": {"
+		    << "\"count\": " << e.second.count << ", \"bytes\": "
+		    << e.second.bytes << "}";
+		first = false;
+	}
+	out << (first ? "}\n" : "\n\t}\n") << "}" << std::endl;
+}
+
+static void dumpManagerStatistics(const Manager &manager,
+                                  const std::string &path, Logger &logger)
+{
+	if (path.empty()) {
+		return;
+	}
+	if (path == "-") {
+		writeManagerStatistics(manager, std::cout);
+		return;
+	}
+	std::ofstream out{path};
+	if (!out.good()) {
+		logger.error("Cannot write garbage collector statistics to \"" +
+		             path + "\"");
+		return;
 	}
+	writeManagerStatistics(manager, out);
 }
 
 int main(int argc, char **argv)
@@ -106,6 +177,8 @@ int main(int argc, char **argv)
 	std::string outputPath;
 	std::string format;
 	bool flat;
+	std::string gcStatsPath;
+	std::string cacheDir;
 #ifdef MANAGER_GRAPHVIZ_EXPORT
 	std::string graphvizPath;
 #endif
@@ -125,10 +198,19 @@ int main(int argc, char **argv)
 	    "output,o", po::value<std::string>(&outputPath),
 	    "The output file name. Per default the input file name will be used.")(
 	    "format,F", po::value<std::string>(&format),
-	    "The output format that shall be produced (default is \"xml\").")(
+	    "The output format that shall be produced: \"html\", \"osbg\" (binary "
+	    "graph, can be read again by passing a .osbg file as input) or "
+	    "\"xml\" (default).")(
 	    "flat,f", po::bool_switch(&flat)->default_value(false),
 	    "Works only for XML output. This serializes all referenced ontologies "
-		"and typesystems into the output file."
+		"and typesystems into the output file.")(
+	    "gc-stats", po::value<std::string>(&gcStatsPath),
+	    "If set, writes garbage collector statistics as JSON to the given "
+	    "file (\"-\" for stdout) after the run.")(
+	    "cache-dir", po::value<std::string>(&cacheDir),
+	    "If set, parsed ontologies and typesystems are cached between runs "
+	    "in the given directory. Clear the directory when switching to a "
+	    "different build of ousia."
 #ifdef MANAGER_GRAPHVIZ_EXPORT
 	    )(
 	    "graphviz,G", po::value<std::string>(&graphvizPath),
@@ -211,10 +293,16 @@ int main(int argc, char **argv)
 		logger.warning("The \'flat\' option is only valid for xml output. It will be ignored.");
 	}
 
-	// initialize global instances.
+	// initialize global instances. The object graph is thrown away as a whole
+	// once we are done, so allocate the nodes from the arena of the manager.
 	Manager manager;
+	manager.enableArena();
 	Registry registry;
 	ResourceManager resourceManager;
+	FileResourceCache resourceCache{cacheDir};
+	if (!cacheDir.empty()) {
+		resourceManager.setCache(&resourceCache);
+	}
 	ParserScope scope;
 	Rooted<Project> project{new Project(manager)};
 	FileLocator fileLocator;
@@ -252,8 +340,27 @@ int main(int argc, char **argv)
 	}
 
 	// now all preparation is done and we can parse the input document.
-	Rooted<Node> docNode =
-	    context.import(inputPath, "", "", {&RttiTypes::Document});
+	// Binary graphs written with "-F osbg" are read in place.
+	Rooted<Node> docNode;
+	if (fs::path{inputPath}.extension() == ".osbg") {
+		try {
+			MappedFile file{inputPath};
+			Rooted<Node> node = BinaryGraphReader::read(
+			    manager, file.getData(), file.getSize(),
+			    {project->getSystemTypesystem()});
+			if (node->isa(&RttiTypes::Document)) {
+				docNode = node;
+			} else {
+				logger.error("Input file \"" + inputPath +
+				             "\" does not contain a document");
+			}
+		}
+		catch (LoggableException &ex) {
+			logger.log(ex);
+		}
+	} else {
+		docNode = context.import(inputPath, "", "", {&RttiTypes::Document});
+	}
 
 #ifdef MANAGER_GRAPHVIZ_EXPORT
 	if (!graphvizPath.empty()) {
@@ -267,16 +374,24 @@ int main(int argc, char **argv)
 
 	if (logger.hasError() || docNode == nullptr) {
 		logger.fatalError("Errors occured while parsing the document");
+		dumpManagerStatistics(manager, gcStatsPath, logger);
+		manager.bulkTeardown();
 		return ERROR_IN_DOCUMENT;
 	}
 	Rooted<Document> doc = docNode.cast<Document>();
 	// write output
 	if (outputPath != "-") {
 		std::ofstream out{outputPath};
-		createOutput(doc, out, format, flat, logger, resourceManager);
+		createOutput(doc, out, format, flat, logger, resourceManager,
+		             project);
 	} else {
-		createOutput(doc, std::cout, format, flat, logger, resourceManager);
+		createOutput(doc, std::cout, format, flat, logger, resourceManager,
+		             project);
 	}
 
+	dumpManagerStatistics(manager, gcStatsPath, logger);
+
+	// Skip the reference bookkeeping while the object graph is destroyed
+	manager.bulkTeardown();
 	return SUCCESS;
 }
@@ -22,6 +22,7 @@
 #include <sstream>
 
 #include "CharReader.hpp"
+#include "CharScanner.hpp"
 #include "Utils.hpp"
 
 namespace ousia {
@@ -46,26 +47,70 @@ static size_t istreamReadCallback(char *buf, size_t size, void *userData)
 
 /* Class Buffer */
 
-Buffer::Buffer(ReadCallback callback, void *userData)
+Buffer::Buffer(ReadCallback callback, void *userData, Storage storage)
     : callback(callback),
       userData(userData),
       reachedEnd(false),
+      flat(nullptr),
+      flatSize(0),
+      flatMask(0),
+      flatStart(0),
+      flatEnd(0),
       startBucket(buckets.end()),
       endBucket(buckets.end()),
       startOffset(0),
       firstDead(0)
 {
+	// Allocate the initial ring
+	if (storage == Storage::RING) {
+		ring.resize(REQUEST_SIZE);
+		flat = ring.data();
+		flatSize = ring.size();
+		flatMask = flatSize - 1;
+	}
+
 	// Load a first block of data from the stream
 	stream();
 	startBucket = buckets.begin();
 }
 
-Buffer::Buffer(std::istream &istream) : Buffer(istreamReadCallback, &istream) {}
+Buffer::Buffer(std::istream &istream, Storage storage)
+    : Buffer(istreamReadCallback, &istream, storage)
+{
+}
+
+Buffer::Buffer(std::shared_ptr<std::istream> istream, Storage storage)
+    : Buffer(istreamReadCallback, istream.get(), storage)
+{
+	owner = istream;
+}
+
+Buffer::Buffer(const char *data, size_t size, std::shared_ptr<void> owner)
+    : callback(nullptr),
+      userData(nullptr),
+      reachedEnd(true),
+      flat(data),
+      flatSize(size),
+      flatMask(std::numeric_limits<size_t>::max()),
+      flatStart(0),
+      flatEnd(size),
+      owner(owner),
+      startBucket(buckets.end()),
+      endBucket(buckets.end()),
+      startOffset(0),
+      firstDead(0)
+{
+}
 
 Buffer::Buffer(const std::string &str)
     : callback(nullptr),
       userData(nullptr),
       reachedEnd(true),
+      flat(nullptr),
+      flatSize(0),
+      flatMask(0),
+      flatStart(0),
+      flatEnd(0),
       startBucket(buckets.end()),
       endBucket(buckets.end()),
       startOffset(0),
@@ -135,6 +180,23 @@ Buffer::Bucket &Buffer::nextBucket()
 		}
 	}
 
+	// Release all but one of the buckets no longer reachable by any cursor,
+	// so the memory held by the Buffer shrinks once the cursors span less
+	// data than before
+	if (minBucketIdx > 1 && minBucketIdx != MAXVAL) {
+		const size_t released = minBucketIdx - 1;
+		for (size_t i = 0; i < released; i++) {
+			startOffset += startBucket->size();
+			BucketIterator it = startBucket;
+			advance(startBucket);
+			buckets.erase(it);
+		}
+		for (size_t i = 0; i < cursors.size(); i++) {
+			cursors[i].bucketIdx -= released;
+		}
+		minBucketIdx = 1;
+	}
+
 	// If there is space between the current start bucket and the read
 	// cursor, the start bucket can be safely overridden.
 	if (minBucketIdx > 0 && minBucketIdx != MAXVAL) {
@@ -190,6 +252,11 @@ Buffer::CursorId Buffer::nextCursor()
 
 void Buffer::stream()
 {
+	if (flat) {
+		streamRing();
+		return;
+	}
+
 	// Fetch the bucket into which the data should be inserted, make sure it
 	// has the correct size
 	Bucket &tar = nextBucket();
@@ -205,12 +272,58 @@ void Buffer::stream()
 	}
 }
 
+void Buffer::streamRing()
+{
+	// Fetch the smallest offset that must still be reachable by the cursors
+	size_t minOffs = flatEnd;
+	for (size_t i = 0; i < cursors.size(); i++) {
+		if (alive[i]) {
+			minOffs = std::min(minOffs, cursors[i].bucketOffs);
+		}
+	}
+	minOffs = minOffs > LOOKBACK_SIZE ? minOffs - LOOKBACK_SIZE : 0;
+	flatStart = std::max(flatStart, minOffs);
+
+	// Double the size of the ring until the new data fits without overriding
+	// reachable data, relocate the reachable data into the new ring
+	const size_t required = flatEnd - flatStart + REQUEST_SIZE;
+	if (required > ring.size()) {
+		size_t capacity = ring.size();
+		while (capacity < required) {
+			capacity *= 2;
+		}
+		std::vector<char> newRing(capacity);
+		for (size_t offs = flatStart; offs < flatEnd; offs++) {
+			newRing[offs & (capacity - 1)] = ring[offs & flatMask];
+		}
+		ring.swap(newRing);
+		flat = ring.data();
+		flatSize = ring.size();
+		flatMask = flatSize - 1;
+	}
+
+	// Read the data from the stream, split the request into two parts if it
+	// wraps around at the end of the ring
+	const size_t pos = flatEnd & flatMask;
+	const size_t n1 = std::min(flatSize - pos, size_t(REQUEST_SIZE));
+	size_t size = callback(&ring[pos], n1, userData);
+	if (size == n1 && n1 < REQUEST_SIZE) {
+		size += callback(&ring[0], REQUEST_SIZE - n1, userData);
+	}
+	flatEnd += size;
+
+	// If not enough bytes were returned, we're at the end of the stream
+	if (size < REQUEST_SIZE) {
+		reachedEnd = true;
+	}
+}
+
 Buffer::CursorId Buffer::createCursor()
 {
 	CursorId res = nextCursor();
 	cursors[res].bucket = startBucket;
 	cursors[res].bucketIdx = 0;
-	cursors[res].bucketOffs = 0;
+	cursors[res].bucketOffs = flatStart;
 	return res;
 }
 
@@ -235,6 +348,9 @@ void Buffer::deleteCursor(Buffer::CursorId cursor)
 size_t Buffer::offset(Buffer::CursorId cursor) const
 {
 	const Cursor &cur = cursors[cursor];
+	if (flat) {
+		return cur.bucketOffs;
+	}
 	size_t offs = startOffset + cur.bucketOffs;
 	BucketList::const_iterator it = startBucket;
 	while (it != cur.bucket) {
@@ -248,6 +364,14 @@ size_t Buffer::moveForward(CursorId cursor, size_t relativeOffs)
 {
 	size_t offs = relativeOffs;
 	Cursor &cur = cursors[cursor];
+	if (flat) {
+		while (flatEnd - cur.bucketOffs < offs && !reachedEnd) {
+			stream();
+		}
+		offs = std::min(offs, flatEnd - cur.bucketOffs);
+		cur.bucketOffs += offs;
+		return offs;
+	}
 	while (offs > 0) {
 		// Fetch the current bucket of the cursor
 		Bucket &bucket = *(cur.bucket);
@@ -286,6 +410,11 @@ size_t Buffer::moveBackward(CursorId cursor, size_t relativeOffs)
 {
 	size_t offs = relativeOffs;
 	Cursor &cur = cursors[cursor];
+	if (flat) {
+		offs = std::min(offs, cur.bucketOffs - flatStart);
+		cur.bucketOffs -= offs;
+		return offs;
+	}
 	while (offs > 0) {
 		// If there is enough space in the bucket, simply decrement the bucket
 		// offset by the given relative offset
@@ -345,6 +474,9 @@ size_t Buffer::seekCursor(CursorId cursor, size_t offs)
 bool Buffer::atEnd(Buffer::CursorId cursor) const
 {
 	const Cursor &c = cursors[cursor];
+	if (flat) {
+		return reachedEnd && c.bucketOffs == flatEnd;
+	}
 	return reachedEnd &&
 	       (c.bucket == endBucket && c.bucketOffs == endBucket->size());
 }
@@ -352,6 +484,21 @@ bool Buffer::atEnd(Buffer::CursorId cursor) const
 inline bool Buffer::fetchCharacter(CursorId cursor, char &c, bool incr)
 {
 	Cursor &cur = cursors[cursor];
+	if (flat) {
+		while (true) {
+			if (cur.bucketOffs < flatEnd) {
+				c = flat[cur.bucketOffs & flatMask];
+				if (incr) {
+					cur.bucketOffs++;
+				}
+				return true;
+			}
+			if (reachedEnd) {
+				return false;
+			}
+			stream();
+		}
+	}
 	while (true) {
 		// Reference at the current bucket
 		Bucket &bucket = *(cur.bucket);
@@ -389,11 +536,95 @@ bool Buffer::fetch(CursorId cursor, char &c)
 	return fetchCharacter(cursor, c, false);
 }
 
+size_t Buffer::read(CursorId cursor, char *buf, size_t size)
+{
+	Cursor &cur = cursors[cursor];
+	size_t res = 0;
+	while (flat && res < size) {
+		// Copy the contiguous part of the available data
+		if (cur.bucketOffs < flatEnd) {
+			const size_t pos = cur.bucketOffs & flatMask;
+			const size_t n = std::min(
+			    {flatEnd - cur.bucketOffs, flatSize - pos, size - res});
+			std::copy(flat + pos, flat + pos + n, buf + res);
+			cur.bucketOffs += n;
+			res += n;
+		} else if (reachedEnd) {
+			break;
+		} else {
+			stream();
+		}
+	}
+	while (!flat && res < size) {
+		// Copy as many bytes as possible from the current bucket
+		const Bucket &bucket = *(cur.bucket);
+		const size_t available = bucket.size() - cur.bucketOffs;
+		if (available > 0) {
+			const size_t n = std::min(available, size - res);
+			std::copy(bucket.begin() + cur.bucketOffs,
+			          bucket.begin() + cur.bucketOffs + n, buf + res);
+			cur.bucketOffs += n;
+			res += n;
+			continue;
+		}
+
+		// Load new data if this is the last bucket, abort if the end of the
+		// stream has been reached
+		if (cur.bucket == endBucket) {
+			if (reachedEnd) {
+				break;
+			}
+			stream();
+		}
+
+		// Go to the next bucket
+		cur.bucketIdx++;
+		cur.bucketOffs = 0;
+		advance(cur.bucket);
+	}
+	return res;
+}
+
+size_t Buffer::span(CursorId cursor, const char *&data)
+{
+	Cursor &cur = cursors[cursor];
+	while (true) {
+		if (flat) {
+			if (cur.bucketOffs < flatEnd) {
+				const size_t pos = cur.bucketOffs & flatMask;
+				data = flat + pos;
+				return std::min(flatEnd - cur.bucketOffs, flatSize - pos);
+			}
+		} else {
+			const Bucket &bucket = *(cur.bucket);
+			if (cur.bucketOffs < bucket.size()) {
+				data = bucket.data() + cur.bucketOffs;
+				return bucket.size() - cur.bucketOffs;
+			}
+			if (cur.bucket != endBucket) {
+				// Go to the next bucket
+				cur.bucketIdx++;
+				cur.bucketOffs = 0;
+				advance(cur.bucket);
+				continue;
+			}
+		}
+
+		// Load new data if possible
+		if (reachedEnd) {
+			return 0;
+		}
+		stream();
+	}
+}
+
 /* CharReader class */
 
 CharReader::CharReader(std::shared_ptr<Buffer> buffer, SourceId sourceId,
                        size_t offs)
-    : buffer(buffer),
+    : cleanStart(0),
+      cleanEnd(0),
+      buffer(buffer),
       readCursor(buffer->createCursor()),
       peekCursor(buffer->createCursor()),
       coherent(true),
@@ -402,8 +633,15 @@ CharReader::CharReader(std::shared_ptr<Buffer> buffer, SourceId sourceId,
 {
 }
 
+CharReader::CharReader(std::shared_ptr<Buffer> buffer, SourceId sourceId)
+    : CharReader(buffer, sourceId, 0)
+{
+}
+
 CharReader::CharReader(CharReader &&other) noexcept
-    : buffer(std::move(other.buffer)),
+    : cleanStart(other.cleanStart),
+      cleanEnd(other.cleanEnd),
+      buffer(std::move(other.buffer)),
       readCursor(other.readCursor),
       peekCursor(other.peekCursor),
       coherent(other.coherent),
@@ -454,6 +692,88 @@ bool CharReader::readAtCursor(Buffer::CursorId &cursor, char &c)
 	return true;
 }
 
+size_t CharReader::spanAtCursor(Buffer::CursorId cursor, const char *&data)
+{
+	// Linebreak sequences are returned as single character span containing
+	// the substituted character
+	static const char LINEBREAK = '\n';
+
+	const char *raw;
+	const size_t size = buffer->span(cursor, raw);
+	if (size == 0) {
+		return 0;
+	}
+
+	// Reuse the result of the last scan if the cursor is still inside the
+	// clean region
+	const size_t pos = buffer->offset(cursor);
+	if (pos >= cleanStart && pos < cleanEnd) {
+		data = raw;
+		return std::min(size, cleanEnd - pos);
+	}
+
+	// Search for the first '\r', the characters before it do not need to be
+	// substituted. A trailing '\n' is excluded, as it may be continued by a
+	// '\r' (possibly in the next chunk of memory)
+	static const CharScanner CARRIAGE_RETURN{"\r"};
+	size_t len = CARRIAGE_RETURN.find(raw, size);
+	if (len > 0 && raw[len - 1] == '\n') {
+		len--;
+	}
+	if (len == 0) {
+		data = &LINEBREAK;
+		return 1;
+	}
+	cleanStart = pos;
+	cleanEnd = pos + len;
+	data = raw;
+	return len;
+}
+
+void CharReader::advanceCursor(Buffer::CursorId &cursor, size_t n)
+{
+	// Move the cursor directly if the characters are inside the clean region,
+	// otherwise read the characters one by one
+	const size_t pos = buffer->offset(cursor);
+	if (pos >= cleanStart && pos + n <= cleanEnd) {
+		buffer->moveCursor(cursor, n);
+	} else {
+		char c;
+		for (size_t i = 0; i < n && readAtCursor(cursor, c); i++) {
+		}
+	}
+}
+
+size_t CharReader::span(const char *&data)
+{
+	resetPeek();
+	return spanAtCursor(readCursor, data);
+}
+
+void CharReader::consume(size_t n)
+{
+	advanceCursor(readCursor, n);
+	buffer->copyCursor(readCursor, peekCursor);
+	coherent = true;
+}
+
+size_t CharReader::peekSpan(const char *&data)
+{
+	if (coherent) {
+		return spanAtCursor(readCursor, data);
+	}
+	return spanAtCursor(peekCursor, data);
+}
+
+void CharReader::skipPeek(size_t n)
+{
+	if (coherent) {
+		buffer->copyCursor(readCursor, peekCursor);
+		coherent = false;
+	}
+	advanceCursor(peekCursor, n);
+}
+
 bool CharReader::peek(char &c)
 {
 	// If the reader was coherent, update the peek cursor state
@@ -538,13 +858,9 @@ CharReaderFork CharReader::fork()
 
 size_t CharReader::readRaw(char *buf, size_t size)
 {
-	// TODO: This is inefficient, implement ranged read in the Buffer class and
-	// use it
-	size_t res = 0;
-	while (res < size && read(*buf)) {
-		buf++;
-		res++;
-	}
+	const size_t res = buffer->read(readCursor, buf, size);
+	buffer->copyCursor(readCursor, peekCursor);
+	coherent = true;
 	return res;
 }
 
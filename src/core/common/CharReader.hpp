@@ -39,7 +39,12 @@ namespace ousia {
 /**
  * A chunked ring buffer used in CharReader to provide access to an input stream
  * with multiple read cursors. The Buffer automatically expands to the size of
- * the spanned by the read cursors while reusing already allocated memory.
+ * the spanned by the read cursors while reusing already allocated memory and
+ * releases memory which is no longer reachable by any cursor.
+ * Alternatively the streamed data may be stored in a single contiguous ring of
+ * power-of-two size, or the Buffer may directly operate on a read-only memory
+ * region (e.g. a memory mapped file). In the latter two cases cursors are
+ * plain offsets and no bucket list has to be traversed.
  */
 class Buffer {
 public:
@@ -62,6 +67,22 @@ public:
 	 */
 	using CursorId = size_t;
 
+	/**
+	 * Specifies how data read from an input stream is stored.
+	 */
+	enum class Storage {
+		/**
+		 * The data is stored in a list of separately allocated buckets.
+		 */
+		BUCKETS,
+
+		/**
+		 * The data is stored in a single ring of power-of-two size, which is
+		 * doubled whenever the cursors span more than its capacity.
+		 */
+		RING
+	};
+
 private:
 	/**
 	 * Number of bytes to request from the input stream. Set to 64 KiB because
@@ -106,7 +127,9 @@ private:
 		size_t bucketIdx;
 
 		/**
-		 * Current offset within that bucket.
+		 * Current offset within that bucket. If the Buffer operates on
+		 * contiguous memory (see flat), this is the absolute offset relative
+		 * to the beginning of the stream.
 		 */
 		size_t bucketOffs;
 	};
@@ -144,6 +167,48 @@ private:
 	 */
 	bool reachedEnd;
 
+	/**
+	 * Contiguous memory used in RING storage mode.
+	 */
+	std::vector<char> ring;
+
+	/**
+	 * Pointer at the contiguous memory the Buffer is reading from, either the
+	 * ring or an external memory region. Set to nullptr if the data is stored
+	 * in the bucket list. If set, the byte at the absolute offset offs is
+	 * located at flat[offs & flatMask].
+	 */
+	const char *flat;
+
+	/**
+	 * Size of the contiguous memory in bytes.
+	 */
+	size_t flatSize;
+
+	/**
+	 * Mask applied to absolute offsets. Set to capacity - 1 for the ring and
+	 * to all ones for an external memory region.
+	 */
+	size_t flatMask;
+
+	/**
+	 * Absolute offset of the first byte still available in the contiguous
+	 * memory.
+	 */
+	size_t flatStart;
+
+	/**
+	 * Absolute offset one past the last byte available in the contiguous
+	 * memory.
+	 */
+	size_t flatEnd;
+
+	/**
+	 * Object which is kept alive as long as the Buffer exists, e.g. the
+	 * memory mapping the span is pointing at or an owned input stream.
+	 */
+	std::shared_ptr<void> owner;
+
 	/**
 	 * Iterator pointing at the current start bucket.
 	 */
@@ -196,6 +261,12 @@ private:
 	 */
 	void stream();
 
+	/**
+	 * Reads data from the input stream into the ring, grows the ring if the
+	 * new data would override data still reachable by one of the cursors.
+	 */
+	void streamRing();
+
 	/**
 	 * Moves the given cursor forward.
 	 */
@@ -222,16 +293,42 @@ public:
 	 * this read request.
 	 * @param userData is a pointer to user defined data which will be passed to
 	 * the callback function.
+	 * @param storage specifies how the streamed data should be stored.
 	 */
-	Buffer(ReadCallback callback, void *userData);
+	Buffer(ReadCallback callback, void *userData,
+	       Storage storage = Storage::BUCKETS);
 
 	/**
 	 * Initializes the Buffer with a reference to an std::istream from which
 	 * data will be read.
 	 *
 	 * @param istream is the input stream from which the data should be read.
+	 * @param storage specifies how the streamed data should be stored.
 	 */
-	Buffer(std::istream &istream);
+	Buffer(std::istream &istream, Storage storage = Storage::BUCKETS);
+
+	/**
+	 * Initializes the Buffer with an input stream which is owned by the
+	 * Buffer.
+	 *
+	 * @param istream is the input stream from which the data should be read.
+	 * The stream is freed once the Buffer and all other references to it are
+	 * freed.
+	 * @param storage specifies how the streamed data should be stored.
+	 */
+	Buffer(std::shared_ptr<std::istream> istream,
+	       Storage storage = Storage::BUCKETS);
+
+	/**
+	 * Initializes the Buffer with an external, read-only memory region. The
+	 * data is not copied.
+	 *
+	 * @param data is a pointer at the first byte of the memory region.
+	 * @param size is the size of the memory region in bytes.
+	 * @param owner is an object responsible for keeping the memory region
+	 * alive. It is held by the Buffer until the Buffer is destroyed.
+	 */
+	Buffer(const char *data, size_t size, std::shared_ptr<void> owner);
 
 	/**
 	 * Initializes the Buffer with the contents of the given string, after
@@ -355,6 +452,32 @@ public:
 	 * stream has been reached.
 	 */
 	bool fetch(CursorId cursor, char &c);
+
+	/**
+	 * Copies up to the given number of bytes from the ring buffer into the
+	 * given memory region, starting at the given cursor. The data is copied
+	 * bucket by bucket and the cursor is advanced past the read data.
+	 *
+	 * @param cursor specifies the cursor from which the data should be read.
+	 * @param buf is the target memory region.
+	 * @param size is the maximum number of bytes that should be read.
+	 * @return the number of bytes read. A value smaller than size indicates
+	 * that the end of the stream has been reached.
+	 */
+	size_t read(CursorId cursor, char *buf, size_t size);
+
+	/**
+	 * Returns the contiguous memory region starting at the given cursor
+	 * without copying it. The cursor is not advanced, use moveCursor() to
+	 * consume the data.
+	 *
+	 * @param cursor specifies the cursor at which the region should start.
+	 * @param data is set to a pointer at the first byte of the region. The
+	 * pointer is only valid until the next operation on the Buffer.
+	 * @return the number of bytes in the region. Zero is only returned if the
+	 * end of the stream has been reached.
+	 */
+	size_t span(CursorId cursor, const char *&data);
 };
 
 // Forward declaration
@@ -387,6 +510,38 @@ private:
 	 */
 	bool readAtCursor(Buffer::CursorId &cursor, char &c);
 
+	/**
+	 * Returns the next span of linebreak-normalized characters at the given
+	 * cursor.
+	 *
+	 * @param cursor is the cursor at which the span should start.
+	 * @param data is set to a pointer at the first character of the span.
+	 * @return the number of characters in the span.
+	 */
+	size_t spanAtCursor(Buffer::CursorId cursor, const char *&data);
+
+	/**
+	 * Advances the given cursor by the given number of linebreak-normalized
+	 * characters.
+	 *
+	 * @param cursor is the cursor that should be advanced.
+	 * @param n is the number of characters the cursor should be advanced by.
+	 */
+	void advanceCursor(Buffer::CursorId &cursor, size_t n);
+
+	/**
+	 * Start of the last region of the underlying Buffer which is known to
+	 * contain no linebreak sequences that need to be substituted (in bytes
+	 * relative to the beginning of the buffer).
+	 */
+	size_t cleanStart;
+
+	/**
+	 * End of the last region of the underlying Buffer which is known to
+	 * contain no linebreak sequences that need to be substituted.
+	 */
+	size_t cleanEnd;
+
 protected:
 	/**
 	 * Reference pointing at the underlying buffer.
@@ -433,6 +588,16 @@ protected:
 	CharReader(std::shared_ptr<Buffer> buffer, SourceId sourceId, size_t offs);
 
 public:
+	/**
+	 * Creates a new CharReader instance reading from the given Buffer.
+	 *
+	 * @param buffer is the Buffer from which the data should be read. The
+	 * reader starts at the beginning of the buffer.
+	 * @param sourceId is the ID of the underlying source file.
+	 */
+	CharReader(std::shared_ptr<Buffer> buffer,
+	           SourceId sourceId = InvalidSourceId);
+
 	/**
 	 * Creates a new CharReader instance from a string.
 	 *
@@ -535,6 +700,49 @@ public:
 	 */
 	void consumePeek();
 
+	/**
+	 * Returns the longest span of characters at the read cursor which can be
+	 * accessed directly, without copying. Linebreaks within the span are
+	 * already normalized, i.e. the span contains exactly the characters
+	 * read() would return. The peek cursor is reset to the read cursor. Use
+	 * consume() to advance the read cursor.
+	 *
+	 * @param data is set to a pointer at the first character of the span. The
+	 * pointer is only valid until the next operation on the CharReader.
+	 * @return the number of characters in the span. Zero is only returned if
+	 * the end of the stream has been reached.
+	 */
+	size_t span(const char *&data);
+
+	/**
+	 * Advances the read cursor by the given number of characters, e.g. after
+	 * a span returned by span() has been processed. Resets the peek cursor to
+	 * the read cursor.
+	 *
+	 * @param n is the number of characters that should be consumed.
+	 */
+	void consume(size_t n);
+
+	/**
+	 * Same as span(), but returns the span starting at the peek cursor. The
+	 * read cursor is not touched. Use skipPeek() to advance the peek cursor.
+	 *
+	 * @param data is set to a pointer at the first character of the span. The
+	 * pointer is only valid until the next operation on the CharReader.
+	 * @return the number of characters in the span. Zero is only returned if
+	 * the end of the stream has been reached.
+	 */
+	size_t peekSpan(const char *&data);
+
+	/**
+	 * Advances the peek cursor by the given number of characters, as if peek()
+	 * was called n times.
+	 *
+	 * @param n is the number of characters the peek cursor should be advanced
+	 * by.
+	 */
+	void skipPeek(size_t n);
+
 	/**
 	 * Moves the read cursor to the next non-whitespace character. Returns
 	 * false, if the end of the stream was reached.
@@ -555,8 +763,9 @@ public:
 	CharReaderFork fork();
 
 	/**
-	 * Reads raw data from the CharReader without any processing. Data is always
-	 * read from the read cursor.
+	 * Reads raw data from the CharReader without any processing (linebreaks
+	 * are not substituted). Data is always read from the read cursor, the peek
+	 * cursor is reset to the read cursor.
 	 *
 	 * @param buf is the target memory buffer.
 	 * @param size is the number of bytes to be read.
@@ -0,0 +1,205 @@
+/*
+    Ousía
+    Copyright (C) 2014, 2015  Benjamin Paaßen, Andreas Stöckel
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "CharScanner.hpp"
+
+// The vectorized implementations are only available on x86-64 (where SSE2 is
+// always present) and with compilers supporting function target attributes
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define OUSIA_CHAR_SCANNER_X86
+#include <immintrin.h>
+#endif
+
+namespace ousia {
+
+/* Search implementations */
+
+/**
+ * Function type of the vectorized search implementations.
+ */
+using FindFunction = size_t (*)(const char *data, size_t size,
+                                const char *chars, size_t count,
+                                const bool *table);
+
+/**
+ * Scalar search implementation using the lookup table.
+ */
+static size_t findScalar(const char *data, size_t size, const char *,
+                         size_t, const bool *table)
+{
+	for (size_t i = 0; i < size; i++) {
+		if (table[static_cast<unsigned char>(data[i])]) {
+			return i;
+		}
+	}
+	return size;
+}
+
+#ifdef OUSIA_CHAR_SCANNER_X86
+
+/**
+ * SSE2 search implementation, compares 16 bytes with each character in the
+ * set at once.
+ */
+static size_t findSse2(const char *data, size_t size, const char *chars,
+                       size_t count, const bool *table)
+{
+	__m128i needles[CharScanner::MAX_VECTOR_CHARS];
+	for (size_t j = 0; j < count; j++) {
+		needles[j] = _mm_set1_epi8(chars[j]);
+	}
+
+	size_t i = 0;
+	for (; i + 16 <= size; i += 16) {
+		const __m128i v =
+		    _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+		__m128i m = _mm_cmpeq_epi8(v, needles[0]);
+		for (size_t j = 1; j < count; j++) {
+			m = _mm_or_si128(m, _mm_cmpeq_epi8(v, needles[j]));
+		}
+		const int mask = _mm_movemask_epi8(m);
+		if (mask != 0) {
+			return i + __builtin_ctz(mask);
+		}
+	}
+	return i + findScalar(data + i, size - i, chars, count, table);
+}
+
+/**
+ * AVX2 search implementation, compares 32 bytes with each character in the
+ * set at once.
+ */
+__attribute__((target("avx2"))) static size_t findAvx2(const char *data,
+                                                       size_t size,
+                                                       const char *chars,
+                                                       size_t count,
+                                                       const bool *table)
+{
+	__m256i needles[CharScanner::MAX_VECTOR_CHARS];
+	for (size_t j = 0; j < count; j++) {
+		needles[j] = _mm256_set1_epi8(chars[j]);
+	}
+
+	size_t i = 0;
+	for (; i + 32 <= size; i += 32) {
+		const __m256i v =
+		    _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+		__m256i m = _mm256_cmpeq_epi8(v, needles[0]);
+		for (size_t j = 1; j < count; j++) {
+			m = _mm256_or_si256(m, _mm256_cmpeq_epi8(v, needles[j]));
+		}
+		const unsigned int mask = _mm256_movemask_epi8(m);
+		if (mask != 0) {
+			return i + __builtin_ctz(mask);
+		}
+	}
+	return i + findSse2(data + i, size - i, chars, count, table);
+}
+
+#endif /* OUSIA_CHAR_SCANNER_X86 */
+
+/**
+ * Returns the search implementation for the given implementation enum, falls
+ * back to the scalar implementation if the requested one is not supported.
+ */
+static FindFunction selectFindFunction(CharScanner::Implementation impl)
+{
+	if (!CharScanner::supported(impl)) {
+		return findScalar;
+	}
+	switch (impl) {
+#ifdef OUSIA_CHAR_SCANNER_X86
+		case CharScanner::Implementation::AUTO:
+			return CharScanner::supported(CharScanner::Implementation::AVX2)
+			           ? findAvx2
+			           : findSse2;
+		case CharScanner::Implementation::SSE2:
+			return findSse2;
+		case CharScanner::Implementation::AVX2:
+			return findAvx2;
+#endif
+		default:
+			return findScalar;
+	}
+}
+
+/* Class CharScanner */
+
+CharScanner::CharScanner() : count(0) { table.fill(false); }
+
+CharScanner::CharScanner(const std::string &chars) : CharScanner()
+{
+	for (char c : chars) {
+		add(c);
+	}
+}
+
+void CharScanner::add(char c)
+{
+	if (contains(c)) {
+		return;
+	}
+	table[static_cast<unsigned char>(c)] = true;
+	if (count < MAX_VECTOR_CHARS) {
+		chars[count] = c;
+	}
+	count++;
+}
+
+void CharScanner::clear()
+{
+	table.fill(false);
+	count = 0;
+}
+
+size_t CharScanner::find(const char *data, size_t size,
+                         Implementation impl) const
+{
+	if (count == 0) {
+		return size;
+	}
+	if (count > MAX_VECTOR_CHARS) {
+		return findScalar(data, size, chars.data(), count, table.data());
+	}
+
+	// Determine the fastest implementation available on the current CPU once
+	static const FindFunction findAuto =
+	    selectFindFunction(Implementation::AUTO);
+	const FindFunction f =
+	    impl == Implementation::AUTO ? findAuto : selectFindFunction(impl);
+	return f(data, size, chars.data(), count, table.data());
+}
+
+bool CharScanner::supported(Implementation impl)
+{
+	switch (impl) {
+		case Implementation::AUTO:
+		case Implementation::SCALAR:
+			return true;
+#ifdef OUSIA_CHAR_SCANNER_X86
+		case Implementation::SSE2:
+			return true;
+		case Implementation::AVX2:
+			return __builtin_cpu_supports("avx2");
+#endif
+		default:
+			return false;
+	}
+}
+}
+
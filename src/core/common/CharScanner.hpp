@@ -0,0 +1,164 @@
+/*
+    Ousía
+    Copyright (C) 2014, 2015  Benjamin Paaßen, Andreas Stöckel
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file CharScanner.hpp
+ *
+ * Contains the CharScanner class which is used to quickly search memory
+ * regions for the first occurance of any character from a small set of
+ * characters (e.g. linebreaks or the first characters of tokens).
+ *
+ * @author Andreas Stöckel (astoecke@techfak.uni-bielefeld.de)
+ */
+
+#ifndef _OUSIA_CHAR_SCANNER_HPP_
+#define _OUSIA_CHAR_SCANNER_HPP_
+
+#include <array>
+#include <cstddef>
+#include <string>
+
+namespace ousia {
+
+/**
+ * The CharScanner class stores a set of characters and searches memory
+ * regions for the first character contained in this set. If the set is small
+ * enough, the search is performed using SIMD instructions (SSE2 or AVX2,
+ * depending on the capabilities of the CPU the program is running on),
+ * otherwise a scalar lookup table is used.
+ */
+class CharScanner {
+public:
+	/**
+	 * Enum used to select the search implementation. Mainly used for testing
+	 * and benchmarking.
+	 */
+	enum class Implementation {
+		/**
+		 * Uses the fastest implementation available on the current CPU.
+		 */
+		AUTO,
+
+		/**
+		 * Plain C++ implementation using a lookup table.
+		 */
+		SCALAR,
+
+		/**
+		 * Implementation processing 16 bytes at once using SSE2 instructions.
+		 */
+		SSE2,
+
+		/**
+		 * Implementation processing 32 bytes at once using AVX2 instructions.
+		 */
+		AVX2
+	};
+
+	/**
+	 * Maximum number of characters in the set for which the SIMD
+	 * implementations are used.
+	 */
+	static constexpr size_t MAX_VECTOR_CHARS = 8;
+
+private:
+	/**
+	 * Lookup table containing true for each character in the set.
+	 */
+	std::array<bool, 256> table;
+
+	/**
+	 * List containing the first MAX_VECTOR_CHARS characters in the set.
+	 */
+	std::array<char, MAX_VECTOR_CHARS> chars;
+
+	/**
+	 * Number of characters in the set.
+	 */
+	size_t count;
+
+public:
+	/**
+	 * Creates an empty CharScanner.
+	 */
+	CharScanner();
+
+	/**
+	 * Creates a CharScanner searching for the given characters.
+	 *
+	 * @param chars is a string containing the characters that should be
+	 * searched.
+	 */
+	CharScanner(const std::string &chars);
+
+	/**
+	 * Adds a character to the set.
+	 *
+	 * @param c is the character that should be added.
+	 */
+	void add(char c);
+
+	/**
+	 * Removes all characters from the set.
+	 */
+	void clear();
+
+	/**
+	 * Returns true if the given character is in the set.
+	 *
+	 * @param c is the character that should be checked.
+	 * @return true if the character is in the set.
+	 */
+	bool contains(char c) const
+	{
+		return table[static_cast<unsigned char>(c)];
+	}
+
+	/**
+	 * Returns the number of characters in the set.
+	 *
+	 * @return the number of characters in the set.
+	 */
+	size_t size() const { return count; }
+
+	/**
+	 * Searches the given memory region for the first character in the set.
+	 *
+	 * @param data is a pointer at the memory region that should be searched.
+	 * @param size is the size of the memory region in bytes.
+	 * @param impl is the implementation that should be used. If the requested
+	 * implementation is not supported, the scalar implementation is used.
+	 * @return the index of the first character in the set or size if no
+	 * character has been found.
+	 */
+	size_t find(const char *data, size_t size,
+	            Implementation impl = Implementation::AUTO) const;
+
+	/**
+	 * Returns true if the given implementation is supported on the current
+	 * CPU.
+	 *
+	 * @param impl is the implementation that should be checked.
+	 * @return true if the implementation can be used.
+	 */
+	static bool supported(Implementation impl);
+};
+}
+
+#endif /* _OUSIA_CHAR_SCANNER_HPP_ */
+
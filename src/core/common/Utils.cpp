@@ -18,8 +18,10 @@
 
 #include <algorithm>
 #include <cctype>
+#include <cstring>
 #include <string>
 
+#include "CharScanner.hpp"
 #include "Utils.hpp"
 
 namespace ousia {
@@ -71,6 +73,82 @@ bool Utils::hasNonWhitepaceChar(const std::string &s)
 	return false;
 }
 
+/**
+ * Searches the first and the last non-whitespace character in the given span.
+ *
+ * @param s is a pointer at the characters.
+ * @param len is the number of characters.
+ * @param start is set to the index of the first non-whitespace character.
+ * @param end is set to the index after the last non-whitespace character.
+ * @return false if the span only consists of whitespace, in this case start
+ * and end are set to zero.
+ */
+static bool trimBounds(const char *s, size_t len, size_t &start, size_t &end)
+{
+	start = 0;
+	while (start < len && Utils::isWhitespace(s[start])) {
+		start++;
+	}
+	end = len;
+	while (end > start && Utils::isWhitespace(s[end - 1])) {
+		end--;
+	}
+	if (start == end) {
+		start = 0;
+		end = 0;
+		return false;
+	}
+	return true;
+}
+
+std::string Utils::trim(const char *s, size_t len, size_t &start,
+                        size_t &end)
+{
+	trimBounds(s, len, start, end);
+	return std::string(s + start, end - start);
+}
+
+std::string Utils::collapse(const char *s, size_t len, size_t &start,
+                            size_t &end)
+{
+	// Whitespace characters other than a single space always need to be
+	// replaced, single spaces between other characters are kept
+	static const CharScanner IRREGULAR_WHITESPACE{"\t\n\r"};
+
+	// Trim the string, abort if it only consists of whitespace
+	if (!trimBounds(s, len, start, end)) {
+		return std::string{};
+	}
+
+	// Copy the runs of characters between whitespace which has to be
+	// replaced, i.e. irregular whitespace characters and multiple spaces
+	std::string res;
+	res.reserve(end - start);
+	size_t i = start;
+	while (i < end) {
+		size_t next = i + IRREGULAR_WHITESPACE.find(s + i, end - i);
+		const void *spaces = memmem(s + i, next - i, "  ", 2);
+		if (spaces != nullptr) {
+			next = static_cast<const char *>(spaces) - s;
+		} else if (next > i && s[next - 1] == ' ') {
+			next--;
+		}
+		res.append(s + i, next - i);
+
+		// Replace the whitespace sequence by a single space
+		if (next < end) {
+			res.push_back(' ');
+			i = next;
+			while (isWhitespace(s[i])) {
+				i++;
+			}
+		} else {
+			i = end;
+		}
+	}
+	return res;
+}
+
 std::vector<std::string> Utils::split(const std::string &s, char delim)
 {
 	std::vector<std::string> res;
@@ -232,6 +232,22 @@ public:
 		return std::string(&s[start], end - start);
 	}
 
+	/**
+	 * Trims the whitespace characters at the beginning and the end of the
+	 * given character span. Operates on the span as a whole instead of
+	 * calling a filter function for each character.
+	 *
+	 * @param s is a pointer at the characters that should be trimmed.
+	 * @param len is the number of characters.
+	 * @param start is an output parameter which is set to the offset at which
+	 * the trimmed version of the string starts.
+	 * @param end is an output parameter which is set to the offset at which
+	 * the trimmed version of the string ends.
+	 * @return the trimmed string.
+	 */
+	static std::string trim(const char *s, size_t len, size_t &start,
+	                        size_t &end);
+
 	/**
 	 * Removes whitespace at the beginning and the end of the given string.
 	 *
@@ -240,11 +256,29 @@ public:
 	 */
 	static std::string trim(const std::string &s)
 	{
-		std::pair<size_t, size_t> bounds =
-		    trim(s, [&s](size_t i) { return isWhitespace(s[i]); });
-		return s.substr(bounds.first, bounds.second - bounds.first);
+		size_t start;
+		size_t end;
+		return trim(s.data(), s.size(), start, end);
 	}
 
+	/**
+	 * Collapses the whitespaces in the given character span (trims the string
+	 * and replaces all whitespace sequences by a single space). Copies runs of
+	 * characters which are not affected by collapsing as a whole and uses
+	 * vectorized search for the whitespace characters that need to be
+	 * replaced.
+	 *
+	 * @param s is a pointer at the characters that should be collapsed.
+	 * @param len is the number of characters.
+	 * @param start is an output parameter which is set to the offset at which
+	 * the collapsed version of the string starts.
+	 * @param end is an output parameter which is set to the offset at which
+	 * the collapsed version of the string ends.
+	 * @return a copy of the span with collapsed whitespace.
+	 */
+	static std::string collapse(const char *s, size_t len, size_t &start,
+	                            size_t &end);
+
 	/**
 	 * Collapses the whitespaces in the given string (trims the string and
 	 * replaces all whitespace characters by a single one).
@@ -256,8 +290,7 @@ public:
 	{
 		size_t start;
 		size_t end;
-		return collapse(s, s.size(), start, end,
-		                [&s](size_t i) { return isWhitespace(s[i]); });
+		return collapse(s.data(), s.size(), start, end);
 	}
 
 	/**
@@ -274,8 +307,7 @@ public:
 	static std::string collapse(const std::string &s, size_t &start,
 	                            size_t &end)
 	{
-		return collapse(s, s.size(), start, end,
-		                [&s](size_t i) { return isWhitespace(s[i]); });
+		return collapse(s.data(), s.size(), start, end);
 	}
 
 	/**
@@ -315,7 +315,26 @@ std::pair<bool, std::string> VariantReader::parseString(
 	// the default (read and putBack would obviously be better, yet the latter
 	// is not trivial to implement in the current CharReader).
 	char c;
-	while (reader.peek(c)) {
+	while (true) {
+		// Copy runs of ordinary string characters directly from the reader
+		if (state == STATE_IN_STRING) {
+			const char *span;
+			const size_t spanSize = reader.peekSpan(span);
+			size_t len = 0;
+			while (len < spanSize && span[len] != quote && span[len] != '\\' &&
+			       span[len] != '\n') {
+				len++;
+			}
+			if (len > 0) {
+				res.write(span, len);
+				reader.skipPeek(len);
+				reader.consumePeek();
+			}
+		}
+
+		if (!reader.peek(c)) {
+			break;
+		}
 		switch (state) {
 			case STATE_INIT:
 				if (c == '"' || c == '\'') {
@@ -27,6 +27,20 @@ namespace ousia {
 
 /* Class Managed */
 
+void *Managed::operator new(size_t size) { return ::operator new(size); }
+
+void *Managed::operator new(size_t size, Manager &mgr)
+{
+	return ManagedArena::allocateManaged(mgr.getArena(), size);
+}
+
+void Managed::operator delete(void *p) { ManagedArena::freeManaged(p); }
+
+void Managed::operator delete(void *p, Manager &)
+{
+	ManagedArena::freeManaged(p);
+}
+
 void Managed::storeData(const std::string &key, Handle<Managed> h)
 {
 	mgr.storeData(this, key, h.get());
@@ -56,6 +70,35 @@ Managed* Managed::readDataPtr(const std::string &key, const std::type_info &type
 	return readData(key, RttiStore::lookup(type)).get();
 }
 
+void Managed::storeData(DataKey key, Handle<Managed> h)
+{
+	mgr.storeData(this, key, h.get());
+}
+
+bool Managed::hasDataKey(DataKey key)
+{
+	return mgr.readData(this, key) != nullptr;
+}
+
+Rooted<Managed> Managed::readData(DataKey key)
+{
+	return mgr.readData(this, key);
+}
+
+Rooted<Managed> Managed::readData(DataKey key, const Rtti *type)
+{
+	Rooted<Managed> res = mgr.readData(this, key);
+	if (res != nullptr && res->type()->isa(type)) {
+		return res;
+	}
+	return nullptr;
+}
+
+Managed *Managed::readDataPtr(DataKey key, const std::type_info &type)
+{
+	return readData(key, RttiStore::lookup(type)).get();
+}
+
 std::map<std::string, Rooted<Managed>> Managed::readData()
 {
 	auto map = mgr.readData(this);
@@ -71,6 +114,8 @@ bool Managed::deleteData(const std::string &key)
 	return mgr.deleteData(this, key);
 }
 
+bool Managed::deleteData(DataKey key) { return mgr.deleteData(this, key); }
+
 EventId Managed::registerEvent(EventType type, EventHandler handler,
                                Handle<Managed> owner, void *data)
 {
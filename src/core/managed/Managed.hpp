@@ -62,6 +62,15 @@ class Rtti;
  * instance.
  */
 class Managed {
+private:
+	friend class Manager;
+
+	/**
+	 * Index of the descriptor of this object in the slot array of the
+	 * Manager. Set by the Manager when the object is registered.
+	 */
+	uint32_t slot;
+
 protected:
 	/**
 	 * mgr is the reference to the managed object manager which owns this
@@ -79,6 +88,16 @@ protected:
 	 */
 	Managed* readDataPtr(const std::string &key, const std::type_info &type);
 
+	/**
+	 * Used internally to retrieve the pointer of a stored data element. Behaves
+	 * just like readData but returns a pointer.
+	 *
+	 * @param key is the interned key specifying the data slot.
+	 * @param type is the type that is expected for the data with the given key.
+	 * @return previously stored data or nullptr.
+	 */
+	Managed* readDataPtr(DataKey key, const std::type_info &type);
+
 public:
 	/**
 	 * Constructor of the Managed class. Associates the new instance with the
@@ -96,6 +115,40 @@ public:
 	 */
 	virtual ~Managed() { mgr.unmanage(this); };
 
+	/**
+	 * Allocates the memory for a Managed object on the heap.
+	 *
+	 * @param size is the size of the object.
+	 */
+	static void *operator new(size_t size);
+
+	/**
+	 * Allocates the memory for a Managed object from the arena of the given
+	 * Manager (or the heap if the Manager has no arena). Use as
+	 * "new (mgr) T(mgr, ...)".
+	 *
+	 * @param size is the size of the object.
+	 * @param mgr is the Manager from whose arena the memory should be
+	 * allocated. Must be the Manager passed to the constructor.
+	 */
+	static void *operator new(size_t size, Manager &mgr);
+
+	/**
+	 * Frees the memory of a Managed object.
+	 *
+	 * @param p is a pointer at the memory that should be freed.
+	 */
+	static void operator delete(void *p);
+
+	/**
+	 * Frees the memory of a Managed object allocated from an arena if the
+	 * constructor throws an exception.
+	 *
+	 * @param p is a pointer at the memory that should be freed.
+	 * @param mgr is the Manager passed to operator new.
+	 */
+	static void operator delete(void *p, Manager &mgr);
+
 	/**
 	 * Returns a reference ot the manager instance which owns this managed
 	 * object.
@@ -212,6 +265,56 @@ public:
 		return Rooted<T>(static_cast<T*>(readDataPtr(key, typeid(T))));
 	}
 
+	/**
+	 * Stores arbitrary data under the given interned key. Data will be
+	 * overriden.
+	 *
+	 * @param key is a key obtained from Manager::internDataKey.
+	 * @param h is the data that should be stored.
+	 */
+	void storeData(DataKey key, Handle<Managed> h);
+
+	/**
+	 * Returns true if data was stored under the given interned key.
+	 *
+	 * @return true if data was stored under the given key, false otherwise.
+	 */
+	bool hasDataKey(DataKey key);
+
+	/**
+	 * Returns data previously stored under the given interned key.
+	 *
+	 * @param key is a key obtained from Manager::internDataKey.
+	 * @return previously stored data or nullptr if no data was stored for this
+	 * key.
+	 */
+	Rooted<Managed> readData(DataKey key);
+
+	/**
+	 * Returns data previously stored under the given interned key. Makes sure
+	 * the data is of the given type.
+	 *
+	 * @param key is a key obtained from Manager::internDataKey.
+	 * @param type is the type that is expected for the data with the given key.
+	 * @return previously stored data or nullptr if no data of the given type
+	 * was stored for this key.
+	 */
+	Rooted<Managed> readData(DataKey key, const Rtti *type);
+
+	/**
+	 * Returns data previously stored under the given interned key. Makes sure
+	 * the data is of the given type.
+	 *
+	 * @param key is a key obtained from Manager::internDataKey.
+	 * @return previously stored data or nullptr if no data of the given type
+	 * was stored for this key.
+	 */
+	template<typename T>
+	Rooted<T> readData(DataKey key)
+	{
+		return Rooted<T>(static_cast<T*>(readDataPtr(key, typeid(T))));
+	}
+
 	/**
 	 * Returns a copy of all data that was attached to the node.
 	 *
@@ -227,6 +330,14 @@ public:
 	 */
 	bool deleteData(const std::string &key);
 
+	/**
+	 * Deletes the data entry with the given interned key from the node.
+	 *
+	 * @param key is a key obtained from Manager::internDataKey.
+	 * @return true if the operation was successful, false otherwise.
+	 */
+	bool deleteData(DataKey key);
+
 	/* Event handling methods */
 
 	/**
@@ -0,0 +1,217 @@
+/*
+    Ousía
+    Copyright (C) 2014, 2015  Benjamin Paaßen, Andreas Stöckel
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <new>
+
+#include "ManagedArena.hpp"
+
+namespace ousia {
+
+namespace {
+/**
+ * Describes a chunk allocated by an arena.
+ */
+struct ChunkInfo {
+	/**
+	 * Arena the chunk belongs to.
+	 */
+	ManagedArena *arena;
+
+	/**
+	 * Size of the blocks stored in the chunk.
+	 */
+	size_t blockSize;
+};
+
+/**
+ * Process-wide table of all chunks, used to find the arena a block was
+ * allocated from.
+ */
+struct ChunkRegistry {
+	/**
+	 * Mutex protecting the chunks map, arenas of different Managers may be
+	 * used from different threads.
+	 */
+	std::mutex mutex;
+
+	/**
+	 * Map from the start address of each chunk to its descriptor.
+	 */
+	std::map<const char *, ChunkInfo> chunks;
+
+	/**
+	 * Number of entries in the chunks map. Allows to skip the lookup while no
+	 * arena is in use.
+	 */
+	std::atomic<size_t> count{0};
+};
+
+/**
+ * Returns the chunk registry. The registry is never freed, so arenas may
+ * safely be destroyed during static destruction.
+ */
+ChunkRegistry &registry()
+{
+	static ChunkRegistry *res = new ChunkRegistry();
+	return *res;
+}
+
+/**
+ * Looks up the chunk containing the given address.
+ *
+ * @param p is the address that should be looked up.
+ * @param chunkSize is the size of the chunks.
+ * @return the descriptor of the chunk, a descriptor with the arena set to
+ * nullptr if the address does not belong to any chunk.
+ */
+ChunkInfo lookup(const void *p, size_t chunkSize)
+{
+	ChunkRegistry &reg = registry();
+	if (reg.count.load(std::memory_order_relaxed) == 0) {
+		return ChunkInfo{nullptr, 0};
+	}
+	const char *c = static_cast<const char *>(p);
+	std::lock_guard<std::mutex> lock(reg.mutex);
+	auto it = reg.chunks.upper_bound(c);
+	if (it == reg.chunks.begin()) {
+		return ChunkInfo{nullptr, 0};
+	}
+	--it;
+	if (c >= it->first + chunkSize) {
+		return ChunkInfo{nullptr, 0};
+	}
+	return it->second;
+}
+}
+
+/* Class ManagedArena */
+
+ManagedArena::ManagedArena()
+{
+	freeLists.fill(nullptr);
+	cur.fill(nullptr);
+	end.fill(nullptr);
+}
+
+ManagedArena::~ManagedArena()
+{
+	ChunkRegistry &reg = registry();
+	{
+		std::lock_guard<std::mutex> lock(reg.mutex);
+		for (char *chunk : chunks) {
+			reg.chunks.erase(chunk);
+		}
+		reg.count = reg.chunks.size();
+	}
+	for (char *chunk : chunks) {
+		delete[] chunk;
+	}
+}
+
+size_t ManagedArena::sizeClass(size_t size)
+{
+	return std::max<size_t>(1, (size + GRANULARITY - 1) / GRANULARITY);
+}
+
+void *ManagedArena::allocate(size_t size)
+{
+	stats.allocations++;
+	stats.liveBlocks++;
+
+	// Large blocks are directly allocated on the heap
+	const size_t cls = sizeClass(size);
+	if (cls >= N_CLASSES) {
+		stats.liveBytes += size;
+		return ::operator new(size);
+	}
+	const size_t blockSize = cls * GRANULARITY;
+	stats.liveBytes += blockSize;
+
+	// Reuse a previously freed block of the same size class
+	void *p = freeLists[cls];
+	if (p) {
+		freeLists[cls] = *static_cast<void **>(p);
+		return p;
+	}
+
+	// Carve the block out of the current chunk of the size class, allocate a
+	// new chunk if the remaining space is insufficient
+	if (size_t(end[cls] - cur[cls]) < blockSize) {
+		char *chunk = new char[CHUNK_SIZE];
+		ChunkRegistry &reg = registry();
+		{
+			std::lock_guard<std::mutex> lock(reg.mutex);
+			reg.chunks.emplace(chunk, ChunkInfo{this, blockSize});
+			reg.count = reg.chunks.size();
+		}
+		chunks.push_back(chunk);
+		cur[cls] = chunk;
+		end[cls] = chunk + CHUNK_SIZE - CHUNK_SIZE % blockSize;
+		stats.reservedBytes += CHUNK_SIZE;
+	}
+	p = cur[cls];
+	cur[cls] += blockSize;
+	return p;
+}
+
+void ManagedArena::free(void *p, size_t size)
+{
+	stats.liveBlocks--;
+
+	const size_t cls = sizeClass(size);
+	if (cls >= N_CLASSES) {
+		stats.liveBytes -= size;
+		::operator delete(p);
+		return;
+	}
+	stats.liveBytes -= cls * GRANULARITY;
+
+	*static_cast<void **>(p) = freeLists[cls];
+	freeLists[cls] = p;
+}
+
+void *ManagedArena::allocateManaged(ManagedArena *arena, size_t size)
+{
+	if (arena && size <= MAX_BLOCK_SIZE) {
+		return arena->allocate(size);
+	}
+	return ::operator new(size);
+}
+
+void ManagedArena::freeManaged(void *p)
+{
+	if (!p) {
+		return;
+	}
+	const ChunkInfo info = lookup(p, CHUNK_SIZE);
+	if (info.arena) {
+		info.arena->free(p, info.blockSize);
+	} else {
+		::operator delete(p);
+	}
+}
+
+size_t ManagedArena::managedSize(const void *p)
+{
+	return lookup(p, CHUNK_SIZE).blockSize;
+}
+}
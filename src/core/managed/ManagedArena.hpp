@@ -0,0 +1,202 @@
+/*
+    Ousía
+    Copyright (C) 2014, 2015  Benjamin Paaßen, Andreas Stöckel
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file ManagedArena.hpp
+ *
+ * Pool allocator used to allocate the memory for Managed objects.
+ *
+ * @author Andreas Stöckel (astoecke@techfak.uni-bielefeld.de)
+ */
+
+#ifndef _OUSIA_MANAGED_ARENA_HPP_
+#define _OUSIA_MANAGED_ARENA_HPP_
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+namespace ousia {
+
+/**
+ * The ManagedArena class implements a size-classed pool allocator for Managed
+ * objects. Memory is carved out of chunks, each of which only holds blocks of
+ * a single size class. Freed blocks are kept in a free list per size class
+ * and reused for objects of the same size class. The chunks are only returned
+ * to the system once the arena is destroyed, which makes freeing the memory
+ * of a complete object graph a cheap operation.
+ *
+ * All chunks are registered in a process-wide table. This allows the Managed
+ * class to free objects and to determine their block size without knowing
+ * whether they were allocated from an arena or from the heap, and without
+ * storing any per-object header.
+ */
+class ManagedArena {
+public:
+	/**
+	 * Allocation counters of an arena.
+	 */
+	struct Statistics {
+		/**
+		 * Number of bytes reserved in chunks.
+		 */
+		size_t reservedBytes = 0;
+
+		/**
+		 * Number of bytes in blocks which are currently in use (including the
+		 * padding to the size class).
+		 */
+		size_t liveBytes = 0;
+
+		/**
+		 * Number of blocks which are currently in use.
+		 */
+		size_t liveBlocks = 0;
+
+		/**
+		 * Total number of allocations performed by the arena.
+		 */
+		size_t allocations = 0;
+	};
+
+private:
+	/**
+	 * Granularity of the size classes in bytes.
+	 */
+	static constexpr size_t GRANULARITY = 16;
+
+	/**
+	 * Maximum block size served from the pools. Larger blocks are allocated
+	 * on the heap.
+	 */
+	static constexpr size_t MAX_BLOCK_SIZE = 1024;
+
+	/**
+	 * Number of size classes.
+	 */
+	static constexpr size_t N_CLASSES = MAX_BLOCK_SIZE / GRANULARITY + 1;
+
+	/**
+	 * Size of a single chunk in bytes. Each size class in use occupies at
+	 * least one chunk, so the chunks are kept moderately small.
+	 */
+	static constexpr size_t CHUNK_SIZE = 16 * 1024;
+
+	/**
+	 * Chunks allocated by this arena.
+	 */
+	std::vector<char *> chunks;
+
+	/**
+	 * Pointer at the first unused byte in the current chunk of each size
+	 * class.
+	 */
+	std::array<char *, N_CLASSES> cur;
+
+	/**
+	 * Pointer at the end of the current chunk of each size class.
+	 */
+	std::array<char *, N_CLASSES> end;
+
+	/**
+	 * Heads of the free lists, one for each size class. The first bytes of a
+	 * free block contain the pointer at the next free block.
+	 */
+	std::array<void *, N_CLASSES> freeLists;
+
+	/**
+	 * Allocation counters.
+	 */
+	Statistics stats;
+
+	/**
+	 * Returns the size class for a block of the given size. Blocks of size
+	 * class n are n * GRANULARITY bytes large.
+	 */
+	static size_t sizeClass(size_t size);
+
+public:
+	/**
+	 * Creates a new, empty arena.
+	 */
+	ManagedArena();
+
+	/**
+	 * Frees all chunks. Note that no destructors are called -- all objects
+	 * allocated from the arena must have been destroyed beforehand.
+	 */
+	~ManagedArena();
+
+	// No copy
+	ManagedArena(const ManagedArena &) = delete;
+	ManagedArena &operator=(const ManagedArena &) = delete;
+
+	/**
+	 * Allocates a block with the given size.
+	 *
+	 * @param size is the number of bytes that should be allocated.
+	 * @return a pointer at the allocated memory, aligned to 16 bytes.
+	 */
+	void *allocate(size_t size);
+
+	/**
+	 * Returns a block previously allocated with the allocate() function to
+	 * the arena.
+	 *
+	 * @param p is the pointer returned by allocate().
+	 * @param size is the size that was passed to allocate().
+	 */
+	void free(void *p, size_t size);
+
+	/**
+	 * Returns the allocation counters of this arena.
+	 */
+	const Statistics &getStatistics() const { return stats; }
+
+	/**
+	 * Allocates memory for a Managed object.
+	 *
+	 * @param arena is the arena from which the memory should be allocated. If
+	 * nullptr or if the object is larger than the largest size class, the
+	 * memory is allocated on the heap.
+	 * @param size is the size of the object.
+	 * @return a pointer at the memory for the object.
+	 */
+	static void *allocateManaged(ManagedArena *arena, size_t size);
+
+	/**
+	 * Frees memory allocated with allocateManaged() or ::operator new. The
+	 * memory is returned to the arena it was allocated from, if any.
+	 *
+	 * @param p is the pointer at the memory that should be freed.
+	 */
+	static void freeManaged(void *p);
+
+	/**
+	 * Returns the size of the arena block at the given memory location.
+	 *
+	 * @param p is a pointer returned by allocateManaged().
+	 * @return the size of the block including the padding to the size class
+	 * or zero if the memory was not allocated from an arena.
+	 */
+	static size_t managedSize(const void *p);
+};
+}
+
+#endif /* _OUSIA_MANAGED_ARENA_HPP_ */
+
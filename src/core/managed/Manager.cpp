@@ -16,7 +16,12 @@
     along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <limits>
+
+#include <core/common/Rtti.hpp>
 
 #include "Managed.hpp"
 #include "Manager.hpp"
@@ -26,7 +31,6 @@
 #include <iostream>
 #include <fstream>
 #include <core/common/Exceptions.hpp>
-#include <core/common/Rtti.hpp>
 #include <core/common/Property.hpp>
 #endif
 
@@ -59,6 +63,23 @@ public:
 	~ScopedIncrement() { i--; }
 };
 
+/* Static helper functions */
+
+/**
+ * Returns the index of the latency histogram bucket for the given duration.
+ *
+ * @param ns is the duration in nanoseconds.
+ * @return the histogram bucket the duration should be counted in.
+ */
+static size_t latencyBucket(uint64_t ns)
+{
+	size_t bucket = 0;
+	for (uint64_t us = ns / 1000; us > 0; us >>= 1) {
+		bucket++;
+	}
+	return std::min(bucket, Manager::Statistics::LATENCY_BUCKETS - 1);
+}
+
 /* Class Manager::ObjectDescriptor */
 
 bool Manager::ObjectDescriptor::hasInRef() const
@@ -80,7 +101,7 @@ void Manager::ObjectDescriptor::incrDegree(RefDir dir, Managed *o)
 	// Insert a new entry or increment the corresponding reference counter
 	auto it = m.find(o);
 	if (it == m.end()) {
-		m.emplace(std::make_pair(o, 1));
+		m.emplace(o, 1);
 	} else {
 		it->second++;
 	}
@@ -121,54 +142,144 @@ bool Manager::ObjectDescriptor::decrDegree(RefDir dir, Managed *o, bool all)
 
 Manager::~Manager()
 {
+	// In teardown mode, destroy all remaining objects without updating the
+	// reference graph. The memory of arena objects is released along with the
+	// arena.
+	if (tearingDown) {
+		ScopedIncrement incr{deletionRecursionDepth};
+		for (size_t i = 0; i < descriptors.size(); i++) {
+			Managed *o = descriptors[i].object;
+			if (o) {
+				descriptors[i].object = nullptr;
+				delete o;
+			}
+		}
+		return;
+	}
+
 	// Perform a final sweep
 	sweep();
 
 #ifdef MANAGER_GRAPHVIZ_EXPORT
-	if (!objects.empty()) {
+	if (objectCount > 0) {
 		exportGraphviz("manager_crashdump.dot");
 	}
 #endif
 
 	// All objects should have been deleted!
-	assert(objects.empty());
+	assert(objectCount == 0);
 
 	// Free all objects managed by the Managed manager (we'll get here if
 	// assertions are disabled)
-	if (!objects.empty()) {
+	if (objectCount > 0) {
 		ScopedIncrement incr{deletionRecursionDepth};
-		for (auto &e : objects) {
-			delete e.first;
+		for (size_t i = 0; i < descriptors.size(); i++) {
+			if (descriptors[i].object) {
+				delete descriptors[i].object;
+			}
 		}
 	}
 }
 
+/* Class Manager: Allocation */
+
+void Manager::enableArena()
+{
+	if (!arena) {
+		arena = std::unique_ptr<ManagedArena>(new ManagedArena());
+	}
+}
+
+std::unordered_map<const Rtti *, Manager::AllocationStatistics>
+Manager::getAllocationStatistics() const
+{
+	std::unordered_map<const Rtti *, AllocationStatistics> res;
+	for (const ObjectDescriptor &descr : descriptors) {
+		if (descr.object) {
+			AllocationStatistics &typeStats = res[descr.object->type()];
+			typeStats.count++;
+			typeStats.bytes += ManagedArena::managedSize(descr.object);
+		}
+	}
+	return res;
+}
+
+Manager::Statistics Manager::getStatistics() const
+{
+	Statistics res = stats;
+	res.liveObjects = objectCount;
+	res.markedObjects = marked.size();
+	for (const ObjectDescriptor &descr : descriptors) {
+		if (descr.attached) {
+			res.storeEntries += descr.attached->data.empty() ? 0 : 1;
+			res.eventEntries += descr.attached->events.empty() ? 0 : 1;
+		}
+	}
+	return res;
+}
+
+void Manager::resetStatistics()
+{
+	stats = Statistics{};
+	stats.peakObjects = objectCount;
+}
+
 /* Class Manager: Garbage collection */
 
 Manager::ObjectDescriptor *Manager::getDescriptor(Managed *o)
 {
 	if (o) {
-		auto it = objects.find(o);
-		if (it != objects.end()) {
-			return &(it->second);
+		const uint32_t slot = o->slot;
+		if (slot < descriptors.size() && descriptors[slot].object == o) {
+			return &descriptors[slot];
 		}
 	}
 	return nullptr;
 }
 
+const Manager::ObjectDescriptor *Manager::getDescriptor(Managed *o) const
+{
+	return const_cast<Manager *>(this)->getDescriptor(o);
+}
+
+void Manager::releaseSlot(uint32_t slot)
+{
+	ObjectDescriptor &descr = descriptors[slot];
+	descr.object = nullptr;
+	descr.rootRefCount = 0;
+	descr.visitEpoch = 0;
+	descr.reachableEpoch = 0;
+	descr.purged = false;
+	descr.attached.reset();
+	freeSlots.push_back(slot);
+	objectCount--;
+}
+
 void Manager::manage(Managed *o)
 {
 #ifdef MANAGER_DEBUG_PRINT
 	std::cout << "manage " << o << std::endl;
 #endif
-	objects.emplace(o, ObjectDescriptor{nextUid});
-	uids.emplace(nextUid, o);
-	nextUid++;
+	uint32_t slot;
+	if (freeSlots.empty()) {
+		slot = descriptors.size();
+		descriptors.emplace_back(ManagedUid(slot) + 1);
+	} else {
+		// Reuse a free slot, increment the generation counter stored in the
+		// upper bits of the uid to keep the uids unique
+		slot = freeSlots.back();
+		freeSlots.pop_back();
+		descriptors[slot].uid += ManagedUid(1) << 32;
+	}
+	descriptors[slot].object = o;
+	o->slot = slot;
+	objectCount++;
+	stats.peakObjects = std::max(stats.peakObjects, objectCount);
 }
 
 void Manager::unmanage(Managed *o)
 {
-	if (!deleted.count(o)) {
+	if (!tearingDown && !deleted.count(o)) {
 		Manager::ObjectDescriptor *descr = getDescriptor(o);
 		if (descr != nullptr) {
 			// Make sure all input references are deleted
@@ -180,12 +291,9 @@ void Manager::unmanage(Managed *o)
 				deleteRef(descr->refOut.begin()->first, o, true);
 			}
 
-			// Remove the uid, data and event store entry
-			uids.erase(descr->uid);
-			store.erase(o);
-			events.erase(o);
+			// Release the slot, this also removes the data and event store
 			marked.erase(o);
-			objects.erase(o);
+			releaseSlot(o->slot);
 		}
 	}
 }
@@ -196,6 +304,11 @@ void Manager::addRef(Managed *tar, Managed *src)
 	std::cout << "addRef " << tar << " <- " << src << std::endl;
 #endif
 
+	// The reference graph is no longer maintained in teardown mode
+	if (tearingDown) {
+		return;
+	}
+
 	// Make sure the source and target manager are the same
 	if (src) {
 		assert(&tar->getManager() == &src->getManager());
@@ -225,6 +338,11 @@ void Manager::deleteRef(Managed *tar, Managed *src, bool all)
 	std::cout << "deleteRef " << tar << " <- " << src << std::endl;
 #endif
 
+	// The reference graph is no longer maintained in teardown mode
+	if (tearingDown) {
+		return;
+	}
+
 #ifdef MANAGER_DEBUG_HIDDEN_ROOTED
 	if (deletionRecursionDepth > 0 && src == 0) {
 		std::cerr << "\x1b[41;30mManager:\x1b[0m A managed object contains a "
@@ -235,9 +353,15 @@ void Manager::deleteRef(Managed *tar, Managed *src, bool all)
 	}
 #endif
 
-	// Fetch the Managed descriptors for the two objects
-	ObjectDescriptor *dTar = getDescriptor(tar);
+	// References held by an object which is currently being purged have
+	// already been removed, the target object may already have been freed
 	ObjectDescriptor *dSrc = getDescriptor(src);
+	if (dSrc && dSrc->purged) {
+		return;
+	}
+
+	// Fetch the Managed descriptor for the target object
+	ObjectDescriptor *dTar = getDescriptor(tar);
 
 	// Decrement the output degree of the source Managed first
 	if (dSrc) {
@@ -260,8 +384,12 @@ void Manager::deleteRef(Managed *tar, Managed *src, bool all)
 
 	// Call the tracing garbage collector if the marked size is larger than the
 	// actual value
-	if (marked.size() >= threshold) {
-		sweep();
+	if (pauseDepth == 0 && marked.size() >= threshold) {
+		if (sweepMode == SweepMode::INCREMENTAL) {
+			sweepStep(sweepBudget);
+		} else {
+			sweep();
+		}
 	}
 }
 
@@ -299,10 +427,8 @@ void Manager::deleteObject(Managed *o, ObjectDescriptor *descr)
 			deleteRef(descr->refOut.begin()->first, o, true);
 		}
 
-		// Remove the uid, data and event store entry
-		uids.erase(descr->uid);
-		store.erase(o);
-		events.erase(o);
+		// Remove the data and event store entry
+		descr->attached.reset();
 	}
 
 	purgeDeleted();
@@ -318,16 +444,134 @@ void Manager::purgeDeleted()
 
 		for (size_t i = 0; i < orderedDeleted.size(); i++) {
 			Managed *m = orderedDeleted[i];
+			const uint32_t slot = m->slot;
+			descriptors[slot].purged = true;
 			delete m;
 			deleted.erase(m);
 			marked.erase(m);
-			objects.erase(m);
+			releaseSlot(slot);
 		}
+		stats.objectsFreed += orderedDeleted.size();
 		orderedDeleted.clear();
 		assert(deleted.empty());
 	}
 }
 
+uint32_t Manager::nextEpoch(uint32_t &epoch)
+{
+	epoch++;
+	if (epoch == 0) {
+		// The counter overflowed, reset the epochs stored in the descriptors
+		// so stale values do not alias with new ones
+		for (auto &descr : descriptors) {
+			descr.visitEpoch = 0;
+			descr.reachableEpoch = 0;
+		}
+		visitEpoch = 1;
+		reachableEpoch = 1;
+		epoch = 1;
+	}
+	return epoch;
+}
+
+size_t Manager::trace(Managed *o)
+{
+	const uint32_t epoch = nextEpoch(visitEpoch);
+
+	// Perform a breadth-first search starting from the given Managed, the
+	// queue vector is not shrunk while the search is running, so it contains
+	// all visited objects once the search is done
+	bool isReachable = false;
+	traceQueue.clear();
+	traceQueue.push_back(o);
+	ObjectDescriptor *descr = getDescriptor(o);
+	if (descr) {
+		descr->visitEpoch = epoch;
+	}
+	for (size_t i = 0; i < traceQueue.size() && !isReachable; i++) {
+		// Fetch the next element from the queue, remove the element from the
+		// marked list as we obviously have evaluated it
+		Managed *curManaged = traceQueue[i];
+		marked.erase(curManaged);
+
+		// Fetch the Managed descriptor
+		descr = getDescriptor(curManaged);
+		if (!descr) {
+			continue;
+		}
+
+		// If this Managed is rooted, the complete visited subgraph is rooted
+		if (descr->rootRefCount > 0) {
+			isReachable = true;
+			break;
+		}
+
+		// Iterate over all objects leading to the current one
+		for (auto &src : descr->refIn) {
+			ObjectDescriptor *srcDescr = getDescriptor(src.first);
+
+			// Abort if the Managed already is known to be reachable, otherwise
+			// add the Managed to the queue if it was not visited
+			if (srcDescr->reachableEpoch == reachableEpoch) {
+				isReachable = true;
+				break;
+			} else if (srcDescr->visitEpoch != epoch) {
+				srcDescr->visitEpoch = epoch;
+				traceQueue.push_back(src.first);
+			}
+		}
+	}
+
+	// Mark the visited objects as reachable or delete them depending on the
+	// "isReachable" flag
+	if (isReachable) {
+		for (Managed *visited : traceQueue) {
+			ObjectDescriptor *visitedDescr = getDescriptor(visited);
+			if (visitedDescr) {
+				visitedDescr->reachableEpoch = reachableEpoch;
+			}
+		}
+	} else {
+		for (Managed *visited : traceQueue) {
+			ObjectDescriptor *visitedDescr = getDescriptor(visited);
+			if (visitedDescr) {
+				deleteObject(visited, visitedDescr);
+			}
+		}
+	}
+	return traceQueue.size();
+}
+
+void Manager::collect(size_t budget)
+{
+	const auto start = std::chrono::steady_clock::now();
+
+	// Objects proven to be reachable in previous steps may have become
+	// unreachable in the meantime, start a new epoch
+	nextEpoch(reachableEpoch);
+
+	// Trace marked objects until the budget is exhausted
+	size_t visited = 0;
+	while (!marked.empty() && visited < budget) {
+		// Increment the deletionRecursionDepth counter to prevent deletion of
+		// objects while the trace is running
+		ScopedIncrement incr{deletionRecursionDepth};
+		visited += trace(*(marked.begin()));
+	}
+
+	// Now purge all objects marked for deletion
+	purgeDeleted();
+
+	// Update the statistics
+	const uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+	                        std::chrono::steady_clock::now() - start).count();
+	stats.sweeps++;
+	stats.objectsVisited += visited;
+	stats.sweepTimeTotal += ns;
+	stats.sweepTimeMax = std::max(stats.sweepTimeMax, ns);
+	stats.sweepLatency[latencyBucket(ns)]++;
+}
+
 void Manager::sweep()
 {
 	// Only execute sweep on the highest recursion level
@@ -335,185 +579,191 @@ void Manager::sweep()
 		return;
 	}
 
-	// Set containing objects which are reachable from a rooted Managed
-	std::unordered_set<Managed *> reachable;
-
 	// Deletion of objects may cause other objects to be added to the "marked"
-	// list
-	// so we repeat this process until objects are no longer deleted
+	// list so we repeat this process until objects are no longer deleted
 	while (!marked.empty()) {
-		// Repeat until all objects in the "marked" list have been visited
-		while (!marked.empty()) {
-			// Increment the deletionRecursionDepth counter to prevent deletion
-			// of objects while sweep is running
-			ScopedIncrement incr{deletionRecursionDepth};
-
-			// Fetch the next Managed in the "marked" list and remove it
-			Managed *curManaged = *(marked.begin());
-
-			// Perform a breadth-first search starting from the current Managed
-			bool isReachable = false;
-			std::unordered_set<Managed *> visited{curManaged};
-			std::queue<Managed *> queue{{curManaged}};
-			while (!queue.empty() && !isReachable) {
-				// Pop the next element from the queue, remove the element from
-				// the marked list as we obviously have evaluated it
-				curManaged = queue.front();
-				queue.pop();
-				marked.erase(curManaged);
-
-				// Fetch the Managed descriptor
-				ObjectDescriptor *descr = getDescriptor(curManaged);
-				if (!descr) {
-					continue;
-				}
-
-				// If this Managed is rooted, the complete visited subgraph is
-				// rooted
-				if (descr->rootRefCount > 0) {
-					isReachable = true;
-					break;
-				}
-
-				// Iterate over all objects leading to the current one
-				for (auto &src : descr->refIn) {
-					Managed *srcManaged = src.first;
-
-					// Abort if the Managed already in the reachable list,
-					// otherwise add the Managed to the queue if it was not
-					// visited
-					if (reachable.find(srcManaged) != reachable.end()) {
-						isReachable = true;
-						break;
-					} else if (visited.find(srcManaged) == visited.end()) {
-						visited.insert(srcManaged);
-						queue.push(srcManaged);
-					}
-				}
-			}
+		collect(std::numeric_limits<size_t>::max());
+	}
+}
 
-			// Insert the objects into the list of to be deleted objects or
-			// reachable objects depending on the "isReachable" flag
-			if (isReachable) {
-				for (auto o : visited) {
-					reachable.insert(o);
-				}
-			} else {
-				for (auto o : visited) {
-					deleteObject(o, getDescriptor(o));
-				}
-			}
-		}
+void Manager::resumeSweep()
+{
+	assert(pauseDepth > 0);
+	pauseDepth--;
+	if (pauseDepth == 0 && !tearingDown && !marked.empty()) {
+		sweep();
+	}
+}
 
-		// Now purge all objects marked for deletion
-		purgeDeleted();
+bool Manager::sweepStep(size_t budget)
+{
+	// Only execute the step on the highest recursion level
+	if (deletionRecursionDepth == 0 && !marked.empty()) {
+		collect(budget);
 	}
+	return marked.empty();
 }
 
 /* Class Managed: Unique IDs */
 
 ManagedUid Manager::getUid(Managed *o)
 {
-	const auto it = objects.find(o);
-	if (it != objects.end()) {
-		return it->second.uid;
+	ObjectDescriptor *descr = getDescriptor(o);
+	if (descr) {
+		return descr->uid;
 	}
 	return 0;
 }
 
 Managed *Manager::getManaged(ManagedUid uid)
 {
-	const auto it = uids.find(uid);
-	if (it != uids.end()) {
-		return it->second;
+	// The lower 32 bits of the uid contain the slot index plus one, a uid of
+	// zero results in an invalid slot index
+	const size_t slot = (uid & 0xFFFFFFFF) - 1;
+	if (slot < descriptors.size() && descriptors[slot].uid == uid) {
+		// Objects which are about to be deleted can no longer be accessed
+		Managed *o = descriptors[slot].object;
+		if (o && (deleted.empty() || !deleted.count(o))) {
+			return o;
+		}
 	}
 	return nullptr;
 }
 
 /* Class Manager: Attached data */
 
-void Manager::storeData(Managed *ref, const std::string &key, Managed *data)
+Manager::AttachedStore *Manager::getAttached(Managed *o, bool create)
 {
-	// Add the new reference from the reference object to the data object
-	addRef(data, ref);
+	ObjectDescriptor *descr = getDescriptor(o);
+	if (!descr) {
+		return nullptr;
+	}
+	if (!descr->attached && create) {
+		descr->attached = std::unique_ptr<AttachedStore>(new AttachedStore());
+	}
+	return descr->attached.get();
+}
 
-	// Make sure a data map for the given reference object exists
-	auto &map =
-	    store.emplace(ref, std::map<std::string, Managed *>{}).first->second;
+const Manager::AttachedStore *Manager::getAttached(Managed *o) const
+{
+	const ObjectDescriptor *descr = getDescriptor(o);
+	return descr ? descr->attached.get() : nullptr;
+}
 
-	// Insert the given data for the key, decrement the references if
-	auto it = map.find(key);
-	if (it == map.end()) {
-		map.insert(it, std::make_pair(key, data));
-	} else {
-		// Do nothing if the same data is stored
-		if (it->second == data) {
+DataKey Manager::internDataKey(const std::string &name)
+{
+	auto it = dataKeys.find(name);
+	if (it != dataKeys.end()) {
+		return it->second;
+	}
+	const DataKey key = dataKeyNames.size();
+	dataKeys.emplace(name, key);
+	dataKeyNames.push_back(name);
+	return key;
+}
+
+const std::string &Manager::getDataKeyName(DataKey key) const
+{
+	return dataKeyNames[key];
+}
+
+void Manager::storeData(Managed *ref, DataKey key, Managed *data)
+{
+	AttachedStore *attached = getAttached(ref, true);
+	for (auto &entry : attached->data) {
+		if (entry.first == key) {
+			// Do nothing if the same data is stored
+			Managed *oldData = entry.second;
+			if (oldData == data) {
+				return;
+			}
+
+			// Replace the data and delete the reference from "ref" to the
+			// previously stored element
+			addRef(data, ref);
+			entry.second = data;
+			deleteRef(oldData, ref);
 			return;
 		}
+	}
 
-		// Delete the reference from "ref" to the previously stored element.
-		deleteRef(it->second, ref);
+	// Add the new reference from the reference object to the data object
+	addRef(data, ref);
+	attached->data.emplace_back(key, data);
+}
 
-		// Insert a new reference and add the element to the map
-		map.insert(map.erase(it), std::make_pair(key, data));
+Managed *Manager::readData(Managed *ref, DataKey key) const
+{
+	const AttachedStore *attached = getAttached(ref);
+	if (attached) {
+		for (const auto &entry : attached->data) {
+			if (entry.first == key) {
+				return entry.second;
+			}
+		}
 	}
+	return nullptr;
 }
 
 Managed *Manager::readData(Managed *ref, const std::string &key) const
 {
-	// Try to find the reference element in the store
-	auto storeIt = store.find(ref);
-	if (storeIt != store.end()) {
-		// Try to find the key in the map for the element
-		auto &map = storeIt->second;
-		auto mapIt = map.find(key);
-		if (mapIt != map.end()) {
-			return mapIt->second;
-		}
+	// Keys which have never been interned cannot have any data
+	auto it = dataKeys.find(key);
+	if (it != dataKeys.end()) {
+		return readData(ref, it->second);
 	}
 	return nullptr;
 }
 
 std::map<std::string, Managed *> Manager::readData(Managed *ref) const
 {
-	// Try to find the map for the given reference element and return it
-	auto storeIt = store.find(ref);
-	if (storeIt != store.end()) {
-		return storeIt->second;
+	std::map<std::string, Managed *> res;
+	const AttachedStore *attached = getAttached(ref);
+	if (attached) {
+		for (const auto &entry : attached->data) {
+			res.emplace(dataKeyNames[entry.first], entry.second);
+		}
 	}
-	return std::map<std::string, Managed *>{};
+	return res;
 }
 
-bool Manager::deleteData(Managed *ref, const std::string &key)
+bool Manager::deleteData(Managed *ref, DataKey key)
 {
-	// Find the reference element in the store
-	auto storeIt = store.find(ref);
-	if (storeIt != store.end()) {
-		// Delete the key from the data map
-		auto &map = storeIt->second;
-		auto mapIt = map.find(key);
-		if (mapIt != map.end()) {
-			// Delete the reference from "ref" to the previously stored element
-			deleteRef(mapIt->second, ref);
-
-			// Remove the element from the list
-			map.erase(mapIt);
-
-			return true;
+	AttachedStore *attached = getAttached(ref, false);
+	if (attached) {
+		auto &data = attached->data;
+		for (auto it = data.begin(); it != data.end(); it++) {
+			if (it->first == key) {
+				// Remove the entry before deleting the reference, as this may
+				// cause further objects to be deleted
+				Managed *oldData = it->second;
+				*it = data.back();
+				data.pop_back();
+				deleteRef(oldData, ref);
+				return true;
+			}
 		}
 	}
 	return false;
 }
 
+bool Manager::deleteData(Managed *ref, const std::string &key)
+{
+	auto it = dataKeys.find(key);
+	if (it != dataKeys.end()) {
+		return deleteData(ref, it->second);
+	}
+	return false;
+}
+
 /* Class Manager: Event handling */
 
 EventId Manager::registerEvent(Managed *ref, EventType type,
                                EventHandler handler, Managed *owner, void *data)
 {
-	// Create a event handler descriptor and store it along with the
-	auto &vec = events.emplace(ref, std::vector<EventHandlerDescriptor>{})
-	                .first->second;
+	// Create a event handler descriptor and store it in the first free slot
 	const EventHandlerDescriptor descr(type, handler, getUid(owner), data);
+	auto &vec = getAttached(ref, true)->events;
 	for (size_t i = 0; i < vec.size(); i++) {
 		if (!vec[i].handler) {
 			vec[i] = descr;
@@ -526,9 +776,12 @@ EventId Manager::registerEvent(Managed *ref, EventType type,
 
 bool Manager::unregisterEvent(Managed *ref, EventId id)
 {
-	auto eventsIt = events.find(ref);
-	if (eventsIt != events.end()) {
-		auto &vec = eventsIt->second;
+	if (tearingDown) {
+		return false;
+	}
+	AttachedStore *attached = getAttached(ref, false);
+	if (attached) {
+		auto &vec = attached->events;
 		if (id < vec.size() && vec[id].handler) {
 			// Remove the handler from the list by resetting handler and owner
 			// to nullptr
@@ -544,11 +797,22 @@ bool Manager::unregisterEvent(Managed *ref, EventId id)
 bool Manager::unregisterEvent(Managed *ref, EventType type,
                               EventHandler handler, Managed *owner, void *data)
 {
-	auto eventsIt = events.find(ref);
-	if (eventsIt != events.end()) {
+	if (tearingDown) {
+		return false;
+	}
+
+	// If the owner is currently being purged, the reference object may
+	// already have been freed. Handlers of dead owners are never called and
+	// their slots are released by triggerEvent.
+	const ObjectDescriptor *ownerDescr = getDescriptor(owner);
+	if (ownerDescr && ownerDescr->purged) {
+		return false;
+	}
+
+	AttachedStore *attached = getAttached(ref, false);
+	if (attached) {
 		const ManagedUid ownerUid = getUid(owner);
-		auto &vec = eventsIt->second;
-		for (EventHandlerDescriptor &descr : vec) {
+		for (EventHandlerDescriptor &descr : attached->events) {
 			if (descr.type == type && descr.handler == handler &&
 			    descr.ownerUid == ownerUid && descr.data == data) {
 				// Remove the handler from the list by resetting handler and
@@ -564,31 +828,47 @@ bool Manager::unregisterEvent(Managed *ref, EventType type,
 
 bool Manager::triggerEvent(Managed *ref, Event &ev)
 {
+	if (ev.type == EventType::NAME_CHANGE) {
+		namesChanged();
+	}
+
 	bool hasHandler = false;
-	auto eventsIt = events.find(ref);
-	if (eventsIt != events.end()) {
-		std::vector<EventHandlerDescriptor> descrs = eventsIt->second;
-		for (auto it = descrs.begin(); it != descrs.end();) {
-			const EventHandlerDescriptor &descr = *it;
-			if (descr.type == ev.type && descr.handler) {
-				// Resolve the given owner uid to a managed pointer -- erase the
-				// event handler if the owner no longer exists
-				Managed *owner = nullptr;
-				if (descr.ownerUid != 0) {
-					owner = getManaged(descr.ownerUid);
-					if (!owner) {
-						it = descrs.erase(it);
-						continue;
-					}
-				}
+	const AttachedStore *attached = getAttached(ref);
+	if (!attached) {
+		return false;
+	}
+
+	// Handlers may register or unregister other handlers, so the descriptor
+	// is re-read in each iteration. Handlers added while the event is being
+	// dispatched are not called.
+	const size_t count = attached->events.size();
+	for (size_t i = 0; i < count; i++) {
+		AttachedStore *cur = getAttached(ref, false);
+		if (!cur || i >= cur->events.size()) {
+			break;
+		}
+		EventHandlerDescriptor &descr = cur->events[i];
+		if (descr.type != ev.type || !descr.handler) {
+			continue;
+		}
 
-				// Call the event handler
-				ev.sender = ref;
-				descr.handler(ev, owner, descr.data);
-				hasHandler = true;
+		// Resolve the given owner uid to a managed pointer -- release the
+		// event handler if the owner no longer exists
+		Managed *owner = nullptr;
+		if (descr.ownerUid != 0) {
+			owner = getManaged(descr.ownerUid);
+			if (!owner) {
+				descr.handler = nullptr;
+				descr.ownerUid = 0;
+				continue;
 			}
-			it++;
 		}
+
+		// Call the event handler
+		const EventHandler handler = descr.handler;
+		ev.sender = ref;
+		handler(ev, owner, descr.data);
+		hasHandler = true;
 	}
 	return hasHandler;
 }
@@ -611,20 +891,20 @@ void Manager::exportGraphviz(const char *filename)
 	fs << "\tnode [shape=plaintext,fontsize=10]" << std::endl;
 
 	size_t idx = 0;
-	for (auto &object : objects) {
-		// References to the object descriptor and the object
-		Managed *objectPtr = object.first;
-		ObjectDescriptor &objectDescr = object.second;
+	for (auto &objectDescr : descriptors) {
+		// Skip unused slots
+		Managed *objectPtr = objectDescr.object;
+		if (!objectPtr) {
+			continue;
+		}
 
 		// Read flags, data and events
 		bool isMarked = marked.count(objectPtr) > 0;
 		bool isDeleted = deleted.count(objectPtr) > 0;
-		std::map<std::string, Managed *> storeData =
-		    store.count(objectPtr) > 0 ? store[objectPtr]
-		                               : std::map<std::string, Managed *>{};
+		std::map<std::string, Managed *> storeData = readData(objectPtr);
 		std::vector<EventHandlerDescriptor> eventData =
-		    events.count(objectPtr) > 0 ? events[objectPtr]
-		                                : std::vector<EventHandlerDescriptor>{};
+		    objectDescr.attached ? objectDescr.attached->events
+		                         : std::vector<EventHandlerDescriptor>{};
 
 		// Read type information and Node name (if available)
 		const Rtti *type = objectPtr->type();
@@ -33,8 +33,10 @@
 #define MANAGER_GRAPHVIZ_EXPORT
 #endif
 
+#include <array>
 #include <cstdint>
 #include <map>
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
@@ -42,19 +44,30 @@
 #include <queue>
 
 #include "Events.hpp"
+#include "ManagedArena.hpp"
+#include "RefList.hpp"
 
 namespace ousia {
 
 // Forward declaration
 class Managed;
+class Rtti;
 
 using ManagedUid = uint64_t;
 
+/**
+ * Integer handle of a key under which data can be attached to a Managed
+ * object. Keys are interned per Manager instance, see Manager::internDataKey.
+ */
+using DataKey = uint32_t;
+
 /**
  * The Manager class implements tracing garbage collection. Garbage Collection
  * is implemented as a simple directed reference graph with connected component
  * detection. Garbage collection is performed whenever the number of objects
- * marked as "probably unreachable" surpasses a certain threshold.
+ * marked as "probably unreachable" surpasses a certain threshold. Depending on
+ * the SweepMode, either all marked objects or only a bounded number of objects
+ * are traced once the threshold is reached.
  */
 class Manager {
 public:
@@ -64,20 +77,67 @@ public:
 	 */
 	enum class RefDir { IN, OUT };
 
+	/**
+	 * Enum used to specify how the garbage collector processes the objects
+	 * marked as "probably unreachable" once the sweep threshold is reached.
+	 */
+	enum class SweepMode {
+		/**
+		 * All marked objects are traced in a single sweep.
+		 */
+		FULL,
+
+		/**
+		 * Only a bounded number of objects is visited per collection step,
+		 * objects which have not been traced remain marked and are processed
+		 * in the next step. This keeps the latency of a single reference
+		 * deletion flat for large object graphs.
+		 */
+		INCREMENTAL
+	};
+
+	/**
+	 * Data and event handlers attached to a single managed object. Only
+	 * allocated for objects which actually have data or event handlers
+	 * attached.
+	 */
+	struct AttachedStore {
+		/**
+		 * Data attached to the object. Objects usually only have very few
+		 * data entries, so a plain vector is used.
+		 */
+		std::vector<std::pair<DataKey, Managed *>> data;
+
+		/**
+		 * Event handlers registered for the object. The index of a handler is
+		 * its EventId, unregistered handlers are marked by a null handler.
+		 */
+		std::vector<EventHandlerDescriptor> events;
+	};
+
 	/**
 	 * The ObjectDescriptor struct is used by the Manager for reference counting
 	 * and garbage collection. It describes the reference multigraph with
 	 * adjacency lists. Each ObjectDescriptor instance represents a single
 	 * managed object and its assocition to and from other managed objects
-	 * (nodes in the graph).
+	 * (nodes in the graph). Descriptors are stored in a dense slot array, the
+	 * slot index is stored in the Managed instance itself.
 	 */
 	struct ObjectDescriptor {
 	public:
 		/**
 		 * Unique ID assigned to the object. Valid unique ids are positive,
-		 * non-zero values.
+		 * non-zero values. The lower 32 bits contain the slot index plus one,
+		 * the upper 32 bits a generation counter which is incremented whenever
+		 * the slot is reused.
+		 */
+		ManagedUid uid;
+
+		/**
+		 * Managed object described by this descriptor or nullptr if the slot
+		 * is currently not in use.
 		 */
-		const ManagedUid uid;
+		Managed *object;
 
 		/**
 		 * Contains the number of references to rooted handles. A managed
@@ -87,30 +147,68 @@ public:
 		int rootRefCount;
 
 		/**
-		 * Map containing all references pointing at this managed object. The
-		 * map key describes the object which points at this object, the map
-		 * value contains the reference count from this object.
+		 * Epoch of the trace which visited this object last. Used by the
+		 * garbage collector instead of a "visited" set.
+		 */
+		uint32_t visitEpoch;
+
+		/**
+		 * Epoch of the collection step which proved this object to be
+		 * reachable from a rooted object.
+		 */
+		uint32_t reachableEpoch;
+
+		/**
+		 * Set to true while the object is being destroyed. All references
+		 * from and to the object have already been removed at this point,
+		 * objects referenced by it may already have been freed.
+		 */
+		bool purged;
+
+		/**
+		 * List containing all references pointing at this managed object. The
+		 * first entry element describes the object which points at this
+		 * object, the second element contains the reference count from this
+		 * object.
+		 */
+		RefList refIn;
+
+		/**
+		 * List containing all references pointing from this managed object to
+		 * other managed objects. The first entry element describes the target
+		 * object and the second element the reference count.
 		 */
-		std::unordered_map<Managed *, int> refIn;
+		RefList refOut;
 
 		/**
-		 * Map containing all references pointing from this managed object to
-		 * other managed objects. The map key describes the target object and
-		 * the map value the reference count.
+		 * Data and event handlers attached to the object or nullptr if there
+		 * are none.
 		 */
-		std::unordered_map<Managed *, int> refOut;
+		std::unique_ptr<AttachedStore> attached;
 
 		/**
 		 * Default constructor of the ObjectDescriptor class.
 		 */
-		ObjectDescriptor() : uid(0), rootRefCount(0) {};
+		ObjectDescriptor()
+		    : uid(0),
+		      object(nullptr),
+		      rootRefCount(0),
+		      visitEpoch(0),
+		      reachableEpoch(0),
+		      purged(false){};
 
 		/**
 		 * Creates a new ObjectDescriptor with the given unique id.
 		 *
 		 * @param uid is the unique id to be stored.
 		 */
-		ObjectDescriptor(ManagedUid uid) : uid(uid), rootRefCount(0) {};
+		ObjectDescriptor(ManagedUid uid)
+		    : uid(uid),
+		      object(nullptr),
+		      rootRefCount(0),
+		      visitEpoch(0),
+		      reachableEpoch(0),
+		      purged(false){};
 
 		/**
 		 * Returns true, if the ObjectDescriptor has at least one input
@@ -149,6 +247,96 @@ public:
 		bool decrDegree(RefDir dir, Managed *o, bool all = false);
 	};
 
+	/**
+	 * Structure used to report the number of live objects of a certain type
+	 * and the number of bytes allocated for them.
+	 */
+	struct AllocationStatistics {
+		/**
+		 * Number of live objects.
+		 */
+		size_t count = 0;
+
+		/**
+		 * Number of bytes allocated from the arena for the live objects,
+		 * including the padding to the size class but excluding any memory
+		 * the objects allocated themselves. Objects allocated on the heap are
+		 * only included in the count.
+		 */
+		size_t bytes = 0;
+	};
+
+	/**
+	 * Structure containing counters describing the work done by the garbage
+	 * collector and the current size of the internal data structures.
+	 */
+	struct Statistics {
+		/**
+		 * Number of buckets in the sweep latency histogram.
+		 */
+		static constexpr size_t LATENCY_BUCKETS = 24;
+
+		/**
+		 * Number of collection steps (full sweeps count once per pass over
+		 * the marked objects).
+		 */
+		size_t sweeps = 0;
+
+		/**
+		 * Total number of objects visited while tracing.
+		 */
+		size_t objectsVisited = 0;
+
+		/**
+		 * Total number of objects freed, either because their reference count
+		 * dropped to zero or because they were found to be unreachable.
+		 */
+		size_t objectsFreed = 0;
+
+		/**
+		 * Number of currently live objects.
+		 */
+		size_t liveObjects = 0;
+
+		/**
+		 * Maximum number of objects that were live at the same time.
+		 */
+		size_t peakObjects = 0;
+
+		/**
+		 * Number of objects currently marked as "probably unreachable".
+		 */
+		size_t markedObjects = 0;
+
+		/**
+		 * Number of objects with attached data.
+		 */
+		size_t storeEntries = 0;
+
+		/**
+		 * Number of objects with attached event handlers.
+		 */
+		size_t eventEntries = 0;
+
+		/**
+		 * Total time spent in collection steps in nanoseconds.
+		 */
+		uint64_t sweepTimeTotal = 0;
+
+		/**
+		 * Duration of the longest collection step in nanoseconds.
+		 */
+		uint64_t sweepTimeMax = 0;
+
+		/**
+		 * Histogram of the collection step latency. Bucket zero counts steps
+		 * shorter than one microsecond, bucket i > 0 counts steps with a
+		 * duration in [2^(i - 1), 2^i) microseconds. The last bucket also
+		 * counts all longer steps.
+		 */
+		std::array<size_t, LATENCY_BUCKETS> sweepLatency{};
+	};
+
 private:
 	/**
 	 * Default sweep threshold. If the number of managed objects marked for
@@ -156,6 +344,12 @@ private:
 	 */
 	static constexpr size_t SWEEP_THRESHOLD = 128;
 
+	/**
+	 * Default work budget of a single incremental collection step, measured in
+	 * the number of objects visited while tracing.
+	 */
+	static constexpr size_t SWEEP_BUDGET = 1024;
+
 	/**
 	 * Threshold that defines the minimum number of entries in the "marked"
 	 * set until "sweep" is called.
@@ -163,21 +357,61 @@ private:
 	const size_t threshold;
 
 	/**
-	 * Next UID being assigned to the next object for which the "manage"
-	 * function is called.
+	 * Mode used when the threshold is reached.
+	 */
+	SweepMode sweepMode;
+
+	/**
+	 * Number of objects that may be visited in a single incremental collection
+	 * step.
+	 */
+	size_t sweepBudget;
+
+	/**
+	 * Current trace epoch, incremented for each trace started from a marked
+	 * object.
+	 */
+	uint32_t visitEpoch = 0;
+
+	/**
+	 * Current collection epoch, incremented for each collection step.
+	 */
+	uint32_t reachableEpoch = 0;
+
+	/**
+	 * Queue used by the trace function. Kept as member to prevent
+	 * reallocations.
+	 */
+	std::vector<Managed *> traceQueue;
+
+	/**
+	 * Slot array storing the descriptors for all managed objects. The index of
+	 * the descriptor is stored in the Managed instance. Note that pointers at
+	 * descriptors are invalidated whenever a new object is managed.
 	 */
-	ManagedUid nextUid = 1;
+	std::vector<ObjectDescriptor> descriptors;
 
 	/**
-	 * Map used to store the descriptors for all managed objects. Every object
-	 * that has at least one root, in or out reference has an entry in this map.
+	 * Indices of the descriptor slots which are currently not in use.
 	 */
-	std::unordered_map<Managed *, ObjectDescriptor> objects;
+	std::vector<uint32_t> freeSlots;
 
 	/**
-	 * Map from Uids to Managed pointers.
+	 * Number of objects currently managed by this Manager instance.
 	 */
-	std::unordered_map<ManagedUid, Managed *> uids;
+	size_t objectCount = 0;
+
+	/**
+	 * Counter incremented whenever a change that may alter the result of
+	 * resolving objects by name is reported, see namesChanged().
+	 */
+	uint64_t nameGeneration = 0;
+
+	/**
+	 * Counter incremented whenever an object which had already been validated
+	 * is changed, see invalidated().
+	 */
+	uint64_t invalidationGeneration = 0;
 
 	/**
 	 * Set containing the objects marked for sweeping.
@@ -195,14 +429,14 @@ private:
 	std::vector<Managed *> orderedDeleted;
 
 	/**
-	 * Map storing the data attached to managed objects.
+	 * Map from the names of the data keys to the interned key.
 	 */
-	std::unordered_map<Managed *, std::map<std::string, Managed *>> store;
+	std::unordered_map<std::string, DataKey> dataKeys;
 
 	/**
-	 * Map storing any attached events.
+	 * Names of the interned data keys, indexed by the key.
 	 */
-	std::unordered_map<Managed *, std::vector<EventHandlerDescriptor>> events;
+	std::vector<std::string> dataKeyNames;
 
 	/**
 	 * Recursion depth while performing deletion. This variable is needed
@@ -213,11 +447,65 @@ private:
 	int deletionRecursionDepth = 0;
 
 	/**
-	 * Returns the object ObjectDescriptor for the given object from the objects
-	 * map.
+	 * Number of active pauseSweep() calls. Automatic sweeps are suppressed
+	 * while this value is larger than zero.
+	 */
+	int pauseDepth = 0;
+
+	/**
+	 * Set to true once bulkTeardown() has been called. Disables all reference
+	 * bookkeeping.
+	 */
+	bool tearingDown = false;
+
+	/**
+	 * Arena used to allocate Managed objects with "new (mgr) T(mgr, ...)" or
+	 * nullptr if no arena is used.
+	 */
+	std::unique_ptr<ManagedArena> arena;
+
+	/**
+	 * Counters describing the work done by the garbage collector.
+	 */
+	Statistics stats;
+
+	/**
+	 * Returns the ObjectDescriptor for the given object from the slot array or
+	 * nullptr if the object is not managed by this Manager instance.
 	 */
 	ObjectDescriptor *getDescriptor(Managed *o);
 
+	/**
+	 * Returns the ObjectDescriptor for the given object from the slot array or
+	 * nullptr if the object is not managed by this Manager instance.
+	 */
+	const ObjectDescriptor *getDescriptor(Managed *o) const;
+
+	/**
+	 * Returns the data and event handlers attached to the given object.
+	 *
+	 * @param o is the object for which the attached store should be returned.
+	 * @param create if true, a new store is created if none exists yet.
+	 * @return the attached store or nullptr if the object has none (and create
+	 * is false) or the object is not managed by this Manager.
+	 */
+	AttachedStore *getAttached(Managed *o, bool create);
+
+	/**
+	 * Returns the data and event handlers attached to the given object.
+	 *
+	 * @param o is the object for which the attached store should be returned.
+	 * @return the attached store or nullptr if the object has none.
+	 */
+	const AttachedStore *getAttached(Managed *o) const;
+
+	/**
+	 * Marks the descriptor slot with the given index as unused.
+	 *
+	 * @param slot is the index of the slot that should be released.
+	 */
+	void releaseSlot(uint32_t slot);
+
 	/**
 	 * Purges the objects in the "deleted" set.
 	 */
@@ -249,16 +537,114 @@ private:
 	 */
 	void deleteRef(Managed *tar, Managed *src, bool all);
 
-public:
-	Manager() : threshold(SWEEP_THRESHOLD) {}
+	/**
+	 * Increments the given epoch counter. If the counter overflows, the epochs
+	 * stored in all object descriptors are reset.
+	 *
+	 * @param epoch is a reference at the epoch counter that should be
+	 * incremented.
+	 * @return the new epoch value.
+	 */
+	uint32_t nextEpoch(uint32_t &epoch);
+
+	/**
+	 * Performs a breadth-first search along the inbound references of the
+	 * given marked object. If no rooted object is found, all visited objects
+	 * are deleted, otherwise they are marked as reachable for the current
+	 * collection step.
+	 *
+	 * @param o is the marked object from which the search should start.
+	 * @return the number of objects visited.
+	 */
+	size_t trace(Managed *o);
+
+	/**
+	 * Traces marked objects until either no marked objects are left or the
+	 * given number of objects has been visited and purges all unreachable
+	 * objects afterwards.
+	 *
+	 * @param budget is the maximum number of objects that should be visited.
+	 * Note that a single trace is always run to completion, so the budget may
+	 * be exceeded.
+	 */
+	void collect(size_t budget);
 
-	Manager(size_t threshold) : threshold(threshold) {}
+public:
+	Manager()
+	    : threshold(SWEEP_THRESHOLD),
+	      sweepMode(SweepMode::FULL),
+	      sweepBudget(SWEEP_BUDGET)
+	{
+	}
+
+	Manager(size_t threshold)
+	    : threshold(threshold),
+	      sweepMode(SweepMode::FULL),
+	      sweepBudget(SWEEP_BUDGET)
+	{
+	}
+
+	Manager(size_t threshold, SweepMode sweepMode,
+	        size_t sweepBudget = SWEEP_BUDGET)
+	    : threshold(threshold), sweepMode(sweepMode), sweepBudget(sweepBudget)
+	{
+	}
 
 	/**
 	 * Deletes all objects managed by this class.
 	 */
 	~Manager();
 
+	/* Allocation */
+
+	/**
+	 * Enables the arena of this Manager. Managed objects allocated with
+	 * "new (mgr) T(mgr, ...)" are from now on allocated from size-classed
+	 * pools owned by this Manager, which are freed at once when the Manager
+	 * is destroyed.
+	 */
+	void enableArena();
+
+	/**
+	 * Returns a pointer at the arena of this Manager or nullptr if no arena
+	 * is enabled.
+	 *
+	 * @return the arena used for allocating objects.
+	 */
+	ManagedArena *getArena() { return arena.get(); }
+
+	/**
+	 * Switches the Manager into teardown mode. The reference graph is no
+	 * longer updated and objects are no longer freed when they become
+	 * unreachable. Instead, all objects still managed are destroyed in bulk
+	 * when the Manager is destroyed. Use this function if the complete object
+	 * graph is about to be thrown away.
+	 */
+	void bulkTeardown() { tearingDown = true; }
+
+	/**
+	 * Returns the number of live objects and the number of arena bytes
+	 * allocated for them per object type.
+	 *
+	 * @return a map from the Rtti of the objects to the allocation counters.
+	 */
+	std::unordered_map<const Rtti *, AllocationStatistics>
+	getAllocationStatistics() const;
+
+	/**
+	 * Returns the garbage collection counters and the current size of the
+	 * internal data structures.
+	 *
+	 * @return a Statistics instance describing the state of the Manager.
+	 */
+	Statistics getStatistics() const;
+
+	/**
+	 * Resets the garbage collection counters. The peak object count is reset
+	 * to the current number of live objects.
+	 */
+	void resetStatistics();
+
 	/* Reference management and garbage collection */
 
 	/**
@@ -306,10 +692,64 @@ public:
 	void deleteRef(Managed *tar, Managed *src) { deleteRef(tar, src, false); }
 
 	/**
-	 * Performs garbage collection.
+	 * Performs garbage collection. Traces all marked objects, independent of
+	 * the sweep mode.
 	 */
 	void sweep();
 
+	/**
+	 * Performs a single garbage collection step which visits at most (roughly)
+	 * the given number of objects.
+	 *
+	 * @param budget is the number of objects that may be visited.
+	 * @return true if no marked objects are left after this step.
+	 */
+	bool sweepStep(size_t budget);
+
+	/**
+	 * Sets the mode used for garbage collection once the sweep threshold is
+	 * reached.
+	 *
+	 * @param mode is the new sweep mode.
+	 * @param budget is the number of objects that may be visited in a single
+	 * incremental collection step.
+	 */
+	void setSweepMode(SweepMode mode, size_t budget = SWEEP_BUDGET)
+	{
+		sweepMode = mode;
+		sweepBudget = budget;
+	}
+
+	/**
+	 * Returns the mode used for garbage collection.
+	 *
+	 * @return the current sweep mode.
+	 */
+	SweepMode getSweepMode() const { return sweepMode; }
+
+	/**
+	 * Suspends automatic garbage collection. Objects whose reference count
+	 * drops to zero are still freed immediately, yet objects which would have
+	 * to be traced are only collected once sweeping is resumed. Calls may be
+	 * nested. Use the GcPause class instead of calling this function directly.
+	 */
+	void pauseSweep() { pauseDepth++; }
+
+	/**
+	 * Resumes automatic garbage collection after a call to pauseSweep(). When
+	 * the outermost pause ends, all objects marked in the meantime are
+	 * collected in a single sweep.
+	 */
+	void resumeSweep();
+
+	/**
+	 * Returns true if automatic garbage collection is currently suspended.
+	 *
+	 * @return true if pauseSweep() has been called more often than
+	 * resumeSweep().
+	 */
+	bool isSweepPaused() const { return pauseDepth > 0; }
+
 	/* Unique IDs */
 
 	/**
@@ -336,6 +776,37 @@ public:
 
 	/* Data storage */
 
+	/**
+	 * Returns the integer key for the given data key name. Repeated calls
+	 * with the same name return the same key. Use the returned key with the
+	 * DataKey variants of the data storage functions to avoid the string
+	 * lookup.
+	 *
+	 * @param name is the name of the key.
+	 * @return the interned key.
+	 */
+	DataKey internDataKey(const std::string &name);
+
+	/**
+	 * Returns the name of the given interned data key.
+	 *
+	 * @param key is a key returned by internDataKey.
+	 * @return the name of the key.
+	 */
+	const std::string &getDataKeyName(DataKey key) const;
+
+	/**
+	 * Registers some arbitrary data (in form of a Managed object) for the
+	 * given reference Managed object under a certain key. Overrides
+	 * references to existing data for that key.
+	 *
+	 * @param ref is the Managed object for which the data should be stored.
+	 * @param key is the interned key under which the data should be stored.
+	 * @param data is a reference to Managed object containing the data that
+	 * should be stored.
+	 */
+	void storeData(Managed *ref, DataKey key, Managed *data);
+
 	/**
 	 * Registers some arbitrary data (in form of a Managed object) for the
 	 * given reference Managed object under a certain (string) key. Overrides
@@ -346,7 +817,19 @@ public:
 	 * @param data is a reference to Managed object containing the data that
 	 * should be stored.
 	 */
-	void storeData(Managed *ref, const std::string &key, Managed *data);
+	void storeData(Managed *ref, const std::string &key, Managed *data)
+	{
+		storeData(ref, internDataKey(key), data);
+	}
+
+	/**
+	 * Returns the arbitrary data stored for the given reference managed object.
+	 *
+	 * @param ref is the Managed object for which the data should be stored.
+	 * @param key is the interned key for which the data should be retrieved.
+	 * @return a reference to the associated data with the given key.
+	 */
+	Managed *readData(Managed *ref, DataKey key) const;
 
 	/**
 	 * Returns the arbitrary data stored for the given reference managed object.
@@ -366,6 +849,15 @@ public:
 	 */
 	std::map<std::string, Managed *> readData(Managed *ref) const;
 
+	/**
+	 * Deletes the data stored for the given object with the given key.
+	 *
+	 * @param ref is the Managed object for which the data should be stored.
+	 * @param key is the interned key for which the data should be deleted.
+	 * @return true if data for this key was deleted, false otherwise.
+	 */
+	bool deleteData(Managed *ref, DataKey key);
+
 	/**
 	 * Deletes the data stored for the given object with the given key.
 	 *
@@ -431,6 +923,41 @@ public:
 	 */
 	bool triggerEvent(Managed *ref, Event &ev);
 
+	/**
+	 * Reports a change which may alter the result of resolving objects by
+	 * name, such as a named object being created or moved or a new reference
+	 * between objects. Name change events triggered via triggerEvent() are
+	 * reported automatically.
+	 */
+	void namesChanged() { nameGeneration++; }
+
+	/**
+	 * Returns a counter which is incremented whenever namesChanged() is
+	 * called. Caches of resolution results are valid as long as this value
+	 * does not change.
+	 *
+	 * @return the current name generation.
+	 */
+	uint64_t getNameGeneration() const { return nameGeneration; }
+
+	/**
+	 * Reports that an object which had already been validated was changed and
+	 * has to be validated again.
+	 */
+	void invalidated() { invalidationGeneration++; }
+
+	/**
+	 * Returns a counter which is incremented whenever invalidated() is called.
+	 * Values derived from validated objects are valid as long as this value
+	 * does not change.
+	 *
+	 * @return the current invalidation generation.
+	 */
+	uint64_t getInvalidationGeneration() const
+	{
+		return invalidationGeneration;
+	}
+
 #ifdef MANAGER_GRAPHVIZ_EXPORT
 	/**
 	 * Exports the current object graph managed by this manager instance to the
@@ -445,6 +972,37 @@ public:
 	void exportGraphviz(const char* filename);
 #endif
 };
+
+/**
+ * The GcPause class suspends automatic garbage collection of the given
+ * Manager for the lifetime of the instance. Use this class around phases in
+ * which the object graph is known to mostly grow (e.g. while parsing a file).
+ * All objects marked for collection during the pause are processed in a single
+ * sweep once the outermost GcPause instance is destroyed.
+ */
+class GcPause {
+private:
+	/**
+	 * Manager for which sweeping has been suspended.
+	 */
+	Manager &mgr;
+
+public:
+	/**
+	 * Constructor of the GcPause class, suspends sweeping.
+	 *
+	 * @param mgr is the Manager for which sweeping should be suspended.
+	 */
+	GcPause(Manager &mgr) : mgr(mgr) { mgr.pauseSweep(); }
+
+	/**
+	 * Destructor of the GcPause class, resumes sweeping.
+	 */
+	~GcPause() { mgr.resumeSweep(); }
+
+	GcPause(const GcPause &) = delete;
+	GcPause &operator=(const GcPause &) = delete;
+};
 }
 
 #endif /* _OUSIA_MANAGER_HPP_ */
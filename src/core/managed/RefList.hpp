@@ -0,0 +1,328 @@
+/*
+    Ousía
+    Copyright (C) 2014, 2015  Benjamin Paaßen, Andreas Stöckel
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file RefList.hpp
+ *
+ * Compact adjacency list used by the Manager to store the references from and
+ * to a managed object.
+ *
+ * @author Andreas Stöckel (astoecke@techfak.uni-bielefeld.de)
+ */
+
+#ifndef _OUSIA_REF_LIST_HPP_
+#define _OUSIA_REF_LIST_HPP_
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace ousia {
+
+// Forward declaration
+class Managed;
+
+/**
+ * The RefList class is a small-vector map from Managed pointers to reference
+ * counts. Most managed objects are only referenced by a handful of other
+ * objects, so the first entries are stored inline without any heap
+ * allocation. Larger lists are moved to the heap, once a list grows beyond
+ * INDEX_THRESHOLD entries an additional hash index is built, so lookups stay
+ * constant time for objects with a large degree (e.g. a StructuredClass
+ * referenced by all its instances). The order of the entries is unspecified.
+ */
+class RefList {
+public:
+	/**
+	 * Entry in the list. Mimics the value type of a std::map.
+	 */
+	struct Entry {
+		/**
+		 * Referenced or referencing Managed object.
+		 */
+		Managed *first;
+
+		/**
+		 * Reference count.
+		 */
+		int second;
+	};
+
+	using iterator = Entry *;
+	using const_iterator = const Entry *;
+
+private:
+	/**
+	 * Number of entries stored inline.
+	 */
+	static constexpr size_t INLINE_CAPACITY = 2;
+
+	/**
+	 * Number of entries at which the hash index is built.
+	 */
+	static constexpr size_t INDEX_THRESHOLD = 16;
+
+	/**
+	 * Heap storage used once the inline capacity is exceeded.
+	 */
+	struct Heap {
+		/**
+		 * Actual entries.
+		 */
+		std::vector<Entry> entries;
+
+		/**
+		 * Map from the Managed pointer to the index in the entries vector.
+		 * Only valid if the number of entries reached INDEX_THRESHOLD.
+		 */
+		std::unordered_map<Managed *, size_t> index;
+	};
+
+	/**
+	 * Number of entries stored inline.
+	 */
+	uint32_t inlineCount;
+
+	/**
+	 * Set to true if the entries are stored in the heap structure.
+	 */
+	bool onHeap;
+
+	union {
+		/**
+		 * Inline entries.
+		 */
+		Entry inlineEntries[INLINE_CAPACITY];
+
+		/**
+		 * Pointer at the heap storage.
+		 */
+		Heap *heap;
+	};
+
+	/**
+	 * Returns a pointer at the first entry.
+	 */
+	Entry *data() { return onHeap ? heap->entries.data() : inlineEntries; }
+
+	/**
+	 * Returns a pointer at the first entry.
+	 */
+	const Entry *data() const
+	{
+		return onHeap ? heap->entries.data() : inlineEntries;
+	}
+
+	/**
+	 * Returns true if the hash index is in use.
+	 */
+	bool indexed() const { return onHeap && !heap->index.empty(); }
+
+	/**
+	 * Frees the heap storage and resets the list.
+	 */
+	void release()
+	{
+		if (onHeap) {
+			delete heap;
+		}
+		inlineCount = 0;
+		onHeap = false;
+	}
+
+	/**
+	 * Copies the entries of the given list into this (empty) list.
+	 */
+	void copyFrom(const RefList &l)
+	{
+		if (l.onHeap) {
+			heap = new Heap(*l.heap);
+			onHeap = true;
+		} else {
+			for (uint32_t i = 0; i < l.inlineCount; i++) {
+				inlineEntries[i] = l.inlineEntries[i];
+			}
+			inlineCount = l.inlineCount;
+		}
+	}
+
+	/**
+	 * Moves the entries of the given list into this (empty) list, the given
+	 * list is empty afterwards.
+	 */
+	void moveFrom(RefList &l)
+	{
+		if (l.onHeap) {
+			heap = l.heap;
+			onHeap = true;
+			l.onHeap = false;
+		} else {
+			copyFrom(l);
+		}
+		l.inlineCount = 0;
+	}
+
+public:
+	/**
+	 * Creates an empty RefList.
+	 */
+	RefList() : inlineCount(0), onHeap(false) {}
+
+	RefList(const RefList &l) : inlineCount(0), onHeap(false) { copyFrom(l); }
+
+	RefList(RefList &&l) noexcept : inlineCount(0), onHeap(false)
+	{
+		moveFrom(l);
+	}
+
+	RefList &operator=(const RefList &l)
+	{
+		if (this != &l) {
+			release();
+			copyFrom(l);
+		}
+		return *this;
+	}
+
+	RefList &operator=(RefList &&l) noexcept
+	{
+		if (this != &l) {
+			release();
+			moveFrom(l);
+		}
+		return *this;
+	}
+
+	~RefList() { release(); }
+
+	/**
+	 * Returns the number of entries in the list.
+	 */
+	size_t size() const { return onHeap ? heap->entries.size() : inlineCount; }
+
+	/**
+	 * Returns true if the list has no entries.
+	 */
+	bool empty() const { return size() == 0; }
+
+	iterator begin() { return data(); }
+	iterator end() { return data() + size(); }
+	const_iterator begin() const { return data(); }
+	const_iterator end() const { return data() + size(); }
+	const_iterator cbegin() const { return data(); }
+	const_iterator cend() const { return data() + size(); }
+
+	/**
+	 * Searches the entry for the given Managed.
+	 *
+	 * @param o is the Managed object that should be looked up.
+	 * @return an iterator pointing at the entry or end() if no such entry
+	 * exists.
+	 */
+	iterator find(Managed *o)
+	{
+		return const_cast<iterator>(static_cast<const RefList *>(this)->find(o));
+	}
+
+	/**
+	 * Searches the entry for the given Managed.
+	 *
+	 * @param o is the Managed object that should be looked up.
+	 * @return an iterator pointing at the entry or end() if no such entry
+	 * exists.
+	 */
+	const_iterator find(Managed *o) const
+	{
+		if (indexed()) {
+			auto it = heap->index.find(o);
+			return it == heap->index.end() ? cend() : cbegin() + it->second;
+		}
+		for (const_iterator it = cbegin(); it != cend(); it++) {
+			if (it->first == o) {
+				return it;
+			}
+		}
+		return cend();
+	}
+
+	/**
+	 * Appends a new entry to the list. Does not check whether an entry for the
+	 * given Managed already exists.
+	 *
+	 * @param o is the Managed object for which the entry should be added.
+	 * @param count is the initial reference count.
+	 */
+	void emplace(Managed *o, int count)
+	{
+		if (!onHeap) {
+			if (inlineCount < INLINE_CAPACITY) {
+				inlineEntries[inlineCount++] = Entry{o, count};
+				return;
+			}
+
+			// Move the inline entries to the heap
+			Heap *h = new Heap();
+			h->entries.assign(inlineEntries, inlineEntries + inlineCount);
+			heap = h;
+			onHeap = true;
+		}
+
+		heap->entries.push_back(Entry{o, count});
+		const size_t n = heap->entries.size();
+		if (n > INDEX_THRESHOLD) {
+			heap->index.emplace(o, n - 1);
+		} else if (n == INDEX_THRESHOLD) {
+			for (size_t i = 0; i < n; i++) {
+				heap->index.emplace(heap->entries[i].first, i);
+			}
+		}
+	}
+
+	/**
+	 * Removes the given entry from the list. The last entry is moved into the
+	 * place of the removed entry, iterators pointing at the last element are
+	 * thus invalidated.
+	 *
+	 * @param it is an iterator pointing at the element that should be removed.
+	 */
+	void erase(iterator it)
+	{
+		Entry *d = data();
+		const size_t idx = it - d;
+		const size_t last = size() - 1;
+		if (indexed()) {
+			heap->index.erase(it->first);
+			if (idx != last) {
+				heap->index[d[last].first] = idx;
+			}
+		}
+		d[idx] = d[last];
+		if (onHeap) {
+			heap->entries.pop_back();
+			if (heap->entries.size() < INDEX_THRESHOLD) {
+				heap->index.clear();
+			}
+		} else {
+			inlineCount--;
+		}
+	}
+};
+}
+
+#endif /* _OUSIA_REF_LIST_HPP_ */
+
@@ -0,0 +1,1374 @@
+/*
+    Ousía
+    Copyright (C) 2014, 2015  Benjamin Paaßen, Andreas Stöckel
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <tuple>
+
+#include <core/common/Exceptions.hpp>
+#include <core/common/Logger.hpp>
+#include <core/common/Rtti.hpp>
+#include <core/common/Variant.hpp>
+
+#include "BinaryGraph.hpp"
+#include "Document.hpp"
+#include "Ontology.hpp"
+#include "Typesystem.hpp"
+
+namespace ousia {
+
+/* Class BinaryGraph */
+
+const char BinaryGraph::MAGIC[8] = {'O', 'U', 'S', 'I', 'A', 'B', 'G', '\0'};
+
+const uint32_t BinaryGraph::VERSION = 2;
+
+/**
+ * Tags used for the Variant types in the property data.
+ */
+enum class VariantTag : uint8_t {
+	NULLPTR,
+	BOOL,
+	INT,
+	DOUBLE,
+	STRING,
+	MAGIC,
+	ARRAY,
+	MAP,
+	CARDINALITY,
+	OBJECT
+};
+
+/**
+ * Exception thrown internally by the BinaryGraphWriter if the graph cannot be
+ * serialized.
+ */
+class UnserializableException : public OusiaException {
+public:
+	using OusiaException::OusiaException;
+};
+
+/**
+ * Returns the given node as DocumentEntity or nullptr if it is neither a
+ * StructuredEntity nor an AnnotationEntity.
+ */
+static const DocumentEntity *documentEntity(Handle<Node> node)
+{
+	if (node != nullptr && node->isa(&RttiTypes::StructuredEntity)) {
+		return node.cast<StructuredEntity>().get();
+	} else if (node != nullptr && node->isa(&RttiTypes::AnnotationEntity)) {
+		return node.cast<AnnotationEntity>().get();
+	}
+	return nullptr;
+}
+
+std::vector<Rooted<Node>> BinaryGraph::composita(Handle<Node> node)
+{
+	std::vector<Rooted<Node>> res;
+	if (node->isa(&RttiTypes::Ontology)) {
+		Handle<Ontology> ontology = node.cast<Ontology>();
+		for (Handle<StructuredClass> c : ontology->getStructureClasses()) {
+			res.emplace_back(c);
+		}
+		for (Handle<AnnotationClass> c : ontology->getAnnotationClasses()) {
+			res.emplace_back(c);
+		}
+	} else if (node->isa(&RttiTypes::Typesystem)) {
+		Handle<Typesystem> typesystem = node.cast<Typesystem>();
+		for (Handle<Type> t : typesystem->getTypes()) {
+			res.emplace_back(t);
+		}
+		for (Handle<Constant> c : typesystem->getConstants()) {
+			res.emplace_back(c);
+		}
+	} else if (node->isa(&RttiTypes::Descriptor)) {
+		// The field descriptor list may contain references at fields owned by
+		// other descriptors, these are not composita of this descriptor
+		Handle<Descriptor> descriptor = node.cast<Descriptor>();
+		res.emplace_back(descriptor->getAttributesDescriptor());
+		for (Rooted<FieldDescriptor> fd :
+		     descriptor->Descriptor::getFieldDescriptors()) {
+			if (fd->getParent() == node) {
+				res.emplace_back(fd);
+			}
+		}
+	} else if (node->isa(&RttiTypes::StructType)) {
+		Handle<StructType> structType = node.cast<StructType>();
+		for (Handle<Attribute> a : structType->getOwnAttributes()) {
+			res.emplace_back(a);
+		}
+	} else if (node->isa(&RttiTypes::Document)) {
+		Handle<Document> document = node.cast<Document>();
+		if (document->getRoot() != nullptr) {
+			res.emplace_back(document->getRoot());
+		}
+		for (Handle<AnnotationEntity> a : document->getAnnotations()) {
+			res.emplace_back(a);
+		}
+	} else if (const DocumentEntity *entity = documentEntity(node)) {
+		// The children of all fields, in the order of the fields
+		for (const auto &field : entity->getFields()) {
+			for (Handle<StructureNode> child : field) {
+				res.emplace_back(child);
+			}
+		}
+	}
+	return res;
+}
+
+/* Class BinaryGraphWriter */
+
+/**
+ * Appends a 32 bit little endian integer to the given string.
+ */
+static void appendWord(std::string &out, uint32_t v)
+{
+	const char bytes[4] = {char(v & 0xFF), char((v >> 8) & 0xFF),
+	                       char((v >> 16) & 0xFF), char((v >> 24) & 0xFF)};
+	out.append(bytes, 4);
+}
+
+/**
+ * Pads the given string with zeros to a multiple of four bytes.
+ */
+static void alignWord(std::string &out)
+{
+	while (out.size() % 4 != 0) {
+		out.push_back('\0');
+	}
+}
+
+/**
+ * Returns the root node of the given node.
+ */
+static const Node *rootOf(const Node *node)
+{
+	while (!node->isRoot()) {
+		node = static_cast<const Node *>(node->getParent().get());
+	}
+	return node;
+}
+
+/**
+ * Returns true if the given node is an anonymous type, which is not part of
+ * any typesystem and must thus be written along with the graph.
+ */
+static bool isAnonymousType(Handle<Node> node)
+{
+	return node->type() == &RttiTypes::ArrayType ||
+	       node->type() == &RttiTypes::ReferenceType;
+}
+
+BinaryGraphWriter::BinaryGraphWriter(
+    const std::vector<Rooted<Node>> &dependencies, SourceId sourceId)
+    : sourceId(sourceId)
+{
+	for (const Rooted<Node> &dependency : dependencies) {
+		this->dependencies.push_back(dependency.get());
+	}
+}
+
+void BinaryGraphWriter::collect(Handle<Node> node, const Node *owner)
+{
+	nodeIndices.emplace(node.get(), nodes.size());
+	nodes.emplace_back(node);
+	owners.push_back(owner);
+	for (const Rooted<Node> &child : BinaryGraph::composita(node)) {
+		collect(child, node.get());
+	}
+}
+
+uint32_t BinaryGraphWriter::string(const std::string &s)
+{
+	auto res = stringIndices.emplace(s, strings.size());
+	if (res.second) {
+		strings.push_back(s);
+	}
+	return res.first->second;
+}
+
+uint32_t BinaryGraphWriter::ref(Handle<Node> node)
+{
+	if (node == nullptr) {
+		return 0;
+	}
+
+	// Nodes which already are in the node table or the external table
+	auto it = nodeIndices.find(node.get());
+	if (it != nodeIndices.end()) {
+		return 1 + it->second;
+	}
+	auto extIt = externalIndices.find(node.get());
+	if (extIt != externalIndices.end()) {
+		return 1 + (1U << 31) + extIt->second;
+	}
+
+	// Anonymous types are written along with the graph
+	if (isAnonymousType(node)) {
+		nodeIndices.emplace(node.get(), nodes.size());
+		nodes.emplace_back(node);
+		owners.push_back(nullptr);
+		return nodes.size();
+	}
+
+	// Nodes belonging to one of the dependencies are referenced by the path
+	// leading from the root to the node
+	const Node *root = rootOf(node.get());
+	auto depIt = std::find(dependencies.begin(), dependencies.end(), root);
+	if (depIt != dependencies.end()) {
+		std::vector<uint32_t> path;
+		Rooted<Node> cur = node;
+		while (cur != root) {
+			Rooted<Node> parent = cur->getParent().cast<Node>();
+			std::vector<Rooted<Node>> siblings = BinaryGraph::composita(parent);
+			auto idx = std::find(siblings.begin(), siblings.end(), cur);
+			if (idx == siblings.end()) {
+				throw UnserializableException{
+				    "Referenced node is not part of the dependency"};
+			}
+			path.push_back(idx - siblings.begin());
+			cur = parent;
+		}
+		const uint32_t idx = externals.size() / BinaryGraph::EXTERNAL_WORDS;
+		externals.push_back(depIt - dependencies.begin());
+		externals.push_back(string(node->type()->name));
+		externals.push_back(paths.size());
+		externals.push_back(path.size());
+		paths.insert(paths.end(), path.rbegin(), path.rend());
+		externalIndices.emplace(node.get(), idx);
+		return 1 + (1U << 31) + idx;
+	}
+
+	// Other ontologies and typesystems (such as a typesystem defined inside
+	// an ontology) are written along with the graph
+	if (root == node.get() && (node->type() == &RttiTypes::Ontology ||
+	                           node->type() == &RttiTypes::Typesystem)) {
+		collect(node, nullptr);
+		return 1 + nodeIndices[node.get()];
+	}
+	if (root->type() == &RttiTypes::Ontology ||
+	    root->type() == &RttiTypes::Typesystem) {
+		collect(const_cast<Node *>(root), nullptr);
+		auto rootIt = nodeIndices.find(node.get());
+		if (rootIt != nodeIndices.end()) {
+			return 1 + rootIt->second;
+		}
+	}
+	throw UnserializableException{
+	    std::string("Cannot reference node of type ") + node->type()->name};
+}
+
+void BinaryGraphWriter::writeRef(Handle<Node> node)
+{
+	edges.push_back(ref(node));
+}
+
+template <class T>
+void BinaryGraphWriter::writeRefs(const T &list)
+{
+	edges.push_back(list.size());
+	for (const auto &node : list) {
+		writeRef(node);
+	}
+}
+
+void BinaryGraphWriter::writeInt(uint64_t v)
+{
+	do {
+		const uint8_t b = v & 0x7F;
+		v = v >> 7;
+		properties.push_back(v ? (b | 0x80) : b);
+	} while (v);
+}
+
+void BinaryGraphWriter::writeVariant(const Variant &v)
+{
+	switch (v.getType()) {
+		case VariantType::NULLPTR:
+			writeInt(uint8_t(VariantTag::NULLPTR));
+			break;
+		case VariantType::BOOL:
+			writeInt(uint8_t(VariantTag::BOOL));
+			writeInt(v.asBool());
+			break;
+		case VariantType::INT: {
+			const int64_t i = v.asInt();
+			writeInt(uint8_t(VariantTag::INT));
+			writeInt((uint64_t(i) << 1) ^ uint64_t(i >> 63));
+			break;
+		}
+		case VariantType::DOUBLE: {
+			const double d = v.asDouble();
+			uint64_t bits;
+			memcpy(&bits, &d, sizeof(bits));
+			writeInt(uint8_t(VariantTag::DOUBLE));
+			writeInt(bits);
+			break;
+		}
+		case VariantType::STRING:
+			writeInt(uint8_t(VariantTag::STRING));
+			writeInt(string(v.asString()));
+			break;
+		case VariantType::MAGIC:
+			writeInt(uint8_t(VariantTag::MAGIC));
+			writeInt(string(v.asMagic()));
+			break;
+		case VariantType::ARRAY:
+			writeInt(uint8_t(VariantTag::ARRAY));
+			writeInt(v.asArray().size());
+			for (const Variant &e : v.asArray()) {
+				writeVariant(e);
+			}
+			break;
+		case VariantType::MAP:
+			writeInt(uint8_t(VariantTag::MAP));
+			writeInt(v.asMap().size());
+			for (const auto &e : v.asMap()) {
+				writeInt(string(e.first));
+				writeVariant(e.second);
+			}
+			break;
+		case VariantType::CARDINALITY: {
+			const auto &ranges = v.asCardinality().getRanges();
+			writeInt(uint8_t(VariantTag::CARDINALITY));
+			writeInt(ranges.size());
+			for (const auto &r : ranges) {
+				writeInt(r.start);
+				writeInt(r.end);
+			}
+			break;
+		}
+		case VariantType::OBJECT: {
+			// References at nodes are stored in the edge table
+			Rooted<Managed> obj = v.asObject();
+			if (obj != nullptr && !obj->isa(&RttiTypes::Node)) {
+				throw UnserializableException{
+				    "Cannot serialize reference at a non-node object"};
+			}
+			writeInt(uint8_t(VariantTag::OBJECT));
+			writeRef(obj.cast<Node>());
+			break;
+		}
+		default:
+			throw UnserializableException{
+			    std::string("Cannot serialize variant of type ") +
+			    v.getTypeName()};
+	}
+}
+
+void BinaryGraphWriter::writeToken(const TokenDescriptor &token)
+{
+	// The ids of user defined tokens are assigned by the document parser,
+	// only special token ids are part of the ontology
+	writeInt(string(token.token));
+	writeInt(token.special ? token.id : Tokens::Empty);
+	writeInt((token.special ? 1 : 0) | (token.greedy ? 2 : 0));
+}
+
+/**
+ * Returns the number of subclasses of the superclass of the given class which
+ * precede the given class and belong to the same ontology. Used to restore
+ * the order of the subclass lists.
+ */
+static size_t subclassRank(Handle<StructuredClass> c)
+{
+	size_t rank = 0;
+	for (Handle<StructuredClass> sc : c->getSuperclass()->getSubclasses()) {
+		if (sc == c) {
+			break;
+		}
+		if (sc->getParent() == c->getParent()) {
+			rank++;
+		}
+	}
+	return rank;
+}
+
+void BinaryGraphWriter::recordFields(
+    const std::vector<NodeVector<StructureNode>> &fields)
+{
+	for (size_t f = 0; f < fields.size(); f++) {
+		for (Handle<StructureNode> child : fields[f]) {
+			fieldIndices[child.get()] = f;
+		}
+	}
+}
+
+void BinaryGraphWriter::writeNode(Handle<Node> node)
+{
+	const Rtti *type = node->type();
+	if (type == &RttiTypes::Ontology) {
+		Handle<Ontology> ontology = node.cast<Ontology>();
+		writeRefs(ontology->getTypesystems());
+		writeRefs(ontology->getOntologies());
+	} else if (type == &RttiTypes::Typesystem) {
+		Handle<Typesystem> typesystem = node.cast<Typesystem>();
+		for (Handle<Type> t : typesystem->getTypes()) {
+			if (t->getParent() != node) {
+				throw UnserializableException{"Type not owned by typesystem"};
+			}
+		}
+		for (Handle<Constant> c : typesystem->getConstants()) {
+			if (c->getParent() != node) {
+				throw UnserializableException{
+				    "Constant not owned by typesystem"};
+			}
+		}
+		writeRefs(typesystem->getTypesystemReferences());
+		writeRefs(typesystem->getTypes());
+		writeRefs(typesystem->getConstants());
+	} else if (type == &RttiTypes::StructuredClass) {
+		Handle<StructuredClass> c = node.cast<StructuredClass>();
+		writeRef(c->getSuperclass());
+		writeRefs(c->Descriptor::getFieldDescriptors());
+		writeVariant(c->getCardinality());
+		writeInt((c->isTransparent() ? 1 : 0) |
+		         (c->hasRootPermission() ? 2 : 0));
+		writeInt(c->getSuperclass() == nullptr ? 0 : subclassRank(c));
+		writeToken(c->getOpenToken());
+		writeToken(c->getCloseToken());
+		writeToken(c->getShortToken());
+	} else if (type == &RttiTypes::AnnotationClass) {
+		Handle<AnnotationClass> c = node.cast<AnnotationClass>();
+		writeRefs(c->getFieldDescriptors());
+		writeToken(c->getOpenToken());
+		writeToken(c->getCloseToken());
+	} else if (type == &RttiTypes::FieldDescriptor) {
+		Handle<FieldDescriptor> fd = node.cast<FieldDescriptor>();
+		writeRef(fd->isPrimitive() ? fd->getPrimitiveType() : nullptr);
+		writeRefs(fd->getChildren());
+		writeInt(fd->isPrimitive() ? 1 : 0);
+		writeInt(static_cast<uint8_t>(fd->getFieldType()));
+		writeInt(fd->isOptional() ? 1 : 0);
+		writeInt(static_cast<uint8_t>(fd->getWhitespaceMode()));
+		writeToken(fd->getOpenToken());
+		writeToken(fd->getCloseToken());
+	} else if (type == &RttiTypes::StructType) {
+		// The parent structure of an attributes descriptor follows from the
+		// superclass of the descriptor
+		Handle<StructType> s = node.cast<StructType>();
+		const Node *owner = owners[nodeIndices[node.get()]];
+		const bool attributesDescriptor =
+		    owner != nullptr && owner->isa(&RttiTypes::Descriptor);
+		writeRef(attributesDescriptor ? nullptr : s->getParentStructure());
+		writeRefs(s->getOwnAttributes());
+	} else if (type == &RttiTypes::EnumType) {
+		Handle<EnumType> e = node.cast<EnumType>();
+		const std::vector<std::string> names = e->names();
+		writeInt(names.size());
+		for (size_t i = 0; i < names.size(); i++) {
+			writeInt(string(e->nameOf(i)));
+		}
+	} else if (type == &RttiTypes::Attribute) {
+		Handle<Attribute> a = node.cast<Attribute>();
+		writeRef(a->getType());
+		writeInt(a->isOptional() ? 1 : 0);
+		writeVariant(a->getDefaultValue());
+	} else if (type == &RttiTypes::Constant) {
+		Handle<Constant> c = node.cast<Constant>();
+		writeRef(c->getType());
+		writeVariant(c->getValue());
+	} else if (type == &RttiTypes::ArrayType) {
+		writeRef(node.cast<ArrayType>()->getInnerType());
+	} else if (type == &RttiTypes::ReferenceType) {
+		writeRef(node.cast<ReferenceType>()->getDescriptor());
+	} else if (type == &RttiTypes::Document) {
+		Handle<Document> document = node.cast<Document>();
+		writeRefs(document->getOntologies());
+		writeRefs(document->getTypesystems());
+	} else if (type == &RttiTypes::StructuredEntity) {
+		Handle<StructuredEntity> entity = node.cast<StructuredEntity>();
+		writeRef(entity->getDescriptor());
+		recordFields(documentEntity(node)->getFields());
+		writeInt(fieldIndices[node.get()]);
+		writeInt(entity->isTransparent() ? 1 : 0);
+		writeVariant(entity->getAttributes());
+	} else if (type == &RttiTypes::AnnotationEntity) {
+		Handle<AnnotationEntity> entity = node.cast<AnnotationEntity>();
+		writeRef(entity->getDescriptor());
+		writeRef(entity->getStart());
+		writeRef(entity->getEnd());
+		recordFields(documentEntity(node)->getFields());
+		writeVariant(entity->getAttributes());
+	} else if (type == &RttiTypes::DocumentPrimitive) {
+		writeInt(fieldIndices[node.get()]);
+		writeVariant(node.cast<DocumentPrimitive>()->getContent());
+	} else if (type == &RttiTypes::Anchor) {
+		writeInt(fieldIndices[node.get()]);
+	} else {
+		throw UnserializableException{
+		    std::string("Cannot serialize node of type ") + type->name};
+	}
+}
+
+bool BinaryGraphWriter::write(Handle<Node> root, std::string &out)
+{
+	if (root->type() != &RttiTypes::Document &&
+	    root->type() != &RttiTypes::Ontology &&
+	    root->type() != &RttiTypes::Typesystem) {
+		return false;
+	}
+
+	// Write the edges and properties of all nodes, the node table grows while
+	// references at other roots and anonymous types are discovered
+	std::vector<uint32_t> records;
+	try {
+		collect(root, nullptr);
+		for (size_t i = 0; i < nodes.size(); i++) {
+			Handle<Node> node = nodes[i];
+			const uint32_t edgeBegin = edges.size();
+			const uint32_t propertyOffset = properties.size();
+			writeNode(node);
+
+			const SourceLocation loc = node->getLocation();
+			const bool hasLoc = loc.isValid() && loc.getSourceId() == sourceId;
+			records.push_back(string(node->type()->name));
+			records.push_back(string(node->getName()));
+			records.push_back(owners[i] ? 1 + nodeIndices[owners[i]] : 0);
+			records.push_back(hasLoc ? loc.getStart() : InvalidSourceOffset);
+			records.push_back(hasLoc ? loc.getEnd() : InvalidSourceOffset);
+			records.push_back(edgeBegin);
+			records.push_back(edges.size() - edgeBegin);
+			records.push_back(propertyOffset);
+		}
+	}
+	catch (const UnserializableException &) {
+		return false;
+	}
+
+	// External references are stored after the nodes, now that the number of
+	// nodes is known
+	const uint32_t externalBase = 1 + nodes.size();
+	for (uint32_t &edge : edges) {
+		if (edge > (1U << 31)) {
+			edge = externalBase + (edge - 1 - (1U << 31));
+		}
+	}
+	for (size_t i = 0; i < externals.size(); i += BinaryGraph::EXTERNAL_WORDS) {
+		externals[i + 2] += edges.size();
+	}
+	edges.insert(edges.end(), paths.begin(), paths.end());
+
+	// Assemble the string data
+	std::string stringData;
+	std::vector<uint32_t> stringOffsets;
+	for (const std::string &s : strings) {
+		stringOffsets.push_back(stringData.size());
+		stringData.append(s);
+	}
+	stringOffsets.push_back(stringData.size());
+
+	// Write the header and the tables
+	out.clear();
+	out.append(BinaryGraph::MAGIC, sizeof(BinaryGraph::MAGIC));
+	appendWord(out, BinaryGraph::VERSION);
+	appendWord(out, nodes.size());
+	appendWord(out, externals.size() / BinaryGraph::EXTERNAL_WORDS);
+	appendWord(out, strings.size());
+	appendWord(out, edges.size());
+	appendWord(out, stringData.size());
+	appendWord(out, properties.size());
+	for (uint32_t offs : stringOffsets) {
+		appendWord(out, offs);
+	}
+	for (uint32_t v : records) {
+		appendWord(out, v);
+	}
+	for (uint32_t v : externals) {
+		appendWord(out, v);
+	}
+	for (uint32_t v : edges) {
+		appendWord(out, v);
+	}
+	out.append(stringData);
+	alignWord(out);
+	out.append(properties);
+	return true;
+}
+
+/* Class BinaryGraphReader */
+
+namespace {
+/**
+ * Internally used class holding the state of the BinaryGraphReader while a
+ * graph is being read.
+ */
+class GraphReader {
+private:
+	/**
+	 * Position in the edge table and the property data of a node.
+	 */
+	struct Cursor {
+		size_t edge;
+		size_t edgeEnd;
+		size_t property;
+	};
+
+	Manager &mgr;
+	const uint8_t *data;
+	size_t size;
+	const std::vector<Rooted<Node>> &dependencies;
+	SourceId sourceId;
+
+	uint32_t nodeCount;
+	uint32_t externalCount;
+	uint32_t stringCount;
+	uint32_t edgeCount;
+
+	size_t stringOffsetsPos;
+	size_t nodesPos;
+	size_t externalsPos;
+	size_t edgesPos;
+	size_t stringDataPos;
+	size_t propertiesPos;
+	size_t propertiesEnd;
+
+	/**
+	 * Nodes in the order of the node table, anonymous types are created once
+	 * they are referenced.
+	 */
+	std::vector<Rooted<Node>> nodes;
+
+	/**
+	 * Cursor at the edges of each node, set once the properties of the node
+	 * have been read.
+	 */
+	std::vector<Cursor> cursors;
+
+	/**
+	 * Resolved external nodes.
+	 */
+	std::vector<Rooted<Node>> externalNodes;
+
+	uint32_t word(size_t pos) const
+	{
+		const uint8_t *p = data + pos;
+		return uint32_t(p[0]) | (uint32_t(p[1]) << 8) |
+		       (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+	}
+
+	uint32_t nodeWord(uint32_t idx, size_t field) const
+	{
+		return word(nodesPos + (idx * BinaryGraph::NODE_WORDS + field) * 4);
+	}
+
+	std::string string(uint64_t idx) const
+	{
+		if (idx >= stringCount) {
+			throw LoggableException{"Invalid string index in binary graph"};
+		}
+		const uint32_t begin = word(stringOffsetsPos + idx * 4);
+		const uint32_t end = word(stringOffsetsPos + idx * 4 + 4);
+		if (begin > end || stringDataPos + end > propertiesPos) {
+			throw LoggableException{"Invalid string offset in binary graph"};
+		}
+		return std::string(reinterpret_cast<const char *>(data) +
+		                       stringDataPos + begin,
+		                   end - begin);
+	}
+
+	uint32_t edge(Cursor &cursor) const
+	{
+		if (cursor.edge >= cursor.edgeEnd) {
+			throw LoggableException{"Unexpected end of edges in binary graph"};
+		}
+		return word(edgesPos + (cursor.edge++) * 4);
+	}
+
+	uint64_t readInt(Cursor &cursor) const
+	{
+		uint64_t res = 0;
+		for (unsigned int shift = 0; shift < 64; shift += 7) {
+			if (cursor.property >= propertiesEnd) {
+				break;
+			}
+			const uint8_t b = data[cursor.property++];
+			res |= uint64_t(b & 0x7F) << shift;
+			if (!(b & 0x80)) {
+				return res;
+			}
+		}
+		throw LoggableException{"Invalid integer in binary graph"};
+	}
+
+	/**
+	 * Reads a variant, references at other nodes are resolved immediately and
+	 * owned by the given owner.
+	 */
+	Variant readVariant(Cursor &cursor, Managed *owner = nullptr)
+	{
+		switch (static_cast<VariantTag>(readInt(cursor))) {
+			case VariantTag::NULLPTR:
+				return Variant{nullptr};
+			case VariantTag::BOOL:
+				return Variant{readInt(cursor) != 0};
+			case VariantTag::INT: {
+				const uint64_t v = readInt(cursor);
+				return Variant{Variant::intType((v >> 1) ^ (~(v & 1) + 1))};
+			}
+			case VariantTag::DOUBLE: {
+				const uint64_t bits = readInt(cursor);
+				double d;
+				memcpy(&d, &bits, sizeof(d));
+				return Variant{d};
+			}
+			case VariantTag::STRING:
+				return Variant::fromString(string(readInt(cursor)));
+			case VariantTag::MAGIC: {
+				Variant res;
+				res.setMagic(string(readInt(cursor)).c_str());
+				return res;
+			}
+			case VariantTag::ARRAY: {
+				Variant::arrayType arr;
+				const uint64_t count = readInt(cursor);
+				for (uint64_t i = 0; i < count; i++) {
+					arr.emplace_back(readVariant(cursor, owner));
+				}
+				return Variant{arr};
+			}
+			case VariantTag::MAP: {
+				Variant::mapType map;
+				const uint64_t count = readInt(cursor);
+				for (uint64_t i = 0; i < count; i++) {
+					std::string key = string(readInt(cursor));
+					map.emplace(std::move(key), readVariant(cursor, owner));
+				}
+				return Variant{map};
+			}
+			case VariantTag::CARDINALITY: {
+				Variant::cardinalityType cardinality;
+				const uint64_t count = readInt(cursor);
+				for (uint64_t i = 0; i < count; i++) {
+					const size_t start = readInt(cursor);
+					const size_t end = readInt(cursor);
+					cardinality.merge(Range<size_t>{start, end});
+				}
+				return Variant{cardinality};
+			}
+			case VariantTag::OBJECT: {
+				Variant res;
+				res.setObject(resolve(edge(cursor)), owner);
+				return res;
+			}
+		}
+		throw LoggableException{"Invalid variant in binary graph"};
+	}
+
+	TokenDescriptor readToken(Cursor &cursor) const
+	{
+		TokenDescriptor res{string(readInt(cursor))};
+		res.id = readInt(cursor);
+		const uint64_t flags = readInt(cursor);
+		res.special = flags & 1;
+		res.greedy = flags & 2;
+		return res;
+	}
+
+	/**
+	 * Returns the node the given reference points at, creates anonymous types
+	 * and resolves external nodes if necessary.
+	 */
+	Rooted<Node> resolve(uint32_t ref)
+	{
+		if (ref == 0) {
+			return nullptr;
+		}
+		if (ref <= nodeCount) {
+			if (nodes[ref - 1] == nullptr) {
+				createAnonymousType(ref - 1);
+			}
+			return nodes[ref - 1];
+		}
+		if (ref - nodeCount - 1 < externalCount) {
+			return resolveExternal(ref - nodeCount - 1);
+		}
+		throw LoggableException{"Invalid reference in binary graph"};
+	}
+
+	/**
+	 * Resolves a reference and checks the type of the resulting node.
+	 */
+	template <class T>
+	Rooted<T> resolve(uint32_t ref, const Rtti &type)
+	{
+		Rooted<Node> res = resolve(ref);
+		if (res != nullptr && !res->isa(&type)) {
+			throw LoggableException{std::string("Expected node of type ") +
+			                        type.name + " in binary graph"};
+		}
+		return res.cast<T>();
+	}
+
+	Rooted<Node> resolveExternal(uint32_t idx)
+	{
+		if (externalNodes[idx] != nullptr) {
+			return externalNodes[idx];
+		}
+		const size_t pos = externalsPos + idx * BinaryGraph::EXTERNAL_WORDS * 4;
+		const uint32_t dependency = word(pos);
+		const std::string tag = string(word(pos + 4));
+		const uint32_t pathBegin = word(pos + 8);
+		const uint32_t pathLength = word(pos + 12);
+		if (dependency >= dependencies.size() || pathBegin > edgeCount ||
+		    pathLength > edgeCount - pathBegin) {
+			throw LoggableException{"Invalid external node in binary graph"};
+		}
+		Rooted<Node> node = dependencies[dependency];
+		for (uint32_t i = 0; i < pathLength; i++) {
+			const std::vector<Rooted<Node>> composita =
+			    BinaryGraph::composita(node);
+			const uint32_t k = word(edgesPos + (pathBegin + i) * 4);
+			if (k >= composita.size()) {
+				throw LoggableException{
+				    "External node of binary graph not found"};
+			}
+			node = composita[k];
+		}
+		if (node->type()->name != tag) {
+			throw LoggableException{"External node of binary graph not found"};
+		}
+		externalNodes[idx] = node;
+		return node;
+	}
+
+	Cursor cursor(uint32_t idx) const
+	{
+		const uint32_t edgeBegin = nodeWord(idx, 5);
+		const uint32_t count = nodeWord(idx, 6);
+		const uint32_t property = nodeWord(idx, 7);
+		if (edgeBegin > edgeCount || count > edgeCount - edgeBegin ||
+		    property > propertiesEnd - propertiesPos) {
+			throw LoggableException{"Invalid node record in binary graph"};
+		}
+		return Cursor{edgeBegin, edgeBegin + count, propertiesPos + property};
+	}
+
+	void createAnonymousType(uint32_t idx)
+	{
+		Cursor c = cursor(idx);
+		const std::string tag = string(nodeWord(idx, 0));
+		Rooted<Node> node;
+		if (tag == RttiTypes::ArrayType.name) {
+			Rooted<Type> inner = resolve<Type>(edge(c), RttiTypes::Type);
+			if (inner == nullptr) {
+				throw LoggableException{"Array type without inner type"};
+			}
+			node = Rooted<ArrayType>{new ArrayType(inner)};
+		} else if (tag == RttiTypes::ReferenceType.name) {
+			node = Rooted<ReferenceType>{new ReferenceType(
+			    mgr, string(nodeWord(idx, 1)),
+			    resolve<Descriptor>(edge(c), RttiTypes::Descriptor))};
+		} else {
+			throw LoggableException{"Invalid node in binary graph"};
+		}
+		nodes[idx] = node;
+		cursors[idx] = c;
+	}
+
+	/**
+	 * Creates the node with the given index and reads its properties. The
+	 * owner of the node has already been created.
+	 */
+	void create(uint32_t idx)
+	{
+		Cursor c = cursor(idx);
+		const std::string tag = string(nodeWord(idx, 0));
+		const std::string name = string(nodeWord(idx, 1));
+		const uint32_t ownerRef = nodeWord(idx, 2);
+		if (ownerRef > idx) {
+			throw LoggableException{"Invalid owner in binary graph"};
+		}
+		Rooted<Node> owner = ownerRef == 0 ? nullptr : nodes[ownerRef - 1];
+		auto ownerIs = [&owner](const Rtti &type) {
+			if (owner == nullptr || !owner->isa(&type)) {
+				throw LoggableException{"Invalid owner in binary graph"};
+			}
+		};
+
+		Rooted<Node> node;
+		if (tag == RttiTypes::ArrayType.name ||
+		    tag == RttiTypes::ReferenceType.name) {
+			// Anonymous types are created once they are referenced
+			return;
+		} else if (isDocumentNode(tag)) {
+			// Document nodes are created once the ontologies are complete
+			return;
+		} else if (tag == RttiTypes::Ontology.name) {
+			node = Rooted<Ontology>{new Ontology(mgr, name)};
+		} else if (tag == RttiTypes::Typesystem.name) {
+			node = Rooted<Typesystem>{new Typesystem(mgr, name)};
+		} else if (tag == RttiTypes::StructuredClass.name) {
+			ownerIs(RttiTypes::Ontology);
+			Variant cardinality = readVariant(c);
+			const uint64_t flags = readInt(c);
+			ranks[idx] = readInt(c);
+			Rooted<StructuredClass> sc{new StructuredClass(
+			    mgr, name, owner.cast<Ontology>(), cardinality, nullptr,
+			    flags & 1, flags & 2)};
+			sc->setOpenToken(readToken(c));
+			sc->setCloseToken(readToken(c));
+			sc->setShortToken(readToken(c));
+			node = sc;
+		} else if (tag == RttiTypes::AnnotationClass.name) {
+			ownerIs(RttiTypes::Ontology);
+			Rooted<AnnotationClass> ac{
+			    new AnnotationClass(mgr, name, owner.cast<Ontology>())};
+			ac->setOpenToken(readToken(c));
+			ac->setCloseToken(readToken(c));
+			node = ac;
+		} else if (tag == RttiTypes::FieldDescriptor.name) {
+			ownerIs(RttiTypes::Descriptor);
+			const bool primitive = readInt(c);
+			const auto fieldType =
+			    static_cast<FieldDescriptor::FieldType>(readInt(c));
+			const bool optional = readInt(c);
+			const auto whitespaceMode = static_cast<WhitespaceMode>(readInt(c));
+			Rooted<FieldDescriptor> fd;
+			if (primitive) {
+				fd = Rooted<FieldDescriptor>{new FieldDescriptor(
+				    mgr, Handle<Type>{nullptr}, owner.cast<Descriptor>(),
+				    fieldType, name, optional, whitespaceMode)};
+			} else {
+				fd = Rooted<FieldDescriptor>{
+				    new FieldDescriptor(mgr, owner.cast<Descriptor>(),
+				                        fieldType, name, optional,
+				                        whitespaceMode)};
+			}
+			fd->setOpenToken(readToken(c));
+			fd->setCloseToken(readToken(c));
+			node = fd;
+		} else if (tag == RttiTypes::StructType.name) {
+			if (owner != nullptr && owner->isa(&RttiTypes::Descriptor)) {
+				node = owner.cast<Descriptor>()->getAttributesDescriptor();
+			} else {
+				ownerIs(RttiTypes::Typesystem);
+				node = Rooted<StructType>{
+				    new StructType(mgr, name, owner.cast<Typesystem>())};
+			}
+		} else if (tag == RttiTypes::EnumType.name) {
+			ownerIs(RttiTypes::Typesystem);
+			std::vector<std::string> names;
+			const uint64_t count = readInt(c);
+			for (uint64_t i = 0; i < count; i++) {
+				names.emplace_back(string(readInt(c)));
+			}
+			Rooted<EnumType> e{
+			    new EnumType(mgr, name, owner.cast<Typesystem>())};
+			e->addEntries(names, logger);
+			node = e;
+		} else if (tag == RttiTypes::Attribute.name) {
+			ownerIs(RttiTypes::StructType);
+			references[idx] = edge(c);
+			const bool optional = readInt(c);
+			node = Rooted<Attribute>{
+			    new Attribute(mgr, name, readVariant(c), optional)};
+		} else if (tag == RttiTypes::Constant.name) {
+			ownerIs(RttiTypes::Typesystem);
+			references[idx] = edge(c);
+			node = Rooted<Constant>{new Constant(
+			    mgr, name, owner.cast<Typesystem>(), readVariant(c))};
+		} else {
+			throw LoggableException{std::string("Invalid node type \"") + tag +
+			                        "\" in binary graph"};
+		}
+
+		setNode(idx, node, c);
+	}
+
+	/**
+	 * Restores the location of the given node and stores it in the node list.
+	 */
+	void setNode(uint32_t idx, Handle<Node> node, const Cursor &c)
+	{
+		const SourceOffset start = nodeWord(idx, 3);
+		const SourceOffset end = nodeWord(idx, 4);
+		if (start != InvalidSourceOffset) {
+			node->setLocation(SourceLocation{sourceId, start, end});
+		}
+		nodes[idx] = node;
+		cursors[idx] = c;
+	}
+
+	/**
+	 * Returns true if nodes of the given type are part of a document.
+	 */
+	static bool isDocumentNode(const std::string &tag)
+	{
+		return tag == RttiTypes::Document.name ||
+		       tag == RttiTypes::StructuredEntity.name ||
+		       tag == RttiTypes::AnnotationEntity.name ||
+		       tag == RttiTypes::DocumentPrimitive.name ||
+		       tag == RttiTypes::Anchor.name;
+	}
+
+	/**
+	 * Reads the index of the field of the given owner a document node is
+	 * stored in and checks it against the fields of the owner.
+	 */
+	size_t fieldIndex(Handle<Node> owner, Cursor &c)
+	{
+		const DocumentEntity *entity = documentEntity(owner);
+		if (entity == nullptr) {
+			throw LoggableException{"Invalid owner in binary graph"};
+		}
+		const uint64_t idx = readInt(c);
+		if (idx >= entity->getFields().size()) {
+			throw LoggableException{"Invalid field index in binary graph"};
+		}
+		return idx;
+	}
+
+	/**
+	 * Creates the document node with the given index and adds it to the field
+	 * of its owner. The descriptors of the entities are already complete.
+	 */
+	void createDocumentNode(uint32_t idx)
+	{
+		Cursor c = cursor(idx);
+		const std::string tag = string(nodeWord(idx, 0));
+		const std::string name = string(nodeWord(idx, 1));
+		const uint32_t ownerRef = nodeWord(idx, 2);
+		if (ownerRef > idx) {
+			throw LoggableException{"Invalid owner in binary graph"};
+		}
+		Rooted<Node> owner = ownerRef == 0 ? nullptr : nodes[ownerRef - 1];
+		const bool documentOwner =
+		    owner != nullptr && owner->isa(&RttiTypes::Document);
+
+		Rooted<Node> node;
+		if (tag == RttiTypes::Document.name) {
+			if (owner != nullptr) {
+				throw LoggableException{"Invalid owner in binary graph"};
+			}
+			node = Rooted<Document>{new Document(mgr, name)};
+		} else if (tag == RttiTypes::StructuredEntity.name) {
+			Rooted<StructuredClass> descriptor = resolve<StructuredClass>(
+			    edge(c), RttiTypes::StructuredClass);
+			Rooted<StructuredEntity> entity;
+			if (documentOwner) {
+				readInt(c);
+				entity = Rooted<StructuredEntity>{
+				    new StructuredEntity(mgr, owner.cast<Document>(),
+				                         descriptor, Variant::mapType{}, name)};
+			} else {
+				const size_t field = fieldIndex(owner, c);
+				entity = Rooted<StructuredEntity>{
+				    new StructuredEntity(mgr, owner, descriptor, field,
+				                         Variant::mapType{}, name)};
+			}
+			entity->setTransparent(readInt(c));
+			node = entity;
+		} else if (tag == RttiTypes::AnnotationEntity.name) {
+			if (!documentOwner) {
+				throw LoggableException{"Invalid owner in binary graph"};
+			}
+			Rooted<AnnotationClass> descriptor = resolve<AnnotationClass>(
+			    edge(c), RttiTypes::AnnotationClass);
+			node = Rooted<AnnotationEntity>{new AnnotationEntity(
+			    mgr, owner.cast<Document>(), descriptor, nullptr, nullptr,
+			    Variant::mapType{}, name)};
+		} else if (tag == RttiTypes::DocumentPrimitive.name) {
+			const size_t field = fieldIndex(owner, c);
+			node = Rooted<DocumentPrimitive>{
+			    new DocumentPrimitive(mgr, owner, Variant{}, field)};
+		} else if (tag == RttiTypes::Anchor.name) {
+			const size_t field = fieldIndex(owner, c);
+			node = Rooted<Anchor>{new Anchor(mgr, owner, field)};
+			if (!name.empty()) {
+				node->setName(name);
+			}
+		}
+		setNode(idx, node, c);
+	}
+
+	/**
+	 * Links the document node with the given index to the referenced nodes
+	 * and reads the attributes and contents, which may reference other
+	 * document nodes.
+	 */
+	void linkDocumentNode(uint32_t idx)
+	{
+		Rooted<Node> node = nodes[idx];
+		Cursor &c = cursors[idx];
+		if (node->isa(&RttiTypes::Document)) {
+			Rooted<Document> document = node.cast<Document>();
+			for (uint32_t n = edge(c); n > 0; n--) {
+				document->referenceOntology(
+				    resolve<Ontology>(edge(c), RttiTypes::Ontology));
+			}
+			for (uint32_t n = edge(c); n > 0; n--) {
+				document->referenceTypesystem(
+				    resolve<Typesystem>(edge(c), RttiTypes::Typesystem));
+			}
+		} else if (node->isa(&RttiTypes::StructuredEntity)) {
+			node.cast<StructuredEntity>()->setAttributes(
+			    readVariant(c, node.get()));
+		} else if (node->isa(&RttiTypes::AnnotationEntity)) {
+			Rooted<AnnotationEntity> entity = node.cast<AnnotationEntity>();
+			entity->setStart(resolve<Anchor>(edge(c), RttiTypes::Anchor));
+			entity->setEnd(resolve<Anchor>(edge(c), RttiTypes::Anchor));
+			entity->setAttributes(readVariant(c, node.get()));
+		} else if (node->isa(&RttiTypes::DocumentPrimitive)) {
+			node.cast<DocumentPrimitive>()->setContent(
+			    readVariant(c, node.get()));
+		}
+	}
+
+	/**
+	 * Reads the edges of the node with the given index and links it to the
+	 * referenced nodes. Superclasses, parent structures and types are only
+	 * recorded and linked once all nodes are known.
+	 */
+	void link(uint32_t idx)
+	{
+		Rooted<Node> node = nodes[idx];
+		if (node == nullptr || node->isa(&RttiTypes::ArrayType) ||
+		    node->isa(&RttiTypes::ReferenceType)) {
+			return;
+		}
+		Cursor &c = cursors[idx];
+		const Rtti *type = node->type();
+		if (type == &RttiTypes::Ontology) {
+			Rooted<Ontology> ontology = node.cast<Ontology>();
+			for (uint32_t n = edge(c); n > 0; n--) {
+				ontology->referenceTypesystem(
+				    resolve<Typesystem>(edge(c), RttiTypes::Typesystem));
+			}
+			for (uint32_t n = edge(c); n > 0; n--) {
+				ontology->referenceOntology(
+				    resolve<Ontology>(edge(c), RttiTypes::Ontology));
+			}
+		} else if (type == &RttiTypes::Typesystem) {
+			Rooted<Typesystem> typesystem = node.cast<Typesystem>();
+			for (uint32_t n = edge(c); n > 0; n--) {
+				typesystem->referenceTypesystem(
+				    resolve<Typesystem>(edge(c), RttiTypes::Typesystem));
+			}
+			for (uint32_t n = edge(c); n > 0; n--) {
+				typesystem->addType(resolve<Type>(edge(c), RttiTypes::Type));
+			}
+			for (uint32_t n = edge(c); n > 0; n--) {
+				typesystem->addConstant(
+				    resolve<Constant>(edge(c), RttiTypes::Constant));
+			}
+		} else if (type == &RttiTypes::StructuredClass) {
+			references[idx] = edge(c);
+			linkFields(node.cast<Descriptor>(), c);
+		} else if (type == &RttiTypes::AnnotationClass) {
+			linkFields(node.cast<Descriptor>(), c);
+		} else if (type == &RttiTypes::FieldDescriptor) {
+			Rooted<FieldDescriptor> fd = node.cast<FieldDescriptor>();
+			fd->setPrimitiveType(resolve<Type>(edge(c), RttiTypes::Type));
+			for (uint32_t n = edge(c); n > 0; n--) {
+				fd->addChild(resolve<StructuredClass>(
+				    edge(c), RttiTypes::StructuredClass));
+			}
+		} else if (type == &RttiTypes::StructType) {
+			Rooted<StructType> s = node.cast<StructType>();
+			references[idx] = edge(c);
+			for (uint32_t n = edge(c); n > 0; n--) {
+				s->addAttribute(
+				    resolve<Attribute>(edge(c), RttiTypes::Attribute), logger);
+			}
+		}
+	}
+
+	void linkFields(Handle<Descriptor> descriptor, Cursor &c)
+	{
+		for (uint32_t n = edge(c); n > 0; n--) {
+			descriptor->addFieldDescriptor(
+			    resolve<FieldDescriptor>(edge(c), RttiTypes::FieldDescriptor),
+			    logger);
+		}
+	}
+
+	/**
+	 * Returns the number of superclasses or parent structures of the node
+	 * with the given index which are part of the graph.
+	 */
+	size_t depth(uint32_t idx, size_t level = 0)
+	{
+		const uint32_t ref = references[idx];
+		if (level > nodeCount) {
+			throw LoggableException{"Cyclic inheritance in binary graph"};
+		}
+		if (ref == 0 || ref > nodeCount) {
+			return 0;
+		}
+		return 1 + depth(ref - 1, level + 1);
+	}
+
+	/**
+	 * Links superclasses and parent structures, parents first. Subclasses of
+	 * the same superclass are added in the order given by their rank.
+	 */
+	void linkInheritance()
+	{
+		std::vector<std::pair<size_t, uint32_t>> structs;
+		std::vector<std::tuple<size_t, uint64_t, uint32_t>> classes;
+		for (uint32_t i = 0; i < nodeCount; i++) {
+			if (nodes[i] == nullptr || references[i] == 0) {
+				continue;
+			}
+			if (nodes[i]->isa(&RttiTypes::StructuredClass)) {
+				classes.emplace_back(depth(i), ranks[i], i);
+			} else if (nodes[i]->isa(&RttiTypes::StructType)) {
+				structs.emplace_back(depth(i), i);
+			}
+		}
+		std::sort(structs.begin(), structs.end());
+		std::sort(classes.begin(), classes.end());
+		for (const auto &s : structs) {
+			nodes[s.second].cast<StructType>()->setParentStructure(
+			    resolve<StructType>(references[s.second],
+			                        RttiTypes::StructType),
+			    logger);
+		}
+		for (const auto &c : classes) {
+			const uint32_t i = std::get<2>(c);
+			Rooted<StructuredClass> superclass = resolve<StructuredClass>(
+			    references[i], RttiTypes::StructuredClass);
+			superclass->addSubclass(nodes[i].cast<StructuredClass>(), logger);
+		}
+	}
+
+	/**
+	 * Sets the types of attributes and constants, which also builds their
+	 * values.
+	 */
+	void linkTypes()
+	{
+		for (uint32_t i = 0; i < nodeCount; i++) {
+			if (nodes[i] == nullptr) {
+				continue;
+			}
+			if (nodes[i]->isa(&RttiTypes::Attribute)) {
+				nodes[i].cast<Attribute>()->setType(
+				    resolve<Type>(references[i], RttiTypes::Type), logger);
+			} else if (nodes[i]->isa(&RttiTypes::Constant)) {
+				nodes[i].cast<Constant>()->setType(
+				    resolve<Type>(references[i], RttiTypes::Type), logger);
+			}
+		}
+	}
+
+	/**
+	 * Logger the errors of the model functions are written to. These errors
+	 * already were reported when the graph was parsed.
+	 */
+	Logger logger;
+
+	/**
+	 * Deferred references of each node: the superclass, parent structure or
+	 * type.
+	 */
+	std::vector<uint32_t> references;
+
+	/**
+	 * Rank of each StructuredClass among the subclasses of its superclass.
+	 */
+	std::vector<uint64_t> ranks;
+
+public:
+	GraphReader(Manager &mgr, const char *data, size_t size,
+	            const std::vector<Rooted<Node>> &dependencies,
+	            SourceId sourceId)
+	    : mgr(mgr),
+	      data(reinterpret_cast<const uint8_t *>(data)),
+	      size(size),
+	      dependencies(dependencies),
+	      sourceId(sourceId)
+	{
+		// Check the header
+		const size_t headerSize = BinaryGraph::HEADER_WORDS * 4;
+		if (size < headerSize ||
+		    memcmp(data, BinaryGraph::MAGIC, sizeof(BinaryGraph::MAGIC)) != 0) {
+			throw LoggableException{"Data is not a binary graph"};
+		}
+		if (word(8) != BinaryGraph::VERSION) {
+			throw LoggableException{"Unsupported binary graph version"};
+		}
+		nodeCount = word(12);
+		externalCount = word(16);
+		stringCount = word(20);
+		edgeCount = word(24);
+		const uint64_t stringDataSize = word(28);
+		const uint64_t propertySize = word(32);
+
+		// Compute the table positions and check them against the data size
+		stringOffsetsPos = headerSize;
+		nodesPos = stringOffsetsPos + (uint64_t(stringCount) + 1) * 4;
+		externalsPos =
+		    nodesPos + uint64_t(nodeCount) * BinaryGraph::NODE_WORDS * 4;
+		edgesPos = externalsPos +
+		           uint64_t(externalCount) * BinaryGraph::EXTERNAL_WORDS * 4;
+		stringDataPos = edgesPos + uint64_t(edgeCount) * 4;
+		propertiesPos = stringDataPos + (stringDataSize + 3) / 4 * 4;
+		propertiesEnd = propertiesPos + propertySize;
+		if (propertiesEnd != size || nodeCount == 0) {
+			throw LoggableException{"Binary graph is truncated"};
+		}
+
+		nodes.resize(nodeCount);
+		cursors.resize(nodeCount);
+		references.resize(nodeCount);
+		ranks.resize(nodeCount);
+		externalNodes.resize(externalCount);
+	}
+
+	Rooted<Node> read()
+	{
+		// Build the ontologies and typesystems first, the entities of a
+		// document need complete descriptors when they are created
+		for (uint32_t i = 0; i < nodeCount; i++) {
+			create(i);
+		}
+		for (uint32_t i = 0; i < nodeCount; i++) {
+			link(i);
+		}
+		linkInheritance();
+		linkTypes();
+
+		// Create the document nodes, owners first
+		std::vector<uint32_t> documentNodes;
+		for (uint32_t i = 0; i < nodeCount; i++) {
+			if (isDocumentNode(string(nodeWord(i, 0)))) {
+				createDocumentNode(i);
+				documentNodes.push_back(i);
+			}
+		}
+		for (uint32_t i : documentNodes) {
+			linkDocumentNode(i);
+		}
+		if (nodes[0] == nullptr || !nodes[0]->isRoot()) {
+			throw LoggableException{"Invalid root node in binary graph"};
+		}
+		return nodes[0];
+	}
+};
+}
+
+Rooted<Node> BinaryGraphReader::read(
+    Manager &mgr, const char *data, size_t size,
+    const std::vector<Rooted<Node>> &dependencies, SourceId sourceId)
+{
+	return GraphReader{mgr, data, size, dependencies, sourceId}.read();
+}
+}
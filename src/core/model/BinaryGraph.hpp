@@ -0,0 +1,313 @@
+/*
+    Ousía
+    Copyright (C) 2014, 2015  Benjamin Paaßen, Andreas Stöckel
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file BinaryGraph.hpp
+ *
+ * Contains the BinaryGraphWriter and BinaryGraphReader classes which convert
+ * a graph of Document, Ontology and Typesystem nodes to a compact binary
+ * representation and back.
+ *
+ * @author Andreas Stöckel (astoecke@techfak.uni-bielefeld.de)
+ */
+
+#ifndef _OUSIA_MODEL_BINARY_GRAPH_HPP_
+#define _OUSIA_MODEL_BINARY_GRAPH_HPP_
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <core/common/Location.hpp>
+
+#include "Node.hpp"
+
+namespace ousia {
+
+// Forward declarations
+class Logger;
+class Variant;
+class StructureNode;
+struct TokenDescriptor;
+
+/**
+ * The BinaryGraph class contains the constants describing the binary graph
+ * format shared by the BinaryGraphWriter and the BinaryGraphReader.
+ *
+ * A binary graph consists of a header followed by four tables. All integers
+ * in the header and the tables are stored as little endian 32 bit values and
+ * all tables are aligned to four bytes, so the tables can be accessed in place
+ * if the data is mapped into memory:
+ *
+ * <ul>
+ *   <li>The string table contains the offset of each string in the string
+ *   data, followed by the string data itself. All names, tokens and Rtti type
+ *   names are stored as index into the string table.</li>
+ *   <li>The node table contains a fixed size record for each node: the Rtti
+ *   type name, the node name, the owner node, the source location, the slice
+ *   of the edge table containing the references to other nodes and the offset
+ *   of the node properties in the property data.</li>
+ *   <li>The external table contains the nodes that are referenced but
+ *   belong to one of the dependencies of the graph. Each external node is
+ *   identified by the index of the dependency and the path of composita
+ *   indices leading from the dependency root to the node.</li>
+ *   <li>The edge table contains all references between nodes, external
+ *   paths and list lengths. A reference is zero for nullptr, 1 + i for the
+ *   i-th node in the node table and 1 + n + j for the j-th external node,
+ *   where n is the number of nodes.</li>
+ * </ul>
+ *
+ * The node properties (flags, tokens, Variant values) are stored as variable
+ * length integers in the property data following the tables.
+ *
+ * The first node in the node table is the root node of the graph. Other root
+ * nodes (such as a typesystem defined inside an ontology or the ontologies
+ * used by a document) and anonymous types (ArrayType, ReferenceType) may
+ * follow the nodes owned by the root node.
+ */
+class BinaryGraph {
+public:
+	/**
+	 * Magic number at the beginning of the binary graph data.
+	 */
+	static const char MAGIC[8];
+
+	/**
+	 * Version of the binary graph format. Must be incremented whenever the
+	 * format changes.
+	 */
+	static const uint32_t VERSION;
+
+	/**
+	 * Number of 32 bit words in the header: the magic number, the version, the
+	 * number of nodes, external nodes, strings and edges and the size of the
+	 * string data and the property data in bytes.
+	 */
+	static const size_t HEADER_WORDS = 9;
+
+	/**
+	 * Number of 32 bit words in a node record.
+	 */
+	static const size_t NODE_WORDS = 8;
+
+	/**
+	 * Number of 32 bit words in an external node record.
+	 */
+	static const size_t EXTERNAL_WORDS = 4;
+
+	/**
+	 * Returns the composita of the given node, in the order in which they are
+	 * stored in the node. These are the nodes owned by the given node, the
+	 * paths to external nodes are expressed as indices into these lists.
+	 *
+	 * @param node is the node for which the composita should be returned.
+	 * @return a list containing the composita of the given node.
+	 */
+	static std::vector<Rooted<Node>> composita(Handle<Node> node);
+};
+
+/**
+ * The BinaryGraphWriter class serializes a graph of Document, Ontology and
+ * Typesystem nodes. Nodes belonging to the given dependencies are written as
+ * external references, the dependencies must be passed to the
+ * BinaryGraphReader in the same order. Other ontologies and typesystems
+ * referenced by the graph are written along with it.
+ */
+class BinaryGraphWriter {
+private:
+	/**
+	 * Roots of the dependencies of the graph.
+	 */
+	std::vector<const Node *> dependencies;
+
+	/**
+	 * SourceId of the locations that are stored with the nodes. Locations
+	 * referring to another source are not stored.
+	 */
+	SourceId sourceId;
+
+	/**
+	 * Nodes that are written, in the order of the node table.
+	 */
+	std::vector<Rooted<Node>> nodes;
+
+	/**
+	 * Owner of each node in the node table.
+	 */
+	std::vector<const Node *> owners;
+
+	/**
+	 * Map from the nodes to their index in the node table.
+	 */
+	std::unordered_map<const Node *, uint32_t> nodeIndices;
+
+	/**
+	 * External records, four words per node.
+	 */
+	std::vector<uint32_t> externals;
+
+	/**
+	 * Map from the external nodes to their index in the external table.
+	 */
+	std::unordered_map<const Node *, uint32_t> externalIndices;
+
+	/**
+	 * Index of the field of the parent entity each document node is stored
+	 * in. Filled while the parent entity is written.
+	 */
+	std::unordered_map<const Node *, uint32_t> fieldIndices;
+
+	/**
+	 * Strings in the string table.
+	 */
+	std::vector<std::string> strings;
+
+	/**
+	 * Map from the strings to their index in the string table.
+	 */
+	std::unordered_map<std::string, uint32_t> stringIndices;
+
+	/**
+	 * Edge table.
+	 */
+	std::vector<uint32_t> edges;
+
+	/**
+	 * Composita paths of the external nodes, appended to the edge table once
+	 * all nodes have been written.
+	 */
+	std::vector<uint32_t> paths;
+
+	/**
+	 * Property data.
+	 */
+	std::string properties;
+
+	/**
+	 * Adds the given node and all its composita to the node table.
+	 *
+	 * @param node is the node that should be added.
+	 * @param owner is the node owning the node.
+	 */
+	void collect(Handle<Node> node, const Node *owner);
+
+	/**
+	 * Returns the index of the given string in the string table.
+	 */
+	uint32_t string(const std::string &s);
+
+	/**
+	 * Returns the reference at the given node, creates an external record if
+	 * needed. Throws an exception if the node cannot be referenced.
+	 */
+	uint32_t ref(Handle<Node> node);
+
+	/**
+	 * Appends a reference to the edge table.
+	 */
+	void writeRef(Handle<Node> node);
+
+	/**
+	 * Appends a list of references to the edge table.
+	 */
+	template <class T>
+	void writeRefs(const T &list);
+
+	/**
+	 * Appends a variable length integer to the property data.
+	 */
+	void writeInt(uint64_t v);
+
+	/**
+	 * Appends a variant to the property data.
+	 */
+	void writeVariant(const Variant &v);
+
+	/**
+	 * Appends a token descriptor to the property data.
+	 */
+	void writeToken(const TokenDescriptor &token);
+
+	/**
+	 * Writes the edges and the properties of the given node.
+	 */
+	void writeNode(Handle<Node> node);
+
+	/**
+	 * Records the field index of the children of the given entity, which is
+	 * written along with each child.
+	 */
+	void recordFields(const std::vector<NodeVector<StructureNode>> &fields);
+
+public:
+	/**
+	 * Constructor of the BinaryGraphWriter class.
+	 *
+	 * @param dependencies are the root nodes of the graphs the written graph
+	 * may reference.
+	 * @param sourceId is the id of the source whose locations should be
+	 * written.
+	 */
+	BinaryGraphWriter(const std::vector<Rooted<Node>> &dependencies,
+	                  SourceId sourceId = InvalidSourceId);
+
+	/**
+	 * Serializes the graph starting at the given root node.
+	 *
+	 * @param root is the Document, Ontology or Typesystem that should be
+	 * serialized.
+	 * @param out is the string to which the binary graph is written.
+	 * @return true if the graph was written, false if it contains nodes that
+	 * cannot be serialized (such as nodes with unresolved types or nodes of
+	 * unsupported types) or references nodes which are not part of a
+	 * dependency.
+	 */
+	bool write(Handle<Node> root, std::string &out);
+};
+
+/**
+ * The BinaryGraphReader class reconstructs a graph that was written by the
+ * BinaryGraphWriter. The nodes are created with the constructors and setters
+ * used by the parsers, references to external nodes are resolved in the given
+ * dependencies.
+ */
+class BinaryGraphReader {
+public:
+	/**
+	 * Reconstructs the graph stored in the given data. The data is accessed in
+	 * place and must stay valid while this function runs. Throws a
+	 * LoggableException if the data is malformed or an external node cannot
+	 * be found.
+	 *
+	 * @param mgr is the Manager instance in which the nodes should be created.
+	 * @param data is the data that should be read.
+	 * @param size is the size of the data in bytes.
+	 * @param dependencies are the roots of the dependencies, in the order in
+	 * which they were passed to the BinaryGraphWriter.
+	 * @param sourceId is the SourceId used for the locations of the nodes.
+	 * @return the root node of the graph.
+	 */
+	static Rooted<Node> read(Manager &mgr, const char *data, size_t size,
+	                         const std::vector<Rooted<Node>> &dependencies,
+	                         SourceId sourceId = InvalidSourceId);
+};
+}
+
+#endif /* _OUSIA_MODEL_BINARY_GRAPH_HPP_ */
+
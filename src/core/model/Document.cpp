@@ -418,7 +418,7 @@ Rooted<StructuredEntity> DocumentEntity::createChildStructuredEntity(
     Handle<StructuredClass> descriptor, Variant attributes,
     const std::string &fieldName, std::string name)
 {
-	return Rooted<StructuredEntity>{new StructuredEntity(
+	return Rooted<StructuredEntity>{new (subInst->getManager()) StructuredEntity(
 	    subInst->getManager(), subInst, descriptor, std::move(attributes),
 	    fieldName, std::move(name))};
 }
@@ -428,32 +428,40 @@ Rooted<StructuredEntity> DocumentEntity::createChildStructuredEntity(
     std::string name)
 {
 	return Rooted<StructuredEntity>{
-	    new StructuredEntity(subInst->getManager(), subInst, descriptor,
+	    new (subInst->getManager())
+	        StructuredEntity(subInst->getManager(), subInst, descriptor,
 	                         fieldIdx, std::move(attributes), std::move(name))};
 }
 
 Rooted<DocumentPrimitive> DocumentEntity::createChildDocumentPrimitive(
     Variant content, const std::string &fieldName)
 {
-	return Rooted<DocumentPrimitive>{new DocumentPrimitive(
-	    subInst->getManager(), subInst, std::move(content), fieldName)};
+	return Rooted<DocumentPrimitive>{new (subInst->getManager())
+	                                     DocumentPrimitive(subInst->getManager(),
+	                                                       subInst,
+	                                                       std::move(content),
+	                                                       fieldName)};
 }
 
 Rooted<DocumentPrimitive> DocumentEntity::createChildDocumentPrimitive(
     Variant content, size_t fieldIdx)
 {
-	return Rooted<DocumentPrimitive>{new DocumentPrimitive(
-	    subInst->getManager(), subInst, std::move(content), fieldIdx)};
+	return Rooted<DocumentPrimitive>{new (subInst->getManager())
+	                                     DocumentPrimitive(subInst->getManager(),
+	                                                       subInst,
+	                                                       std::move(content),
+	                                                       fieldIdx)};
 }
 
 Rooted<Anchor> DocumentEntity::createChildAnchor(const std::string &fieldName)
 {
-	return Rooted<Anchor>{
-	    new Anchor(subInst->getManager(), subInst, fieldName)};
+	return Rooted<Anchor>{new (subInst->getManager())
+	                          Anchor(subInst->getManager(), subInst, fieldName)};
 }
 Rooted<Anchor> DocumentEntity::createChildAnchor(size_t fieldIdx)
 {
-	return Rooted<Anchor>{new Anchor(subInst->getManager(), subInst, fieldIdx)};
+	return Rooted<Anchor>{new (subInst->getManager())
+	                          Anchor(subInst->getManager(), subInst, fieldIdx)};
 }
 
 static bool matchStartAnchor(Handle<AnnotationClass> desc,
@@ -923,8 +931,9 @@ Rooted<StructuredEntity> Document::createRootStructuredEntity(
     Handle<StructuredClass> descriptor, Variant attributes, std::string name)
 {
 	return Rooted<StructuredEntity>{
-	    new StructuredEntity(getManager(), Handle<Document>{this}, descriptor,
-	                         attributes, std::move(name))};
+	    new (getManager()) StructuredEntity(getManager(), Handle<Document>{this},
+	                                        descriptor, attributes,
+	                                        std::move(name))};
 }
 
 void Document::addAnnotation(Handle<AnnotationEntity> a)
@@ -968,8 +977,9 @@ Rooted<AnnotationEntity> Document::createChildAnnotation(
     Handle<Anchor> end, Variant attributes, std::string name)
 {
 	return Rooted<AnnotationEntity>{
-	    new AnnotationEntity(getManager(), this, descriptor, start, end,
-	                         attributes, std::move(name))};
+	    new (getManager()) AnnotationEntity(getManager(), this, descriptor,
+	                                        start, end, attributes,
+	                                        std::move(name))};
 }
 
 bool Document::hasChild(Handle<StructureNode> s) const
@@ -1057,6 +1057,7 @@ public:
 	{
 		invalidate();
 		ontologies.push_back(d);
+		getManager().namesChanged();
 	}
 
 	/**
@@ -1066,6 +1067,7 @@ public:
 	{
 		invalidate();
 		ontologies.insert(ontologies.end(), d.begin(), d.end());
+		getManager().namesChanged();
 	}
 
 	/**
@@ -1082,6 +1084,7 @@ public:
 	{
 		invalidate();
 		typesystems.push_back(d);
+		getManager().namesChanged();
 	}
 
 	/**
@@ -1091,6 +1094,7 @@ public:
 	{
 		invalidate();
 		typesystems.insert(typesystems.end(), d.begin(), d.end());
+		getManager().namesChanged();
 	}
 
 	/**
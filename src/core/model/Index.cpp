@@ -66,10 +66,13 @@ void Index::deleteElement(Handle<Node> node, Managed *owner,
 		deleteFromIndex(node->getName(), node);
 		node->unregisterEvent(EventType::NAME_CHANGE,
 		                      Index::indexHandleNameChange, owner, this);
-	} else if (owner) {
-		owner->getManager().unregisterEvent(node.get(), EventType::NAME_CHANGE,
-		                                    Index::indexHandleNameChange, owner,
-		                                    this);
+	} else {
+		// Containers without owner keep the node alive, so the handler must be
+		// released here as well -- otherwise temporary NodeVectors (such as
+		// the ones returned by pathTo) leave stale handlers behind
+		Manager &mgr = owner ? owner->getManager() : node->getManager();
+		mgr.unregisterEvent(node.get(), EventType::NAME_CHANGE,
+		                    Index::indexHandleNameChange, owner, this);
 	}
 }
 
@@ -16,6 +16,7 @@
     along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <algorithm>
 #include <functional>
 #include <unordered_set>
 
@@ -25,6 +26,7 @@
 #include <core/common/Utils.hpp>
 
 #include "Node.hpp"
+#include "RootNode.hpp"
 
 namespace ousia {
 
@@ -374,11 +376,66 @@ bool Node::continueResolveReference(Handle<Node> h, ResolutionState &state)
 	// currently asked for in the resolution process
 	if (canFollowReferences(state) && state.canContainType(h->type())) {
 		ResolutionState forkedState = state.fork(this);
+		if (h->isa(&RttiTypes::RootNode)) {
+			return continueResolveRootNode(h.cast<RootNode>().get(),
+			                               forkedState);
+		}
 		return continueResolveCompositum(h, forkedState);
 	}
 	return false;
 }
 
+bool Node::continueResolveRootNode(RootNode *root, ResolutionState &state)
+{
+	// Use the generic resolution process if the root node might still change
+	const std::vector<Node *> *nodes;
+	if (!root->lookupSymbols(state.shared.type, state.shared.path, nodes)) {
+		return continueResolveCompositum(root, state);
+	}
+
+	// Explicitly matching the name of the root node only requires index
+	// lookups, this is done as in continueResolveCompositum()
+	if (root->getName() == state.currentName()) {
+		ResolutionState advancedState = state.advance();
+		if (root->resolve(advancedState)) {
+			return true;
+		}
+	}
+
+	// Descending into the root node requires a search of all composita. The
+	// nodes below the root node can only be reached via the root node, so the
+	// result is the same as the one of an independent resolution process
+	// starting at the root node, which is stored in the symbol table. Only
+	// inherited attributes may have been found before and are skipped.
+	if (!state.markVisited(root)) {
+		return false;
+	}
+	if (nodes == nullptr) {
+		SharedResolutionState sharedState(state.shared.type, state.shared.path);
+		ResolutionState rootState(sharedState, nullptr, 0, false);
+		root->resolve(rootState);
+
+		std::vector<Node *> found;
+		found.reserve(sharedState.result.size());
+		for (const ResolutionResult &res : sharedState.result) {
+			found.push_back(res.node.get());
+		}
+		nodes = &root->storeSymbols(state.shared.type, state.shared.path,
+		                            std::move(found));
+	}
+	const size_t resCount = state.resultCount();
+	for (Node *node : *nodes) {
+		auto begin = state.shared.result.begin();
+		auto end = state.shared.result.begin() + resCount;
+		if (std::find_if(begin, end, [node](const ResolutionResult &res) {
+			    return res.node == node;
+			}) == end) {
+			state.addToResult(node);
+		}
+	}
+	return state.resultCount() > resCount;
+}
+
 std::vector<ResolutionResult> Node::resolve(
     const Rtti *type, const std::vector<std::string> &path)
 {
@@ -505,6 +562,7 @@ void Node::invalidate()
 	// Only perform the invalidation if necessary
 	if (validationState != ValidationState::UNKNOWN) {
 		validationState = ValidationState::UNKNOWN;
+		getManager().invalidated();
 		if (parent != nullptr) {
 			parent->invalidate();
 		}
@@ -562,6 +620,9 @@ void Node::setParent(Handle<Node> p)
 {
 	parent = acquire(p);
 	invalidate();
+	if (hasName()) {
+		getManager().namesChanged();
+	}
 }
 
 /* RTTI type registrations */
@@ -116,6 +116,7 @@ struct ResolutionResult {
 
 // Forward declaration
 class ResolutionState;
+class RootNode;
 
 /**
  * The Node class builds the base class for any Node within the DOM graph. A
@@ -203,6 +204,19 @@ private:
 	 */
 	bool continueResolveIndex(const Index &index, ResolutionState &state);
 
+	/**
+	 * Method used internally to search for the requested node in a root node
+	 * which was reached by following a reference. Uses the symbol table of
+	 * the root node if it has already been validated, otherwise the composita
+	 * of the root node are searched.
+	 *
+	 * @param root is the root node the reference points at.
+	 * @param state is used internally to manage the resolution process.
+	 * @return true if at least one new node has been found that matches the
+	 * criteria given for the resolution.
+	 */
+	bool continueResolveRootNode(RootNode *root, ResolutionState &state);
+
 	/**
 	 * Checks whether the name of the given node is already stored in the given
 	 * set, if yes, logs a corresponding error message.
@@ -482,6 +496,10 @@ public:
 	      parent(acquire(parent)),
 	      validationState(ValidationState::UNKNOWN)
 	{
+		// A new named node may become the result of name resolution
+		if (!this->name.empty()) {
+			mgr.namesChanged();
+		}
 	}
 
 	/**
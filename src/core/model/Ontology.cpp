@@ -16,6 +16,7 @@
     along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <algorithm>
 #include <memory>
 #include <queue>
 #include <set>
@@ -48,7 +49,7 @@ struct PathState {
 };
 
 static void constructPath(std::shared_ptr<PathState> state,
-                          NodeVector<Node> &vec)
+                          std::vector<Node *> &vec)
 {
 	if (state->pred != nullptr) {
 		constructPath(state->pred, vec);
@@ -56,12 +57,20 @@ static void constructPath(std::shared_ptr<PathState> state,
 	vec.push_back(state->node);
 }
 
-static NodeVector<Node> pathTo(const Node *start, Logger &logger,
-                               Handle<Node> target, bool &success)
+/**
+ * Performs a breadth-first search for the shortest path between start and
+ * target. Sets "cacheable" to false if one of the nodes the result depends on
+ * has not been validated.
+ */
+static void searchPath(const Node *start, Handle<Node> target,
+                       Ontology::TransparentPath &res, bool &cacheable)
 {
-	success = false;
-	// shortest path.
-	NodeVector<Node> shortest;
+	auto examine = [&cacheable](const Node *n) {
+		cacheable = cacheable &&
+		            n->getValidationState() == ValidationState::VALID;
+	};
+	examine(start);
+
 	// state queue for breadth-first search.
 	std::queue<std::shared_ptr<PathState>> states;
 	if (start->isa(&RttiTypes::Descriptor)) {
@@ -70,10 +79,11 @@ static NodeVector<Node> pathTo(const Node *start, Logger &logger,
 		ManagedVector<FieldDescriptor> fields = desc->getFieldDescriptors();
 
 		for (auto fd : fields) {
+			examine(fd.get());
 			if (fd == target) {
 				// if we have found the target directly, return without search.
-				success = true;
-				return shortest;
+				res.success = true;
+				return;
 			}
 			if (fd->getFieldType() == FieldDescriptor::FieldType::TREE) {
 				states.push(std::make_shared<PathState>(nullptr, fd.get()));
@@ -84,10 +94,11 @@ static NodeVector<Node> pathTo(const Node *start, Logger &logger,
 		    static_cast<const FieldDescriptor *>(start);
 		// initially put every child and its subclasses to the queue.
 		for (auto c : field->getChildrenWithSubclasses()) {
+			examine(c.get());
 			// if we have found the target directly, return without search.
 			if (c == target) {
-				success = true;
-				return shortest;
+				res.success = true;
+				return;
 			}
 			if (c->isTransparent()) {
 				states.push(std::make_shared<PathState>(nullptr, c.get()));
@@ -105,7 +116,7 @@ static NodeVector<Node> pathTo(const Node *start, Logger &logger,
 		}
 		// also do not proceed if we can't get better than the current shortest
 		// path anymore.
-		if (!shortest.empty() && current->length > shortest.size()) {
+		if (!res.path.empty() && current->length > res.path.size()) {
 			continue;
 		}
 
@@ -117,6 +128,7 @@ static NodeVector<Node> pathTo(const Node *start, Logger &logger,
 			// look through all fields.
 			ManagedVector<FieldDescriptor> fields = strct->getFieldDescriptors();
 			for (auto fd : fields) {
+				examine(fd.get());
 				// if we found our target, break off the search in this branch.
 				if (fd == target) {
 					fin = true;
@@ -133,6 +145,7 @@ static NodeVector<Node> pathTo(const Node *start, Logger &logger,
 			    static_cast<const FieldDescriptor *>(current->node);
 			// and we proceed by visiting all permitted children.
 			for (auto c : field->getChildrenWithSubclasses()) {
+				examine(c.get());
 				// if we found our target, break off the search in this branch.
 				if (c == target) {
 					fin = true;
@@ -146,28 +159,71 @@ static NodeVector<Node> pathTo(const Node *start, Logger &logger,
 		}
 		// check if we are finished.
 		if (fin) {
-			success = true;
+			res.success = true;
 			// if so we look if we found a shorter path than the current minimum
-			if (shortest.empty() || current->length < shortest.size()) {
-				NodeVector<Node> newPath;
-				constructPath(current, newPath);
-				shortest = newPath;
-			} else if (current->length == shortest.size()) {
-				// if the length is the same the result is ambigous and we log
-				// an error.
-				NodeVector<Node> newPath;
+			if (res.path.empty() || current->length < res.path.size()) {
+				res.path.clear();
+				constructPath(current, res.path);
+			} else if (current->length == res.path.size()) {
+				// if the length is the same the result is ambigous.
+				std::vector<Node *> newPath;
 				constructPath(current, newPath);
-				logger.error(
-				    std::string("Can not unambigously create a path from \"") +
-				    start->getName() + "\" to \"" + target->getName() + "\".");
-				logger.note("Dismissed the path:", SourceLocation{},
-				            MessageMode::NO_CONTEXT);
-				for (auto n : newPath) {
-					logger.note(n->getName());
-				}
+				res.dismissed.emplace_back(std::move(newPath));
 			}
 		}
 	}
+}
+
+/**
+ * Returns the ontology the given Descriptor or FieldDescriptor belongs to or
+ * nullptr if there is none.
+ */
+static const Ontology *ontologyOf(const Node *n)
+{
+	while (n != nullptr && !n->isa(&RttiTypes::Ontology)) {
+		Rooted<Managed> parent = n->getParent();
+		n = (parent == nullptr || !parent->isa(&RttiTypes::Node))
+		        ? nullptr
+		        : static_cast<const Node *>(parent.get());
+	}
+	return static_cast<const Ontology *>(n);
+}
+
+static NodeVector<Node> pathTo(const Node *start, Logger &logger,
+                               Handle<Node> target, bool &success)
+{
+	// Try to fetch the path from the transparent path table of the ontology,
+	// otherwise search the path and store it if possible
+	const Ontology *ontology = ontologyOf(start);
+	const Ontology::TransparentPath *res = nullptr;
+	Ontology::TransparentPath searched;
+	if (ontology != nullptr) {
+		res = ontology->lookupTransparentPath(start, target.get());
+	}
+	if (res == nullptr) {
+		bool cacheable = ontology != nullptr;
+		searchPath(start, target, searched, cacheable);
+		res = &searched;
+		if (cacheable) {
+			ontology->storeTransparentPath(start, target.get(), searched);
+		}
+	}
+
+	// Report ambiguous paths each time the path is requested
+	for (const std::vector<Node *> &dismissed : res->dismissed) {
+		logger.error(
+		    std::string("Can not unambigously create a path from \"") +
+		    start->getName() + "\" to \"" + target->getName() + "\".");
+		logger.note("Dismissed the path:", SourceLocation{},
+		            MessageMode::NO_CONTEXT);
+		for (Node *n : dismissed) {
+			logger.note(n->getName());
+		}
+	}
+
+	success = res->success;
+	NodeVector<Node> shortest;
+	shortest.insert(shortest.end(), res->path.begin(), res->path.end());
 	return shortest;
 }
 
@@ -656,12 +712,40 @@ static ssize_t getFieldDescriptorIndex(const ManagedVector<FieldDescriptor> &fds
 
 ssize_t Descriptor::getFieldDescriptorIndex(const std::string &name) const
 {
-	ManagedVector<FieldDescriptor> fds = getFieldDescriptors();
-	return ousia::getFieldDescriptorIndex(fds, name);
+	const FieldTable *table = getFieldTable();
+	if (table == nullptr) {
+		ManagedVector<FieldDescriptor> fds = getFieldDescriptors();
+		return ousia::getFieldDescriptorIndex(fds, name);
+	}
+
+	// The TREE field -- if there is one -- is always the last field
+	const std::vector<FieldDescriptor *> &fds = table->fields;
+	if (name == DEFAULT_FIELD_NAME) {
+		if (!fds.empty() &&
+		    fds.back()->getFieldType() == FieldDescriptor::FieldType::TREE) {
+			return fds.size() - 1;
+		}
+		return -1;
+	}
+	auto it = table->indices.find(name);
+	if (it != table->indices.end()) {
+		return it->second;
+	}
+	return -1;
 }
 
 ssize_t Descriptor::getFieldDescriptorIndex(Handle<FieldDescriptor> fd) const
 {
+	const FieldTable *table = getFieldTable();
+	if (table != nullptr) {
+		const std::vector<FieldDescriptor *> &fds = table->fields;
+		auto it = std::find(fds.begin(), fds.end(), fd.get());
+		if (it != fds.end()) {
+			return it - fds.begin();
+		}
+		return -1;
+	}
+
 	size_t f = 0;
 	for (auto &fd2 : getFieldDescriptors()) {
 		if (fd == fd2) {
@@ -675,6 +759,15 @@ ssize_t Descriptor::getFieldDescriptorIndex(Handle<FieldDescriptor> fd) const
 Rooted<FieldDescriptor> Descriptor::getFieldDescriptor(
     const std::string &name) const
 {
+	const FieldTable *table = getFieldTable();
+	if (table != nullptr) {
+		ssize_t idx = getFieldDescriptorIndex(name);
+		if (idx != -1) {
+			return table->fields[idx];
+		}
+		return nullptr;
+	}
+
 	ManagedVector<FieldDescriptor> fds = getFieldDescriptors();
 	ssize_t idx = ousia::getFieldDescriptorIndex(fds, name);
 	if (idx != -1) {
@@ -685,6 +778,14 @@ Rooted<FieldDescriptor> Descriptor::getFieldDescriptor(
 
 Rooted<FieldDescriptor> Descriptor::getFieldDescriptor(size_t idx) const
 {
+	const FieldTable *table = getFieldTable();
+	if (table != nullptr) {
+		if (idx < table->fields.size()) {
+			return table->fields[idx];
+		}
+		return nullptr;
+	}
+
 	ManagedVector<FieldDescriptor> fds = getFieldDescriptors();
 	if (idx < fds.size()) {
 		return fds[idx];
@@ -982,7 +1083,7 @@ Rooted<FieldDescriptor> StructuredClass::gatherFieldDescriptors(
 	return mainField;
 }
 
-ManagedVector<FieldDescriptor> StructuredClass::getFieldDescriptors() const
+ManagedVector<FieldDescriptor> StructuredClass::collectFieldDescriptors() const
 {
 	// in this case we return a NodeVector of Rooted entries without owner.
 	ManagedVector<FieldDescriptor> vec;
@@ -996,6 +1097,42 @@ ManagedVector<FieldDescriptor> StructuredClass::getFieldDescriptors() const
 	return vec;
 }
 
+const Descriptor::FieldTable *StructuredClass::getFieldTable() const
+{
+	const uint64_t generation = getManager().getInvalidationGeneration();
+	if (fieldTableValid && fieldTableGeneration == generation) {
+		return &fieldTable;
+	}
+
+	// A valid class implies valid fields and superclasses, any change to them
+	// increments the invalidation generation
+	fieldTableValid = false;
+	if (getValidationState() != ValidationState::VALID) {
+		return nullptr;
+	}
+	ManagedVector<FieldDescriptor> fds = collectFieldDescriptors();
+	fieldTable.fields.clear();
+	fieldTable.indices.clear();
+	for (size_t f = 0; f < fds.size(); f++) {
+		fieldTable.fields.push_back(fds[f].get());
+		fieldTable.indices.emplace(fds[f]->getName(), f);
+	}
+	fieldTableGeneration = generation;
+	fieldTableValid = true;
+	return &fieldTable;
+}
+
+ManagedVector<FieldDescriptor> StructuredClass::getFieldDescriptors() const
+{
+	const FieldTable *table = getFieldTable();
+	if (table == nullptr) {
+		return collectFieldDescriptors();
+	}
+	ManagedVector<FieldDescriptor> vec;
+	vec.insert(vec.end(), table->fields.begin(), table->fields.end());
+	return vec;
+}
+
 /* Class AnnotationClass */
 
 AnnotationClass::AnnotationClass(Manager &mgr, std::string name,
@@ -1162,6 +1299,26 @@ std::vector<TokenDescriptor *> Ontology::getAllTokenDescriptors() const
 	return res;
 }
 
+const Ontology::TransparentPath *Ontology::lookupTransparentPath(
+    const Node *start, const Node *target) const
+{
+	// The paths depend on nodes of other ontologies as well, so discard them
+	// whenever any validated node changes
+	const uint64_t generation = getManager().getInvalidationGeneration();
+	if (transparentPathGeneration != generation) {
+		transparentPaths.clear();
+		transparentPathGeneration = generation;
+	}
+	auto it = transparentPaths.find(std::make_pair(start, target));
+	return it == transparentPaths.end() ? nullptr : &it->second;
+}
+
+void Ontology::storeTransparentPath(const Node *start, const Node *target,
+                                    TransparentPath path) const
+{
+	transparentPaths[std::make_pair(start, target)] = std::move(path);
+}
+
 /* Type registrations */
 
 namespace RttiTypes {
@@ -168,6 +168,10 @@
 #ifndef _OUSIA_MODEL_ONTOLOGY_HPP_
 #define _OUSIA_MODEL_ONTOLOGY_HPP_
 
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
 #include <core/common/Whitespace.hpp>
 #include <core/managed/ManagedContainer.hpp>
 #include <core/RangeSet.hpp>
@@ -628,6 +632,33 @@ protected:
 	 */
 	virtual bool doCheckInheritsFrom(Handle<Descriptor> c) const;
 
+	/**
+	 * Effective list of FieldDescriptors of a Descriptor, as returned by
+	 * getFieldDescriptors(), together with an index from field names to
+	 * positions in that list.
+	 */
+	struct FieldTable {
+		/**
+		 * Effective FieldDescriptors in the order of getFieldDescriptors().
+		 */
+		std::vector<FieldDescriptor *> fields;
+
+		/**
+		 * Map from the field names to their index in the fields list.
+		 */
+		std::unordered_map<std::string, size_t> indices;
+	};
+
+	/**
+	 * Returns the table of effective FieldDescriptors of this Descriptor or
+	 * nullptr if it is currently not available, in which case the field list
+	 * is computed by getFieldDescriptors(). The default implementation always
+	 * returns nullptr.
+	 *
+	 * @return a pointer at the FieldTable or nullptr.
+	 */
+	virtual const FieldTable *getFieldTable() const { return nullptr; }
+
 public:
 	Descriptor(Manager &mgr, std::string name, Handle<Ontology> ontology)
 	    : Node(mgr, std::move(name), ontology),
@@ -1060,10 +1091,42 @@ private:
 	    std::unordered_set<const StructuredClass *> &visited,
 	    std::set<std::string> &overriddenFields, bool hasTREE) const;
 
+	/**
+	 * Merges the FieldDescriptors of this class with the ones of its
+	 * superclasses, see getFieldDescriptors().
+	 */
+	ManagedVector<FieldDescriptor> collectFieldDescriptors() const;
+
+	/**
+	 * Table of effective FieldDescriptors, only used if fieldTableValid is
+	 * set and the invalidation generation of the Manager is still
+	 * fieldTableGeneration.
+	 */
+	mutable FieldTable fieldTable;
+
+	/**
+	 * Invalidation generation of the Manager at the time the fieldTable was
+	 * built.
+	 */
+	mutable uint64_t fieldTableGeneration = 0;
+
+	/**
+	 * Set to true once the fieldTable has been built.
+	 */
+	mutable bool fieldTableValid = false;
+
 protected:
 	bool doValidate(Logger &logger) const override;
 	bool doCheckInheritsFrom(Handle<Descriptor> c) const override;
 
+	/**
+	 * Builds the table of effective FieldDescriptors once this class has been
+	 * validated. Changing this class, one of its fields or one of its
+	 * superclasses afterwards invalidates a validated node and thus discards
+	 * the table.
+	 */
+	const FieldTable *getFieldTable() const override;
+
 public:
 	/**
 	 * The constructor for a StructuredClass.
@@ -1288,12 +1351,61 @@ class Ontology : public RootNode {
 	friend StructuredClass;
 	friend AnnotationClass;
 
+public:
+	/**
+	 * Result of a search for the shortest path of transparent elements between
+	 * a Descriptor or FieldDescriptor of this Ontology and a target node, see
+	 * Descriptor::pathTo() and FieldDescriptor::pathTo().
+	 */
+	struct TransparentPath {
+		/**
+		 * Shortest path found by the search.
+		 */
+		std::vector<Node *> path;
+
+		/**
+		 * Paths with the same length as the shortest path, which were
+		 * dismissed because the result is ambiguous.
+		 */
+		std::vector<std::vector<Node *>> dismissed;
+
+		/**
+		 * Set to true if the target can be reached.
+		 */
+		bool success = false;
+	};
+
 private:
+	/**
+	 * Hash function for the keys of the transparent path table.
+	 */
+	struct TransparentPathHash {
+		size_t operator()(const std::pair<const Node *, const Node *> &p) const
+		{
+			return std::hash<const Node *>{}(p.first) * 37 +
+			       std::hash<const Node *>{}(p.second);
+		}
+	};
+
 	NodeVector<StructuredClass> structuredClasses;
 	NodeVector<AnnotationClass> annotationClasses;
 	NodeVector<Typesystem> typesystems;
 	NodeVector<Ontology> ontologies;
 
+	/**
+	 * Table mapping from start and target node to the shortest path between
+	 * them. Only contains paths which consist of validated nodes.
+	 */
+	mutable std::unordered_map<std::pair<const Node *, const Node *>,
+	                           TransparentPath, TransparentPathHash>
+	    transparentPaths;
+
+	/**
+	 * Invalidation generation of the Manager the transparent path table was
+	 * built in.
+	 */
+	mutable uint64_t transparentPathGeneration = 0;
+
 protected:
 	void doResolve(ResolutionState &state) override;
 	bool doValidate(Logger &logger) const override;
@@ -1456,7 +1568,11 @@ public:
 	/**
 	 * Adds a Typesystem reference to this Ontology.
 	 */
-	void referenceTypesystem(Handle<Typesystem> t) { typesystems.push_back(t); }
+	void referenceTypesystem(Handle<Typesystem> t)
+	{
+		typesystems.push_back(t);
+		getManager().namesChanged();
+	}
 
 	/**
 	 * Adds multiple Typesystem references to this Ontology.
@@ -1464,6 +1580,7 @@ public:
 	void referenceTypesystems(const std::vector<Handle<Typesystem>> &ts)
 	{
 		typesystems.insert(typesystems.end(), ts.begin(), ts.end());
+		getManager().namesChanged();
 	}
 
 	/**
@@ -1476,7 +1593,11 @@ public:
 	/**
 	 * Adds a Ontology reference to this Ontology.
 	 */
-	void referenceOntology(Handle<Ontology> d) { ontologies.push_back(d); }
+	void referenceOntology(Handle<Ontology> d)
+	{
+		ontologies.push_back(d);
+		getManager().namesChanged();
+	}
 
 	/**
 	 * Adds multiple Ontology references to this Ontology.
@@ -1484,6 +1605,7 @@ public:
 	void referenceOntologys(const std::vector<Handle<Ontology>> &ds)
 	{
 		ontologies.insert(ontologies.end(), ds.begin(), ds.end());
+		getManager().namesChanged();
 	}
 
 	/**
@@ -1492,6 +1614,39 @@ public:
 	 * @return all TokenDescriptors of classes and fields in this Ontology.
 	 */
 	std::vector<TokenDescriptor *> getAllTokenDescriptors() const;
+
+	/**
+	 * Looks up the shortest path between the given start node and the target
+	 * in the transparent path table. The table is discarded whenever a
+	 * validated node is changed.
+	 *
+	 * @param start is a Descriptor or FieldDescriptor of this Ontology.
+	 * @param target is the StructuredClass or FieldDescriptor that should be
+	 * reached.
+	 * @return a pointer at the stored path or nullptr if no path is stored.
+	 */
+	const TransparentPath *lookupTransparentPath(const Node *start,
+	                                             const Node *target) const;
+
+	/**
+	 * Stores the shortest path between the given start node and the target in
+	 * the transparent path table. All nodes the path depends on must have been
+	 * validated.
+	 *
+	 * @param start is a Descriptor or FieldDescriptor of this Ontology.
+	 * @param target is the StructuredClass or FieldDescriptor that should be
+	 * reached.
+	 * @param path is the result of the search.
+	 */
+	void storeTransparentPath(const Node *start, const Node *target,
+	                          TransparentPath path) const;
+
+	/**
+	 * Returns the number of entries in the transparent path table.
+	 *
+	 * @return the number of stored paths.
+	 */
+	size_t getTransparentPathCount() const { return transparentPaths.size(); }
 };
 
 namespace RttiTypes {
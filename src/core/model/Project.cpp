@@ -78,6 +78,7 @@ void Project::referenceDocument(Handle<Document> document)
 {
 	invalidate();
 	documents.push_back(document);
+	getManager().namesChanged();
 }
 
 const NodeVector<Document> &Project::getDocuments() const { return documents; }
@@ -34,6 +34,43 @@ void RootNode::reference(Handle<Node> node)
 
 RttiSet RootNode::getReferenceTypes() const { return doGetReferenceTypes(); }
 
+size_t RootNode::SymbolKeyHash::operator()(const SymbolKey &key) const
+{
+	size_t res = std::hash<const Rtti *>{}(key.type);
+	for (const std::string &s : key.path) {
+		res = res * 31 + std::hash<std::string>{}(s);
+	}
+	return res;
+}
+
+bool RootNode::lookupSymbols(const Rtti *type,
+                             const std::vector<std::string> &path,
+                             const std::vector<Node *> *&nodes)
+{
+	// Only validated root nodes are assumed to be immutable, any change to the
+	// subtree resets the validation state
+	const uint64_t generation = getManager().getNameGeneration();
+	if (getValidationState() != ValidationState::VALID ||
+	    symbolGeneration != generation) {
+		symbols.clear();
+		symbolGeneration = generation;
+	}
+	if (getValidationState() != ValidationState::VALID) {
+		return false;
+	}
+
+	auto it = symbols.find(SymbolKey{type, path});
+	nodes = (it == symbols.end()) ? nullptr : &it->second;
+	return true;
+}
+
+const std::vector<Node *> &RootNode::storeSymbols(
+    const Rtti *type, const std::vector<std::string> &path,
+    std::vector<Node *> nodes)
+{
+	return symbols[SymbolKey{type, path}] = std::move(nodes);
+}
+
 namespace RttiTypes {
 const Rtti RootNode = RttiBuilder<ousia::RootNode>("RootNode").parent(&Node);
 }
@@ -28,6 +28,10 @@
 #ifndef _OUSIA_ROOT_NODE_HPP_
 #define _OUSIA_ROOT_NODE_HPP_
 
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 #include <core/managed/Managed.hpp>
 #include <core/common/Rtti.hpp>
 
@@ -41,6 +45,39 @@ namespace ousia {
  * allow importing/referencing other Nodes.
  */
 class RootNode : public Node {
+private:
+	/**
+	 * Key of the symbol table, consisting of the requested type and the path.
+	 */
+	struct SymbolKey {
+		const Rtti *type;
+		std::vector<std::string> path;
+
+		bool operator==(const SymbolKey &o) const
+		{
+			return type == o.type && path == o.path;
+		}
+	};
+
+	/**
+	 * Hash function for the SymbolKey structure.
+	 */
+	struct SymbolKeyHash {
+		size_t operator()(const SymbolKey &key) const;
+	};
+
+	/**
+	 * Symbol table mapping from a type and a path to the nodes within this
+	 * root node matching them, in the order in which the resolution process
+	 * finds them.
+	 */
+	std::unordered_map<SymbolKey, std::vector<Node *>, SymbolKeyHash> symbols;
+
+	/**
+	 * Name generation of the Manager the symbol table was built in.
+	 */
+	uint64_t symbolGeneration = 0;
+
 protected:
 	/**
 	 * Imports the given node. The node was checked to be one of the supported
@@ -74,6 +111,43 @@ public:
 	 * @return a set of types that can be referenced.
 	 */
 	RttiSet getReferenceTypes() const;
+
+	/**
+	 * Looks up the nodes matching the given type and path in the symbol table
+	 * of this root node. The symbol table is only used once the root node has
+	 * been validated. It is discarded as soon as the root node is invalidated
+	 * or the Manager reports a change of names or references.
+	 *
+	 * @param type is the type of the node that should be resolved.
+	 * @param path is the path for which a node should be resolved.
+	 * @param nodes is set to the list of matching nodes if the symbol table
+	 * contains an entry for the given type and path.
+	 * @return false if the symbol table cannot be used because this root node
+	 * may still change, true otherwise.
+	 */
+	bool lookupSymbols(const Rtti *type, const std::vector<std::string> &path,
+	                   const std::vector<Node *> *&nodes);
+
+	/**
+	 * Stores the nodes matching the given type and path in the symbol table.
+	 * Must only be called after lookupSymbols() returned true.
+	 *
+	 * @param type is the type of the node that was resolved.
+	 * @param path is the path that was resolved.
+	 * @param nodes are the nodes matching type and path.
+	 * @return a reference at the stored node list.
+	 */
+	const std::vector<Node *> &storeSymbols(const Rtti *type,
+	                                        const std::vector<std::string> &path,
+	                                        std::vector<Node *> nodes);
+
+	/**
+	 * Returns the number of entries in the symbol table.
+	 *
+	 * @return the number of type and path combinations for which the matching
+	 * nodes are currently stored.
+	 */
+	size_t getSymbolCount() const { return symbols.size(); }
 };
 
 namespace RttiTypes {
@@ -855,6 +855,7 @@ Rooted<Constant> Typesystem::createConstant(const std::string &name,
 void Typesystem::referenceTypesystem(Handle<Typesystem> typesystem)
 {
 	typesystems.push_back(typesystem);
+	getManager().namesChanged();
 }
 
 /* Class SystemTypesystem */
@@ -16,6 +16,9 @@
     along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <iterator>
+#include <set>
+
 #include <core/common/Exceptions.hpp>
 #include <core/common/Utils.hpp>
 #include <core/common/VariantWriter.hpp>
@@ -41,10 +44,54 @@ ParserScopeBase::ParserScopeBase(const ManagedVector<Node> &nodes)
 {
 }
 
+size_t ParserScopeBase::ResolutionCacheKeyHash::operator()(
+    const ResolutionCacheKey &key) const
+{
+	size_t res = std::hash<const Rtti *>{}(key.type);
+	for (const std::string &s : key.path) {
+		res = res * 31 + std::hash<std::string>{}(s);
+	}
+	for (ManagedUid uid : key.stack) {
+		res = res * 31 + std::hash<ManagedUid>{}(uid);
+	}
+	return res;
+}
+
 Rooted<Node> ParserScopeBase::resolve(const Rtti *type,
                                       const std::vector<std::string> &path,
                                       Logger &logger)
 {
+	if (nodes.empty()) {
+		return nullptr;
+	}
+
+	// Discard all memoized results if names or references changed since they
+	// were computed
+	Manager &mgr = nodes[0]->getManager();
+	if (resolutionCacheGeneration != mgr.getNameGeneration() ||
+	    resolutionCache.size() >= RESOLUTION_CACHE_SIZE) {
+		resolutionCache.clear();
+		resolutionCacheGeneration = mgr.getNameGeneration();
+	}
+
+	// Lookup the result in the cache, the uids make sure that the stack nodes
+	// and the result have not been replaced by other objects in the meantime
+	ResolutionCacheKey key{type, path, {}};
+	key.stack.reserve(nodes.size());
+	for (size_t i = 0; i < nodes.size(); i++) {
+		key.stack.push_back(nodes[i]->getUid());
+	}
+	auto cached = resolutionCache.find(key);
+	if (cached != resolutionCache.end()) {
+		Managed *node = mgr.getManaged(cached->second);
+		if (node) {
+			resolutionCacheHits++;
+			return Rooted<Node>{static_cast<Node *>(node)};
+		}
+		resolutionCache.erase(cached);
+	}
+	resolutionCacheMisses++;
+
 	// Go up the stack and try to resolve the
 	for (auto it = nodes.rbegin(); it != nodes.rend(); it++) {
 		std::vector<ResolutionResult> res = (*it)->resolve(type, path);
@@ -54,6 +101,12 @@ Rooted<Node> ParserScopeBase::resolve(const Rtti *type,
 			continue;
 		}
 
+		// Only memoize unique results, ambiguous references should be reported
+		// each time
+		if (res.size() == 1) {
+			resolutionCache.emplace(std::move(key), res[0].node->getUid());
+		}
+
 		// Log an error if the object is not unique
 		if (res.size() > 1) {
 			logger.error(std::string("The reference \"") +
@@ -133,12 +186,14 @@ DeferredResolution::DeferredResolution(const ManagedVector<Node> &nodes,
 }
 
 bool DeferredResolution::resolve(
-    const std::unordered_multiset<const Node *> &ignore, Logger &logger)
+    const std::unordered_multiset<const Node *> &ignore, Logger &logger,
+    const Node *&blocker)
 {
 	// Fork the logger to prevent error messages from being shown if we actively
 	// ignore the resolution result
 	LoggerFork loggerFork = logger.fork();
 	Rooted<Node> res = scope.resolve(type, path, loggerFork);
+	blocker = nullptr;
 	if (res != nullptr) {
 		if (!ignore.count(res.get())) {
 			loggerFork.commit();
@@ -152,6 +207,7 @@ bool DeferredResolution::resolve(
 			}
 			return true;
 		}
+		blocker = res.get();
 	} else {
 		loggerFork.commit();
 	}
@@ -454,22 +510,100 @@ bool ParserScope::resolveTypeWithValue(const std::string &name,
 
 bool ParserScope::performDeferredResolution(Logger &logger, bool postpone)
 {
-	// Repeat the resolution process as long as something has changed in the
-	// last iteration (resolving a node may cause other nodes to be resolvable).
+	// Resolving a node may cause other nodes to be resolvable. Instead of
+	// repeatedly iterating over the whole list until nothing changes, failed
+	// resolutions are only attempted again once the node they are waiting for
+	// has been resolved or names have changed. The entries are attempted in
+	// the same order as with repeated passes over the list.
+	using Entry = std::list<DeferredResolution>::iterator;
+	std::vector<Entry> entries;
+	std::set<size_t> pass, nextPass;
+	for (Entry it = deferred.begin(); it != deferred.end(); it++) {
+		pass.emplace_hint(pass.end(), entries.size());
+		entries.push_back(it);
+	}
+
+	// Failed entries, either waiting for the node they resolved to or for any
+	// change in the names of the node graph
+	std::unordered_map<const Node *, std::vector<size_t>> blocked;
+	std::vector<size_t> unresolved;
+
+	// Attempts the given entry in the current pass if it lies behind the
+	// currently attempted entry, otherwise in the next pass
+	size_t current = 0;
+	auto retry = [&](size_t idx) {
+		(idx > current ? pass : nextPass).insert(idx);
+	};
+
+	// Use the name generation of the Manager to detect name changes caused by
+	// the result callbacks
+	Manager *mgr = nullptr;
+	for (const DeferredResolution &d : deferred) {
+		if (d.owner != nullptr) {
+			mgr = &d.owner->getManager();
+			break;
+		}
+	}
+	uint64_t generation = mgr ? mgr->getNameGeneration() : 0;
+
 	while (true) {
-		// Iterate over all deferred resolution processes,
 		bool hasChange = false;
-		for (auto it = deferred.begin(); it != deferred.end();) {
-			if (it->resolve(awaitingResolution, logger)) {
-				if (it->owner != nullptr) {
-					awaitingResolution.erase(it->owner.get());
+		while (!pass.empty()) {
+			current = *pass.begin();
+			pass.erase(pass.begin());
+
+			DeferredResolution &d = *entries[current];
+			const size_t count = deferred.size();
+			const Node *blocker;
+			if (!d.resolve(awaitingResolution, logger, blocker)) {
+				if (blocker != nullptr) {
+					blocked[blocker].push_back(current);
+				} else {
+					unresolved.push_back(current);
 				}
-				it = deferred.erase(it);
-				hasChange = true;
-			} else {
-				it++;
+				continue;
+			}
+			hasChange = true;
+
+			// Entries waiting for the owner may now be resolvable
+			if (d.owner != nullptr) {
+				awaitingResolution.erase(d.owner.get());
+				auto it = blocked.find(d.owner.get());
+				if (it != blocked.end()) {
+					for (size_t idx : it->second) {
+						retry(idx);
+					}
+					blocked.erase(it);
+				}
+			}
+			deferred.erase(entries[current]);
+
+			// Callbacks which issue new resolutions append them to the list
+			if (deferred.size() >= count) {
+				Entry it = deferred.end();
+				std::advance(it, -ssize_t(deferred.size() - count + 1));
+				for (; it != deferred.end(); it++) {
+					pass.insert(entries.size());
+					entries.push_back(it);
+				}
+			}
+
+			// If the callback changed names, all failed entries may resolve
+			if (mgr == nullptr || mgr->getNameGeneration() != generation) {
+				generation = mgr ? mgr->getNameGeneration() : 0;
+				for (const auto &b : blocked) {
+					for (size_t idx : b.second) {
+						retry(idx);
+					}
+				}
+				blocked.clear();
+				for (size_t idx : unresolved) {
+					retry(idx);
+				}
+				unresolved.clear();
 			}
 		}
+		std::swap(pass, nextPass);
 
 		// Abort if nothing has changed in the last iteration
 		if (!hasChange) {
@@ -478,6 +612,10 @@ bool ParserScope::performDeferredResolution(Logger &logger, bool postpone)
 			// is set, do not do this
 			if (!awaitingResolution.empty() && !postpone) {
 				awaitingResolution.clear();
+				for (const auto &b : blocked) {
+					pass.insert(b.second.begin(), b.second.end());
+				}
+				blocked.clear();
 			} else {
 				break;
 			}
@@ -21,6 +21,7 @@
 
 #include <functional>
 #include <list>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
@@ -53,6 +54,58 @@ class Variant;
  * lookup, only maintains the stack of nodes.
  */
 class ParserScopeBase {
+private:
+	/**
+	 * Maximum number of entries in the resolution cache. The cache is cleared
+	 * once this size is exceeded.
+	 */
+	static constexpr size_t RESOLUTION_CACHE_SIZE = 1024;
+
+	/**
+	 * Key of the resolution cache, consisting of the requested type, the path
+	 * and the uids of the nodes on the stack.
+	 */
+	struct ResolutionCacheKey {
+		const Rtti *type;
+		std::vector<std::string> path;
+		std::vector<ManagedUid> stack;
+
+		bool operator==(const ResolutionCacheKey &o) const
+		{
+			return type == o.type && path == o.path && stack == o.stack;
+		}
+	};
+
+	/**
+	 * Hash function for the ResolutionCacheKey structure.
+	 */
+	struct ResolutionCacheKeyHash {
+		size_t operator()(const ResolutionCacheKey &key) const;
+	};
+
+	/**
+	 * Cache mapping from type, path and stack to the uid of the node that was
+	 * uniquely resolved for this combination.
+	 */
+	std::unordered_map<ResolutionCacheKey, ManagedUid, ResolutionCacheKeyHash>
+	    resolutionCache;
+
+	/**
+	 * Name generation of the Manager the cache entries were created in. The
+	 * cache is cleared whenever the generation of the Manager changes.
+	 */
+	uint64_t resolutionCacheGeneration = 0;
+
+	/**
+	 * Number of resolve() calls answered from the resolution cache.
+	 */
+	size_t resolutionCacheHits = 0;
+
+	/**
+	 * Number of resolve() calls which had to traverse the graph.
+	 */
+	size_t resolutionCacheMisses = 0;
+
 protected:
 	/**
 	 * List containing all nodes currently on the scope, with the newest nodes
@@ -85,10 +138,31 @@ public:
 	 * should be logged.
 	 * @return a reference at a resolved node or nullptr if no node could be
 	 * found.
+	 *
+	 * Unique results are memoized for the given type, path and the nodes
+	 * currently on the stack. The memoized results are discarded whenever the
+	 * Manager reports a change of names or references, see
+	 * Manager::namesChanged().
 	 */
 	Rooted<Node> resolve(const Rtti *type, const std::vector<std::string> &path,
 	                     Logger &logger);
 
+	/**
+	 * Returns the number of resolve() calls answered from the resolution
+	 * cache.
+	 *
+	 * @return the number of resolution cache hits.
+	 */
+	size_t getResolutionCacheHits() const { return resolutionCacheHits; }
+
+	/**
+	 * Returns the number of resolve() calls which were not answered from the
+	 * resolution cache.
+	 *
+	 * @return the number of resolution cache misses.
+	 */
+	size_t getResolutionCacheMisses() const { return resolutionCacheMisses; }
+
 	/**
 	 * Returns true if the stack is empty.
 	 *
@@ -244,10 +318,12 @@ public:
 	 * resolution result as they are
 	 * @param logger is the logger instance to which error messages should be
 	 * logged.
+	 * @param blocker is set to the resolved node if it was ignored because it
+	 * is contained in the ignore set, otherwise it is set to nullptr.
 	 * @return true if the resolution was successful, false otherwise.
 	 */
 	bool resolve(const std::unordered_multiset<const Node *> &ignore,
-	             Logger &logger);
+	             Logger &logger, const Node *&blocker);
 
 	/**
 	 * Inform the callee about the failure by calling the callback function with
@@ -795,6 +871,8 @@ public:
 	/**
 	 * Tries to resolve all currently deferred resolution steps. The list of
 	 * pending deferred resolutions is cleared after this function has run.
+	 * Failed resolutions are only retried once the node they resolved to is
+	 * no longer awaiting resolution or the names in the node graph changed.
 	 *
 	 * @param logger is the logger instance into which errors should be logged.
 	 * @param postpone if set to true, postpones issuing any error messages and
@@ -28,20 +28,22 @@
 #ifndef _OUSIA_SOURCE_OFFSET_VECTOR_HPP_
 #define _OUSIA_SOURCE_OFFSET_VECTOR_HPP_
 
-#include <cstdint>
+#include <algorithm>
 #include <cassert>
-#include <limits>
-#include <vector>
+#include <cstdint>
 #include <utility>
-#include <unordered_map>
+#include <vector>
 
 #include <core/common/Location.hpp>
 
 namespace ousia {
 
 /**
- * Class used for storing the SourceOffset of each character in the buffer using
- * a delta compression.
+ * Class used for storing the SourceOffset of each character in the buffer in
+ * a run-length encoded manner. Consecutive characters which have the same
+ * length and directly follow each other in the source file are stored as a
+ * single run, so the memory needed for the usual case of a contiguous piece of
+ * text does not depend on its length.
  */
 class SourceOffsetVector {
 public:
@@ -49,57 +51,65 @@ public:
 
 private:
 	/**
-	 * Type used for representing the length of a character.
+	 * Structure describing a run of characters.
 	 */
-	using Length = uint8_t;
-
-	/**
-	 * Maximum length that can be represented using the Length type.
-	 */
-	static constexpr size_t MAX_LEN = std::numeric_limits<Length>::max();
-
-	/**
-	 * Interval in which the actual offset is stored, expressed as the binary
-	 * logarithm.
-	 */
-	static constexpr size_t LOG2_OFFSET_INTERVAL = 6;
-
-	/**
-	 * Interval in which the actual offset is stored.
-	 */
-	static constexpr size_t OFFSET_INTERVAL = (1 << LOG2_OFFSET_INTERVAL);
-
-	/**
-	 * Bitmask for the bits that are set to zero when a new offset needs to be
-	 * written.
-	 */
-	static constexpr size_t OFFSET_INTERVAL_MASK = OFFSET_INTERVAL - 1;
-
-	/**
-	 * Vector containing the delta compressed offset information.
-	 */
-	std::vector<Length> lens;
+	struct Run {
+		/**
+		 * Index of the first character of the run.
+		 */
+		size_t idx;
+
+		/**
+		 * Start offset of the first character of the run.
+		 */
+		SourceOffset start;
+
+		/**
+		 * Length of each character of the run in the source file.
+		 */
+		SourceOffset len;
+
+		/**
+		 * Constructor of the Run structure.
+		 *
+		 * @param idx is the index of the first character.
+		 * @param start is the start offset of the first character.
+		 * @param len is the length of each character.
+		 */
+		Run(size_t idx, SourceOffset start, SourceOffset len)
+		    : idx(idx), start(start), len(len)
+		{
+		}
+	};
 
 	/**
-	 * Offsets containing the absolute offset for all OFFSET_INTERVAL elements.
+	 * Vector containing all runs, sorted by their index.
 	 */
-	std::vector<SourceOffset> offsets;
+	std::vector<Run> runs;
 
 	/**
-	 * Map used to store discontinuities in the character offsets.
+	 * Number of characters for which offsets are stored.
 	 */
-	std::unordered_map<size_t, OffsPair> gaps;
+	size_t count;
 
 	/**
-	 * Last position given as "end" position in the storeOffset() method.
+	 * Returns the end offset of the given run.
+	 *
+	 * @param it is an iterator pointing at the run.
+	 * @return the end offset of the last character in the run.
 	 */
-	SourceOffset lastEnd;
+	SourceOffset runEnd(std::vector<Run>::const_iterator it) const
+	{
+		const size_t runCount =
+		    (it + 1 == runs.end() ? count : (it + 1)->idx) - it->idx;
+		return it->start + runCount * it->len;
+	}
 
 public:
 	/**
 	 * Default constructor of the SourceOffsetVector class.
 	 */
-	SourceOffsetVector() : lastEnd(0) {}
+	SourceOffsetVector() : count(0) {}
 
 	/**
 	 * Stores the location of a character in this SourceOffsetVector.
@@ -109,25 +119,32 @@ public:
 	 */
 	void storeOffset(SourceOffset start, SourceOffset end)
 	{
-		// Make sure (end - start) is smaller than MAX_LEN
-		assert(end - start < MAX_LEN);
+		storeOffsets(start, end - start, 1);
+	}
 
-		// Store an absolute offset every OFFSET_INTERVAL elements
-		if ((lens.size() & OFFSET_INTERVAL_MASK) == 0) {
-			offsets.push_back(start);
+	/**
+	 * Stores the location of a number of consecutive characters of equal
+	 * length in this SourceOffsetVector.
+	 *
+	 * @param start is the start location of the first character in the source
+	 * file.
+	 * @param len is the length of each character in the source file. Pass
+	 * InvalidSourceOffset as start and zero as length to store characters
+	 * without a location.
+	 * @param n is the number of characters.
+	 */
+	void storeOffsets(SourceOffset start, SourceOffset len, size_t n)
+	{
+		// Extend the last run if the characters directly follow it and have
+		// the same length, otherwise start a new run
+		if (n == 0) {
+			return;
 		}
-
-		// Adapt the length of the previous character in case there is a gap
-		if (!lens.empty() && start > lastEnd) {
-			// There is a discontinuity, store the given offsets in the "gaps"
-			// map
-			gaps[lens.size()] = OffsPair(start, end);
-			lens.push_back(MAX_LEN);
-		} else {
-			// Store the length
-			lens.push_back(end - start);
+		if (runs.empty() || runs.back().len != len ||
+		    runEnd(runs.end() - 1) != start) {
+			runs.emplace_back(count, start, len);
 		}
-		lastEnd = end;
+		count += n;
 	}
 
 	/**
@@ -140,67 +157,42 @@ public:
 	OffsPair loadOffset(size_t idx) const
 	{
 		// Special treatment for the last character
-		const size_t count = lens.size();
 		if (idx > 0 && idx == count) {
 			auto offs = loadOffset(count - 1);
 			return OffsPair(offs.second, offs.second);
 		}
 
-		// Calculate the start index in the lens vector and in the offsets
-		// vector
-		const size_t offsetIdx = idx >> LOG2_OFFSET_INTERVAL;
-		const size_t sumStartIdx = idx & ~OFFSET_INTERVAL_MASK;
-
 		// Make sure the index is valid
 		assert(idx < count);
-		assert(offsetIdx < offsets.size());
-
-		// If the length of the last character is MAX_LEN, the position is
-		// stored in the "gaps" list
-		if (lens[idx] == MAX_LEN) {
-			auto it = gaps.find(idx);
-			assert(it != gaps.end());
-			return it->second;
-		}
 
-		// Sum over the length starting with the start offset
-		SourceOffset start = offsets[offsetIdx];
-		for (size_t i = sumStartIdx; i < idx; i++) {
-			if (lens[i] == MAX_LEN) {
-				auto it = gaps.find(i);
-				assert(it != gaps.end());
-				start = it->second.first;
-			} else {
-				start += lens[i];
-			}
-		}
-		return OffsPair(start, start + lens[idx]);
+		// Search the run containing the character
+		auto it = std::upper_bound(
+		    runs.begin(), runs.end(), idx,
+		    [](size_t idx, const Run &run) { return idx < run.idx; });
+		assert(it != runs.begin());
+		--it;
+		const SourceOffset start = it->start + (idx - it->idx) * it->len;
+		return OffsPair(start, start + it->len);
 	}
 
 	/**
 	 * Returns the number of characters for which offsets are stored.
 	 */
-	size_t size() const { return lens.size(); }
+	size_t size() const { return count; }
 
 	/**
-	 * Trims the length of the TokenizedData instance to the given length.
-	 * Removes all token matches that lie within the trimmed region.
+	 * Trims the length of the SourceOffsetVector to the given length.
 	 *
-	 * @param length is the number of characters to which the TokenizedData
-	 * instance should be trimmed.
+	 * @param length is the number of characters to which the
+	 * SourceOffsetVector instance should be trimmed.
 	 */
 	void trim(size_t length)
 	{
 		if (length < size()) {
-			lens.resize(length);
-			if (length > 0) {
-				offsets.resize((length >> LOG2_OFFSET_INTERVAL) + 1);
-				lastEnd = loadOffset(length - 1).second;
-			} else {
-				offsets.clear();
-				gaps.clear();
-				lastEnd = 0;
+			while (!runs.empty() && runs.back().idx >= length) {
+				runs.pop_back();
 			}
+			count = length;
 		}
 	}
 
@@ -210,10 +202,8 @@ public:
 	 */
 	void clear()
 	{
-		lens.clear();
-		offsets.clear();
-		gaps.clear();
-		lastEnd = 0;
+		runs.clear();
+		count = 0;
 	}
 };
 }
@@ -16,6 +16,9 @@
     along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <algorithm>
+#include <unordered_map>
+
 #include "TokenTrie.hpp"
 
 namespace ousia {
@@ -26,6 +29,94 @@ TokenTrie::Node::Node() : id(Tokens::Empty) {}
 
 /* Class DynamicTokenTree */
 
+constexpr TokenTrie::Table::State TokenTrie::Table::NONE;
+constexpr TokenTrie::Table::State TokenTrie::Table::ROOT;
+
+TokenTrie::TokenTrie() : tableValid(false), automatonValid(false) {}
+
+void TokenTrie::compile() const
+{
+	// Enumerate all nodes in breadth-first order, the state of the i-th node
+	// is i + 1. Assign a byte class to each character on the way.
+	std::vector<const Node *> nodes{&root};
+	std::unordered_map<const Node *, Table::State> states{{&root, Table::ROOT}};
+	table.classes.fill(0);
+	table.classCount = 1;
+	for (size_t i = 0; i < nodes.size(); i++) {
+		for (const auto &child : nodes[i]->children) {
+			const unsigned char c = child.first;
+			if (table.classes[c] == 0) {
+				table.classes[c] = table.classCount++;
+			}
+			states.emplace(child.second.get(), nodes.size() + 1);
+			nodes.push_back(child.second.get());
+		}
+	}
+
+	// Fill the transition table, the token ids and the advanceable flags
+	const size_t stateCount = nodes.size() + 1;
+	table.transitions.assign(stateCount * table.classCount, Table::NONE);
+	table.ids.assign(stateCount, Tokens::Empty);
+	table.advanceable.assign(stateCount, 0);
+	for (size_t i = 0; i < nodes.size(); i++) {
+		const Table::State state = i + 1;
+		table.ids[state] = nodes[i]->id;
+		table.advanceable[state] = !nodes[i]->children.empty();
+		for (const auto &child : nodes[i]->children) {
+			const unsigned char c = child.first;
+			table.transitions[state * table.classCount + table.classes[c]] =
+			    states[child.second.get()];
+		}
+	}
+	tableValid = true;
+}
+
+void TokenTrie::compileAutomaton() const
+{
+	// The states of the table are numbered in breadth-first order, so the
+	// failure link of each state points at a state which has already been
+	// processed
+	const Table &t = getTable();
+	const size_t stateCount = t.ids.size();
+	const size_t classCount = t.classCount;
+	automaton.classes = t.classes;
+	automaton.classCount = classCount;
+	automaton.transitions.assign(stateCount * classCount, Table::ROOT);
+	automaton.ids = t.ids;
+	automaton.depths.assign(stateCount, 0);
+	automaton.matchLinks.assign(stateCount, Table::NONE);
+	automaton.advanceLinks.assign(stateCount, Table::NONE);
+	automaton.advanceable = t.advanceable;
+	automaton.maxDepth = 0;
+
+	std::vector<Table::State> failure(stateCount, Table::ROOT);
+	for (Table::State state = Table::ROOT; state < stateCount; state++) {
+		const Table::State fail = failure[state];
+		if (state != Table::ROOT) {
+			automaton.matchLinks[state] = automaton.firstMatch(fail);
+			automaton.advanceLinks[state] = automaton.firstAdvanceable(fail);
+		}
+		for (size_t c = 0; c < classCount; c++) {
+			const size_t idx = state * classCount + c;
+			const Table::State child = t.transitions[idx];
+			const Table::State fallback =
+			    state == Table::ROOT
+			        ? Table::ROOT
+			        : automaton.transitions[fail * classCount + c];
+			if (child == Table::NONE) {
+				automaton.transitions[idx] = fallback;
+			} else {
+				automaton.transitions[idx] = child;
+				automaton.depths[child] = automaton.depths[state] + 1;
+				failure[child] = fallback;
+				automaton.maxDepth = std::max<size_t>(
+				    automaton.maxDepth, automaton.depths[child]);
+			}
+		}
+	}
+	automatonValid = true;
+}
+
 bool TokenTrie::registerToken(const std::string &token,
                               TokenId id) noexcept
 {
@@ -36,6 +127,8 @@ bool TokenTrie::registerToken(const std::string &token,
 
 	// Iterate over each character in the given string and insert them as
 	// (new) nodes
+	tableValid = false;
+	automatonValid = false;
 	Node *node = &root;
 	for (size_t i = 0; i < token.size(); i++) {
 		// Insert a new node if this one does not exist
@@ -89,6 +182,8 @@ bool TokenTrie::unregisterToken(const std::string &token) noexcept
 	if (node->id == Tokens::Empty) {
 		return false;
 	}
+	tableValid = false;
+	automatonValid = false;
 
 	// If the target node has children, we cannot delete the subtree. Set the
 	// type to Tokens::Empty instead
@@ -28,10 +28,12 @@
 #ifndef _OUSIA_TOKEN_TRIE_HPP_
 #define _OUSIA_TOKEN_TRIE_HPP_
 
+#include <array>
 #include <cstdint>
 #include <memory>
 #include <limits>
 #include <unordered_map>
+#include <vector>
 
 #include <core/common/Token.hpp>
 
@@ -57,6 +59,10 @@ namespace ousia {
  * \endcode
  *
  * Where the number indicates the corresponding token descriptor identifier.
+ *
+ * For matching, the trie is compiled into a flat state transition table (see
+ * TokenTrie::Table) or an Aho-Corasick automaton (see TokenTrie::Automaton),
+ * which are lazily rebuilt whenever the trie changes.
  */
 class TokenTrie {
 public:
@@ -85,13 +91,240 @@ public:
 		Node();
 	};
 
+	/**
+	 * Flat state transition table compiled from the token trie. Each node of
+	 * the trie corresponds to a state. State zero is the "no transition"
+	 * state, state one corresponds to the root node. To keep the table small,
+	 * characters are mapped onto byte classes: each character occurring in
+	 * any token has its own class, all other characters share class zero.
+	 */
+	struct Table {
+		/**
+		 * Type used to represent a state.
+		 */
+		using State = uint32_t;
+
+		/**
+		 * State reached if there is no transition for a character.
+		 */
+		static constexpr State NONE = 0;
+
+		/**
+		 * State corresponding to the root node.
+		 */
+		static constexpr State ROOT = 1;
+
+		/**
+		 * Maps each character onto its byte class.
+		 */
+		std::array<uint16_t, 256> classes;
+
+		/**
+		 * Number of byte classes.
+		 */
+		size_t classCount;
+
+		/**
+		 * Transition table, the state following the state s for a character
+		 * of class c is stored at index s * classCount + c.
+		 */
+		std::vector<State> transitions;
+
+		/**
+		 * Token id for each state, Tokens::Empty if the state does not
+		 * represent a complete token.
+		 */
+		std::vector<TokenId> ids;
+
+		/**
+		 * Contains a non-zero value for each state which has outgoing
+		 * transitions.
+		 */
+		std::vector<uint8_t> advanceable;
+
+		/**
+		 * Returns the state following the given state for the given
+		 * character.
+		 *
+		 * @param state is the current state.
+		 * @param c is the next character.
+		 * @return the next state or NONE if there is no such transition.
+		 */
+		State next(State state, char c) const
+		{
+			return transitions[state * classCount +
+			                   classes[static_cast<unsigned char>(c)]];
+		}
+
+		/**
+		 * Returns the id of the token represented by the given state.
+		 *
+		 * @param state is the state for which the token id should be returned.
+		 * @return the token id or Tokens::Empty if the state does not
+		 * represent a complete token.
+		 */
+		TokenId id(State state) const { return ids[state]; }
+
+		/**
+		 * Returns true if there are transitions from the given state to other
+		 * states.
+		 *
+		 * @param state is the state that should be checked.
+		 * @return true if the state can be advanced.
+		 */
+		bool canAdvance(State state) const { return advanceable[state] != 0; }
+	};
+
+	/**
+	 * Aho-Corasick automaton compiled from the token trie. The states are the
+	 * same as in the Table, however the transitions never fail: if there is
+	 * no transition in the trie, the failure links are followed until a state
+	 * with a matching transition (or the root) is reached. As a result, the
+	 * current state always corresponds to the longest suffix of the input
+	 * that is a prefix of a token. All other suffixes which are prefixes of
+	 * tokens can be enumerated by following the links stored for each state.
+	 */
+	struct Automaton {
+		/**
+		 * Type used to represent a state.
+		 */
+		using State = Table::State;
+
+		/**
+		 * Maps each character onto its byte class.
+		 */
+		std::array<uint16_t, 256> classes;
+
+		/**
+		 * Number of byte classes.
+		 */
+		size_t classCount;
+
+		/**
+		 * Transition table, the state following the state s for a character
+		 * of class c is stored at index s * classCount + c.
+		 */
+		std::vector<State> transitions;
+
+		/**
+		 * Token id for each state, Tokens::Empty if the state does not
+		 * represent a complete token.
+		 */
+		std::vector<TokenId> ids;
+
+		/**
+		 * Length of the token prefix represented by each state.
+		 */
+		std::vector<uint32_t> depths;
+
+		/**
+		 * For each state, the next state on the failure chain which represents
+		 * a complete token or Table::NONE if there is no such state.
+		 */
+		std::vector<State> matchLinks;
+
+		/**
+		 * For each state, the next state on the failure chain which has
+		 * outgoing transitions in the trie or Table::NONE if there is no such
+		 * state (the root is not part of the chain).
+		 */
+		std::vector<State> advanceLinks;
+
+		/**
+		 * Contains a non-zero value for each state which has outgoing
+		 * transitions in the trie.
+		 */
+		std::vector<uint8_t> advanceable;
+
+		/**
+		 * Length of the longest token.
+		 */
+		size_t maxDepth;
+
+		/**
+		 * Returns the state following the given state for the given
+		 * character.
+		 *
+		 * @param state is the current state.
+		 * @param c is the next character.
+		 * @return the next state, which is the root if no suffix of the input
+		 * is a token prefix.
+		 */
+		State next(State state, char c) const
+		{
+			return transitions[state * classCount +
+			                   classes[static_cast<unsigned char>(c)]];
+		}
+
+		/**
+		 * Returns the first state on the failure chain starting with the given
+		 * state (inclusive) which represents a complete token.
+		 *
+		 * @param state is the state at which the chain starts.
+		 * @return the first matching state or Table::NONE.
+		 */
+		State firstMatch(State state) const
+		{
+			return ids[state] != Tokens::Empty ? state : matchLinks[state];
+		}
+
+		/**
+		 * Returns the first state on the failure chain starting with the given
+		 * state (inclusive) which has outgoing transitions in the trie.
+		 *
+		 * @param state is the state at which the chain starts.
+		 * @return the first advanceable state or Table::NONE.
+		 */
+		State firstAdvanceable(State state) const
+		{
+			return (state != Table::ROOT && advanceable[state])
+			           ? state
+			           : advanceLinks[state];
+		}
+	};
+
 private:
 	/**
 	 * Root node of the internal token tree.
 	 */
 	Node root;
 
+	/**
+	 * Compiled state transition table, only valid if tableValid is true.
+	 */
+	mutable Table table;
+
+	/**
+	 * Set to false whenever the trie is modified.
+	 */
+	mutable bool tableValid;
+
+	/**
+	 * Compiled Aho-Corasick automaton, only valid if automatonValid is true.
+	 */
+	mutable Automaton automaton;
+
+	/**
+	 * Set to false whenever the trie is modified.
+	 */
+	mutable bool automatonValid;
+
+	/**
+	 * Compiles the trie into the state transition table.
+	 */
+	void compile() const;
+
+	/**
+	 * Compiles the state transition table into the Aho-Corasick automaton.
+	 */
+	void compileAutomaton() const;
+
 public:
+	/**
+	 * Default constructor of the TokenTrie class, creates an empty trie.
+	 */
+	TokenTrie();
+
 	/**
 	 * Registers a token containing the given string. Returns false if the
 	 * token already exists, true otherwise.
@@ -129,6 +362,38 @@ public:
 	 * @return a reference at the root node.
 	 */
 	const Node *getRoot() const noexcept { return &root; }
+
+	/**
+	 * Returns the state transition table corresponding to the current state
+	 * of the trie. The table is compiled if the trie has been changed since
+	 * the last call.
+	 *
+	 * @return a reference at the state transition table, which is valid until
+	 * the trie is modified.
+	 */
+	const Table &getTable() const
+	{
+		if (!tableValid) {
+			compile();
+		}
+		return table;
+	}
+
+	/**
+	 * Returns the Aho-Corasick automaton corresponding to the current state of
+	 * the trie. The automaton is compiled if the trie has been changed since
+	 * the last call.
+	 *
+	 * @return a reference at the automaton, which is valid until the trie is
+	 * modified.
+	 */
+	const Automaton &getAutomaton() const
+	{
+		if (!automatonValid) {
+			compileAutomaton();
+		}
+		return automaton;
+	}
 };
 }
 
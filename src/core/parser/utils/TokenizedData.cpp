@@ -136,9 +136,10 @@ private:
 	std::vector<char> buf;
 
 	/**
-	 * Buffset storing the "protected" flag of the character data.
+	 * Sorted list of non-overlapping ranges of protected characters, each
+	 * range is stored as pair of start and end position in the buffer.
 	 */
-	std::vector<bool> protectedChars;
+	std::vector<std::pair<size_t, size_t>> protectedRanges;
 
 	/**
 	 * Vector storing all the character offsets efficiently.
@@ -191,63 +192,17 @@ private:
 	 */
 	mutable bool sorted : 1;
 
-public:
-	/**
-	 * Constructor of TokenizedDataImpl. Takes the SourceId that should be used
-	 * for returned tokens.
-	 *
-	 * @param sourceId is the source identifier that should be used for
-	 * constructing the location when returning tokens.
-	 */
-	TokenizedDataImpl(SourceId sourceId) : sourceId(sourceId) { clear(); }
-
 	/**
-	 * Appends a complete string to the internal character buffer and extends
-	 * the text regions in the regions map.
+	 * Updates the whitespace flags and the linebreak and indentation state
+	 * machine for a character which has been appended to the buffer.
 	 *
-	 * @param data is the string that should be appended to the buffer.
-	 * @param offsStart is the start offset in bytes in the input file.
-	 * @param protect if set to true, the appended characters will not be
-	 * affected by whitespace handling, they will be returned as is.
-	 * @return the current size of the internal byte buffer. The returned value
-	 * is intended to be used for the "mark" function.
+	 * @param c is the character that has been appended.
+	 * @param pos is the position of the character in the buffer.
 	 */
-	size_t append(const std::string &data, SourceOffset offsStart, bool protect)
+	void update(char c, size_t pos)
 	{
-		for (size_t i = 0; i < data.size(); i++) {
-			if (offsStart != InvalidSourceOffset) {
-				append(data[i], offsStart + i, offsStart + i + 1, protect);
-			} else {
-				append(data[i], InvalidSourceOffset, InvalidSourceOffset,
-				       protect);
-			}
-		}
-		return size();
-	}
-
-	/**
-	 * Appends a single character to the internal character buffer and extends
-	 * the text regions in the regions map.
-	 *
-	 * @param c is the character that should be appended to the buffer.
-	 * @param offsStart is the start offset in bytes in the input file.
-	 * @param offsEnd is the end offset in bytes in the input file.
-	 * @param protect if set to true, the appended character will not be
-	 * affected by whitespace handling, it will be returned as is.
-	 * @return the current size of the internal byte buffer. The returned value
-	 * is intended to be used for the "mark" function.
-	 */
-	size_t append(char c, SourceOffset offsStart, SourceOffset offsEnd,
-	              bool protect)
-	{
-		// Add the character to the list and store the location of the character
-		// in the source file
-		buf.push_back(c);
-		protectedChars.push_back(protect);
-		offsets.storeOffset(offsStart, offsEnd);
-
 		// Fetch information about the current character
-		const size_t size = buf.size();
+		const size_t size = pos + 1;
 		const bool isWhitespace = Utils::isWhitespace(c);
 		const bool isLinebreak = Utils::isLinebreak(c);
 
@@ -322,8 +277,132 @@ public:
 			lastIndentation = currentIndentation;
 			numLinebreaks = 0;
 		}
+	}
+
+	/**
+	 * Marks the characters in the given range as protected.
+	 *
+	 * @param start is the position of the first character.
+	 * @param end is the position after the last character.
+	 */
+	void protectRange(size_t start, size_t end)
+	{
+		// Search the first range starting after the given start position and
+		// merge with the previous range if they touch
+		auto it = std::upper_bound(protectedRanges.begin(),
+		                           protectedRanges.end(), start, rangeLess);
+		if (it != protectedRanges.begin() && (it - 1)->second >= start) {
+			--it;
+			it->second = std::max(it->second, end);
+		} else {
+			it = protectedRanges.emplace(it, start, end);
+		}
+
+		// Merge all following ranges which are now overlapping
+		auto next = it + 1;
+		while (next != protectedRanges.end() && next->first <= it->second) {
+			it->second = std::max(it->second, next->second);
+			next = protectedRanges.erase(next);
+		}
+	}
+
+	/**
+	 * Comparator used to search the protectedRanges list.
+	 */
+	static bool rangeLess(size_t pos, const std::pair<size_t, size_t> &range)
+	{
+		return pos < range.first;
+	}
+
+public:
+	/**
+	 * Constructor of TokenizedDataImpl. Takes the SourceId that should be used
+	 * for returned tokens.
+	 *
+	 * @param sourceId is the source identifier that should be used for
+	 * constructing the location when returning tokens.
+	 */
+	TokenizedDataImpl(SourceId sourceId) : sourceId(sourceId) { clear(); }
+
+	/**
+	 * Appends a sequence of characters to the internal character buffer and
+	 * extends the text regions in the regions map. The characters are assumed
+	 * to be consecutive bytes in the input file.
+	 *
+	 * @param data is a pointer at the characters that should be appended.
+	 * @param len is the number of characters.
+	 * @param offsStart is the start offset in bytes in the input file.
+	 * @param protect if set to true, the appended characters will not be
+	 * affected by whitespace handling, they will be returned as is.
+	 * @return the current size of the internal byte buffer. The returned value
+	 * is intended to be used for the "mark" function.
+	 */
+	size_t append(const char *data, size_t len, SourceOffset offsStart,
+	              bool protect)
+	{
+		// Add the characters to the buffer and store their location as a
+		// single run
+		const size_t pos = buf.size();
+		buf.insert(buf.end(), data, data + len);
+		if (protect && len > 0) {
+			protectRange(pos, pos + len);
+		}
+		if (offsStart != InvalidSourceOffset) {
+			offsets.storeOffsets(offsStart, 1, len);
+		} else {
+			offsets.storeOffsets(InvalidSourceOffset, 0, len);
+		}
 
-		return size;
+		// Outside of the indentation at the beginning of a line, only
+		// linebreaks affect the state machine -- skip to the next linebreak
+		// and just update the whitespace flags
+		size_t i = 0;
+		while (i < len) {
+			if (numLinebreaks == 0) {
+				size_t end = i;
+				while (end < len && !Utils::isLinebreak(data[end])) {
+					end++;
+				}
+				if (end > i) {
+					for (size_t j = i; j < end && !hasNonWhitespaceChar; j++) {
+						hasNonWhitespaceChar = !Utils::isWhitespace(data[j]);
+					}
+					lastCharIsWhitespace = Utils::isWhitespace(data[end - 1]);
+					i = end;
+					continue;
+				}
+			}
+			update(data[i], pos + i);
+			i++;
+		}
+		return size();
+	}
+
+	/**
+	 * Appends a single character to the internal character buffer and extends
+	 * the text regions in the regions map.
+	 *
+	 * @param c is the character that should be appended to the buffer.
+	 * @param offsStart is the start offset in bytes in the input file.
+	 * @param offsEnd is the end offset in bytes in the input file.
+	 * @param protect if set to true, the appended character will not be
+	 * affected by whitespace handling, it will be returned as is.
+	 * @return the current size of the internal byte buffer. The returned value
+	 * is intended to be used for the "mark" function.
+	 */
+	size_t append(char c, SourceOffset offsStart, SourceOffset offsEnd,
+	              bool protect)
+	{
+		// Add the character to the list and store the location of the character
+		// in the source file
+		const size_t pos = buf.size();
+		buf.push_back(c);
+		if (protect) {
+			protectRange(pos, pos + 1);
+		}
+		offsets.storeOffset(offsStart, offsEnd);
+		update(c, pos);
+		return size();
 	}
 
 	/**
@@ -332,7 +411,24 @@ public:
 	 * @param bufPos is the position of the character for which the "protected"
 	 * flag should be set.
 	 */
-	void protect(size_t bufPos) { protectedChars[bufPos] = true; }
+	void protect(size_t bufPos) { protectRange(bufPos, bufPos + 1); }
+
+	/**
+	 * Returns true if the character at the given buffer position is
+	 * protected.
+	 *
+	 * @param bufPos is the position of the character.
+	 * @return true if the character is protected.
+	 */
+	bool isProtected(size_t bufPos) const
+	{
+		if (protectedRanges.empty()) {
+			return false;
+		}
+		auto it = std::upper_bound(protectedRanges.begin(),
+		                           protectedRanges.end(), bufPos, rangeLess);
+		return it != protectedRanges.begin() && bufPos < (it - 1)->second;
+	}
 
 	/**
 	 * Stores a token at the given position.
@@ -438,14 +534,26 @@ public:
 					const char *cBuf = &buf[bufPos];
 					auto filter = [cBuf, this](size_t i) -> bool {
 						return Utils::isWhitespace(cBuf[i]) &&
-						       !protectedChars[i];
+						       !isProtected(i);
 					};
-					if (mode == WhitespaceMode::TRIM) {
+					if (!protectedRanges.empty()) {
+						// Fall back to the per-character filter if some
+						// whitespace characters might be protected
+						if (mode == WhitespaceMode::TRIM) {
+							content =
+							    Utils::trim(cBuf, end - bufPos, stringStart,
+							                stringEnd, filter);
+						} else {
+							content =
+							    Utils::collapse(cBuf, end - bufPos, stringStart,
+							                    stringEnd, filter);
+						}
+					} else if (mode == WhitespaceMode::TRIM) {
 						content = Utils::trim(cBuf, end - bufPos, stringStart,
-						                      stringEnd, filter);
+						                      stringEnd);
 					} else {
-						content = Utils::collapse(
-						    cBuf, end - bufPos, stringStart, stringEnd, filter);
+						content = Utils::collapse(cBuf, end - bufPos,
+						                          stringStart, stringEnd);
 					}
 
 					// If the resulting string is empty (only whitespaces),
@@ -500,7 +608,7 @@ public:
 	void clear()
 	{
 		buf.clear();
-		protectedChars.clear();
+		protectedRanges.clear();
 		offsets.clear();
 		marks.clear();
 		firstLinebreak = 0;
@@ -523,7 +631,14 @@ public:
 	{
 		if (length < size()) {
 			buf.resize(length);
-			protectedChars.resize(length);
+			while (!protectedRanges.empty() &&
+			       protectedRanges.back().first >= length) {
+				protectedRanges.pop_back();
+			}
+			if (!protectedRanges.empty()) {
+				protectedRanges.back().second =
+				    std::min(protectedRanges.back().second, length);
+			}
 			offsets.trim(length);
 
 			// Recalculate the whitespace flags
@@ -627,7 +742,13 @@ TokenizedData::~TokenizedData() {}
 size_t TokenizedData::append(const std::string &data, SourceOffset offsStart,
                              bool protect)
 {
-	return impl->append(data, offsStart, protect);
+	return impl->append(data.data(), data.size(), offsStart, protect);
+}
+
+size_t TokenizedData::appendSpan(const char *data, size_t len,
+                                 SourceOffset offsStart, bool protect)
+{
+	return impl->append(data, len, offsStart, protect);
 }
 
 size_t TokenizedData::append(char c, SourceOffset offsStart,
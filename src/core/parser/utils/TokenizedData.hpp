@@ -129,6 +129,22 @@ public:
 	size_t append(const std::string &data, SourceOffset offsStart = 0,
 	              bool protect = false);
 
+	/**
+	 * Appends a sequence of characters to the internal character buffer. The
+	 * characters are assumed to be consecutive bytes in the input file, their
+	 * locations are stored as a single run.
+	 *
+	 * @param data is a pointer at the characters that should be appended.
+	 * @param len is the number of characters that should be appended.
+	 * @param offsStart is the start offset in bytes in the input file.
+	 * @param protect if set to true, the appended characters will not be
+	 * affected by whitespace handling, they will be returned as is.
+	 * @return the current size of the internal byte buffer. The returned value
+	 * is intended to be used for the "mark" function.
+	 */
+	size_t appendSpan(const char *data, size_t len, SourceOffset offsStart,
+	                  bool protect = false);
+
 	/**
 	 * Appends a single character to the internal character buffer.
 	 *
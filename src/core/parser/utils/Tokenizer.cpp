@@ -16,6 +16,7 @@
     along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <algorithm>
 #include <memory>
 #include <vector>
 
@@ -33,13 +34,30 @@ namespace {
 /* Internal class TokenMatch */
 
 /**
- * Contains information about a matching token.
+ * Contains information about a matching token. The token text is referenced
+ * by its id and source offsets, the actual Token instance is only written once
+ * the Tokenizer returns.
  */
 struct TokenMatch {
 	/**
-	 * Token that was matched.
+	 * Id of the token that was matched.
 	 */
-	Token token;
+	TokenId id;
+
+	/**
+	 * Start offset of the token within the source file.
+	 */
+	SourceOffset start;
+
+	/**
+	 * End offset of the token within the source file.
+	 */
+	SourceOffset end;
+
+	/**
+	 * Length of the matched token string.
+	 */
+	size_t length;
 
 	/**
 	 * Position at which this token starts in the TokenizedData instance.
@@ -54,115 +72,86 @@ struct TokenMatch {
 	/**
 	 * Constructor of the TokenMatch class.
 	 */
-	TokenMatch() : dataStartOffset(0), primary(false) {}
+	TokenMatch()
+	    : id(Tokens::Empty),
+	      start(0),
+	      end(0),
+	      length(0),
+	      dataStartOffset(0),
+	      primary(false)
+	{
+	}
 
 	/**
 	 * Returns true if this TokenMatch instance actually represents a match.
 	 *
 	 * @return true if the TokenMatch actually has a match.
 	 */
-	bool hasMatch() const { return token.id != Tokens::Empty; }
+	bool hasMatch() const { return id != Tokens::Empty; }
 
 	/**
 	 * Returns the length of the matched token.
 	 *
 	 * @return the length of the token string.
 	 */
-	size_t size() const { return token.content.size(); }
+	size_t size() const { return length; }
 };
-
-/* Internal class TokenLookup */
+}
 
 /**
- * The TokenLookup class is used to represent a thread in a running token
- * lookup.
+ * Records a token which has been matched in the input. Replaces the given best
+ * match if the token is longer and marks non-primary tokens in the
+ * TokenizedData instance.
+ *
+ * @param bestMatch is the longest token matched so far.
+ * @param data is the TokenizedData instance to which the current character
+ * is about to be appended.
+ * @param id is the id of the matched token.
+ * @param descr is the descriptor of the matched token.
+ * @param start is the start offset of the token within the source file.
+ * @param end is the end offset of the token within the source file.
+ * @param dataStartOffset is the position at which the token starts in the
+ * TokenizedData instance.
  */
-class TokenLookup {
-private:
-	/**
-	 * Current node within the token trie.
-	 */
-	TokenTrie::Node const *node;
-
-	/**
-	 * Start offset within the source file.
-	 */
-	size_t start;
-
-	/**
-	 * Position at which this token starts in the TokenizedData instance.
-	 */
-	size_t dataStartOffset;
-
-public:
-	/**
-	 * Constructor of the TokenLookup class.
-	 *
-	 * @param node is the current node.
-	 * @param start is the start position in the source file.
-	 * @param dataStartOffset is the current length of the TokenizedData buffer.
-	 */
-	TokenLookup(const TokenTrie::Node *node, size_t start,
-	            size_t dataStartOffset)
-	    : node(node), start(start), dataStartOffset(dataStartOffset)
-	{
+static void recordMatch(TokenMatch &bestMatch, TokenizedData &data,
+                        TokenId id, const Tokenizer::TokenDescriptor &descr,
+                        SourceOffset start, SourceOffset end,
+                        size_t dataStartOffset)
+{
+	// Replace the best match with longest token
+	const size_t len = descr.string.size();
+	if (len > bestMatch.size()) {
+		bestMatch.id = id;
+		bestMatch.start = start;
+		bestMatch.end = end;
+		bestMatch.length = len;
+		bestMatch.dataStartOffset = dataStartOffset;
+		bestMatch.primary = descr.primary;
 	}
 
-	/**
-	 * Tries to extend the current path in the token trie with the given
-	 * character. If a complete token is matched, stores the match in the given
-	 * TokenMatch reference and returns true.
-	 *
-	 * @param c is the character that should be appended to the current prefix.
-	 * @param lookups is a list to which new TokeLookup instances are added --
-	 * which could potentially be expanded in the next iteration.
-	 * @param match is the Token instance to which the matching token
-	 * should be written.
-	 * @param tokens is a reference at the internal token list of the
-	 * Tokenizer.
-	 * @param end is the end byte offset of the current character.
-	 * @param sourceId is the source if of this file.
-	 * @return true if a token was matched, false otherwise.
-	 */
-	bool advance(char c, std::vector<TokenLookup> &lookups, TokenMatch &match,
-	             const std::vector<Tokenizer::TokenDescriptor> &tokens,
-	             SourceOffset end, SourceId sourceId)
-	{
-		// Set to true once a token has been matched
-		bool res = false;
-
-		// Check whether we can continue the current token path, if not, abort
-		auto it = node->children.find(c);
-		if (it == node->children.end()) {
-			return res;
-		}
-
-		// Check whether the new node represents a complete token and whether it
-		// is longer than the current token. If yes, replace the current token.
-		node = it->second.get();
-		if (node->id != Tokens::Empty) {
-			const Tokenizer::TokenDescriptor &descr = tokens[node->id];
-			match.token = Token(node->id, descr.string,
-			                    SourceLocation(sourceId, start, end));
-			match.dataStartOffset = dataStartOffset;
-			match.primary = descr.primary;
-			res = true;
-		}
-
-		// If this state can possibly be advanced, store it in the states list.
-		if (!node->children.empty()) {
-			lookups.emplace_back(*this);
-		}
-		return res;
+	// If the matched token is a non-primary token -- mark the match in the
+	// TokenizedData list
+	if (!descr.primary) {
+		data.mark(id, data.size() - len + 1, len);
 	}
-};
 }
 
 /* Class Tokenizer */
 
-Tokenizer::Tokenizer() : nextTokenId(0) {}
+Tokenizer::Tokenizer(Engine engine)
+    : nextTokenId(0), engine(engine), maxDataSize(0)
+{
+}
+
+void Tokenizer::updateTokenStart()
+{
+	tokenStart.clear();
+	for (const auto &child : trie.getRoot()->children) {
+		tokenStart.add(child.first);
+	}
+}
 
-template <bool tRead>
+template <Tokenizer::Engine tEngine, bool tRead>
 bool Tokenizer::next(CharReader &reader, Token &token,
                      TokenizedData &data) const
 {
@@ -172,69 +161,172 @@ bool Tokenizer::next(CharReader &reader, Token &token,
 		reader.resetPeek();
 	}
 
-	// Prepare the lookups in the token trie
-	const TokenTrie::Node *root = trie.getRoot();
+	// Prepare the lookups in the token trie, reuse the scratch buffers
+	const bool ahoCorasick = tEngine == Engine::AHO_CORASICK;
+	const TokenTrie::Table &table = trie.getTable();
+	const TokenTrie::Automaton *automaton = nullptr;
+	TokenTrie::Automaton::State state = TokenTrie::Table::ROOT;
+	size_t recentMask = 0;
 	TokenMatch bestMatch;
-	std::vector<TokenLookup> lookups;
-	std::vector<TokenLookup> nextLookups;
+	lookups.clear();
+	nextLookups.clear();
+	if (ahoCorasick) {
+		automaton = &trie.getAutomaton();
+		size_t recentSize = 1;
+		while (recentSize <= automaton->maxDepth) {
+			recentSize *= 2;
+		}
+		if (recentChars.size() < recentSize) {
+			recentChars.resize(recentSize);
+		}
+		recentMask = recentChars.size() - 1;
+	}
 
-	// Peek characters from the reader and try to advance the current token tree
-	// cursor
-	char c;
+	// Peek spans of characters from the reader and try to advance the current
+	// token tree cursor with each character
+	const char *span;
+	size_t spanSize;
+	bool done = false;
 	const size_t initialDataSize = data.size();
 	size_t charStart = reader.getPeekOffset();
 	const SourceId sourceId = reader.getSourceId();
-	while (reader.peek(c)) {
-		const size_t charEnd = reader.getPeekOffset();
-		const size_t dataStartOffset = data.size();
-
-		// If we do not have a match yet, start a new lookup from the root
-		if (!bestMatch.hasMatch() || !bestMatch.primary) {
-			lookups.emplace_back(root, charStart, dataStartOffset);
-		}
-
-		// Try to advance all other lookups with the new character
-		TokenMatch match;
-		for (TokenLookup &lookup : lookups) {
-			// Continue if the current lookup
-			if (!lookup.advance(c, nextLookups, match, tokens, charEnd,
-			                    sourceId)) {
-				continue;
+	while (!done && (spanSize = reader.peekSpan(span)) > 0) {
+		for (size_t i = 0; i < spanSize; i++) {
+			// As long as no token lookup is in progress, characters which
+			// cannot start a token are directly appended to the data. The last
+			// character of the span is always processed below.
+			if (lookups.empty() && state == TokenTrie::Table::ROOT &&
+			    !bestMatch.hasMatch()) {
+				size_t n = tokenStart.find(span + i, spanSize - i - 1);
+				if (maxDataSize > 0) {
+					const size_t size = data.size();
+					n = std::min(n, size + 1 < maxDataSize
+					                    ? maxDataSize - size - 1
+					                    : size_t(0));
+				}
+				data.appendSpan(span + i, n, charStart);
+				charStart += n;
+				i += n;
 			}
 
-			// Replace the best match with longest token
-			if (match.size() > bestMatch.size()) {
-				bestMatch = match;
+			// Characters in the span correspond to single bytes, except for
+			// substituted linebreak sequences which form a span of their own.
+			// Advance the peek cursor past the span once its last character is
+			// reached to fetch the end offset.
+			const char c = span[i];
+			size_t charEnd = charStart + 1;
+			if (i + 1 == spanSize) {
+				reader.skipPeek(spanSize);
+				charEnd = reader.getPeekOffset();
 			}
-
-			// If the matched token is a non-primary token -- mark the match in
-			// the TokenizedData list
-			if (!match.primary) {
-				data.mark(match.token.id, data.size() - match.size() + 1,
-				          match.size());
+			const size_t dataStartOffset = data.size();
+
+			if (ahoCorasick) {
+				// Remember where this character starts and whether a lookup
+				// may start here (see below)
+				recentChars[dataStartOffset & recentMask] =
+				    CharInfo{charStart,
+				             !bestMatch.hasMatch() || !bestMatch.primary};
+
+				// Advance the automaton and visit all tokens ending at this
+				// character, longest first. Ignore tokens starting at
+				// characters at which the lookup engine would not have
+				// started a lookup.
+				state = automaton->next(state, c);
+				TokenTrie::Automaton::State s = automaton->firstMatch(state);
+				for (; s != TokenTrie::Table::NONE;
+				     s = automaton->matchLinks[s]) {
+					const size_t start =
+					    dataStartOffset + 1 - automaton->depths[s];
+					const CharInfo &info = recentChars[start & recentMask];
+					if (info.lookupAllowed) {
+						const TokenId id = automaton->ids[s];
+						recordMatch(bestMatch, data, id, tokens[id], info.start,
+						            charEnd, start);
+					}
+				}
+
+				// Reset the automaton if none of the token prefixes ending at
+				// this character can be continued
+				s = automaton->firstAdvanceable(state);
+				for (; s != TokenTrie::Table::NONE;
+				     s = automaton->advanceLinks[s]) {
+					const size_t start =
+					    dataStartOffset + 1 - automaton->depths[s];
+					if (recentChars[start & recentMask].lookupAllowed) {
+						break;
+					}
+				}
+				if (s == TokenTrie::Table::NONE) {
+					state = TokenTrie::Table::ROOT;
+				}
+			} else {
+				// If we do not have a match yet, start a new lookup from the
+				// root
+				if (!bestMatch.hasMatch() || !bestMatch.primary) {
+					lookups.emplace_back(TokenTrie::Table::ROOT, charStart,
+					                     dataStartOffset);
+				}
+
+				// Try to advance all other lookups with the new character
+				for (const TokenLookup &lookup : lookups) {
+					// Continue if the current lookup cannot be advanced
+					const TokenTrie::Table::State next =
+					    table.next(lookup.state, c);
+					if (next == TokenTrie::Table::NONE) {
+						continue;
+					}
+
+					// If this state can possibly be advanced, store it in the
+					// list of lookups for the next character
+					if (table.canAdvance(next)) {
+						nextLookups.emplace_back(next, lookup.start,
+						                         lookup.dataStartOffset);
+					}
+
+					// Check whether the new state represents a complete token
+					const TokenId id = table.id(next);
+					if (id == Tokens::Empty) {
+						continue;
+					}
+					recordMatch(bestMatch, data, id, tokens[id], lookup.start,
+					            charEnd, lookup.dataStartOffset);
+				}
 			}
-		}
 
-		// If a token has been found and the token is a primary token, check
-		// whether we have to abort, otherwise if we have a non-primary match,
-		// reset it once it can no longer be advanced
-		if (bestMatch.hasMatch() && nextLookups.empty()) {
-			if (bestMatch.primary) {
-				break;
-			} else {
-				bestMatch = TokenMatch{};
+			// If a token has been found and the token is a primary token,
+			// check whether we have to abort, otherwise if we have a
+			// non-primary match, reset it once it can no longer be advanced
+			if (bestMatch.hasMatch() && nextLookups.empty() &&
+			    state == TokenTrie::Table::ROOT) {
+				if (bestMatch.primary) {
+					done = true;
+					break;
+				} else {
+					bestMatch = TokenMatch{};
+				}
 			}
-		}
 
-		// Record all incomming characters
-		data.append(c, charStart, charEnd);
+			// Record all incomming characters
+			data.append(c, charStart, charEnd);
+
+			// Swap the lookups and the nextLookups list, keep the capacity of
+			// both buffers
+			std::swap(lookups, nextLookups);
+			nextLookups.clear();
 
-		// Swap the lookups and the nextLookups list
-		lookups = std::move(nextLookups);
-		nextLookups.clear();
+			// Advance the offset
+			charStart = charEnd;
 
-		// Advance the offset
-		charStart = charEnd;
+			// End the data token if the data limit is reached and no token
+			// can start within the data read so far
+			if (maxDataSize > 0 && data.size() >= maxDataSize &&
+			    lookups.empty() && state == TokenTrie::Table::ROOT &&
+			    !bestMatch.hasMatch() && !(c & 0x80)) {
+				done = true;
+				break;
+			}
+		}
 	}
 
 	// If we found data, emit a corresponding data token
@@ -248,45 +340,58 @@ bool Tokenizer::next(CharReader &reader, Token &token,
 		}
 
 		// Create a token containing the data location
-		bestMatch.token = Token{data.getLocation()};
-	} else if (bestMatch.hasMatch() && bestMatch.primary &&
-	           bestMatch.dataStartOffset == initialDataSize) {
-		data.trim(initialDataSize);
+		const SourceLocation location = data.getLocation();
+		token.id = Tokens::Data;
+		token.content.clear();
+		token.location = location;
+	} else if (bestMatch.hasMatch()) {
+		if (bestMatch.primary && bestMatch.dataStartOffset == initialDataSize) {
+			data.trim(initialDataSize);
+		}
+
+		// Write the matched token, reuse the memory of the given token
+		// content string
+		token.id = bestMatch.id;
+		token.content.assign(tokens[bestMatch.id].string);
+		token.location =
+		    SourceLocation(sourceId, bestMatch.start, bestMatch.end);
+	} else {
+		token.id = Tokens::Empty;
+		token.content.clear();
+		token.location = SourceLocation{};
+		return false;
 	}
 
 	// Move the read/peek cursor to the end of the token, abort if an error
 	// happens while doing so
-	if (bestMatch.hasMatch()) {
-		// Make sure we have a valid location
-		if (bestMatch.token.location.getEnd() == InvalidSourceOffset) {
-			throw OusiaException{"Token end position offset out of range"};
-		}
-
-		// Seek to the end of the current token
-		const size_t end = bestMatch.token.location.getEnd();
-		if (tRead) {
-			reader.seek(end);
-		} else {
-			reader.seekPeekCursor(end);
-		}
-
-		token = bestMatch.token;
+	if (token.location.getEnd() == InvalidSourceOffset) {
+		throw OusiaException{"Token end position offset out of range"};
+	}
+	const size_t end = token.location.getEnd();
+	if (tRead) {
+		reader.seek(end);
 	} else {
-		token = Token{};
+		reader.seekPeekCursor(end);
 	}
-	return bestMatch.hasMatch();
+	return true;
 }
 
 bool Tokenizer::read(CharReader &reader, Token &token,
                      TokenizedData &data) const
 {
-	return next<true>(reader, token, data);
+	if (engine == Engine::AHO_CORASICK) {
+		return next<Engine::AHO_CORASICK, true>(reader, token, data);
+	}
+	return next<Engine::LOOKUPS, true>(reader, token, data);
 }
 
 bool Tokenizer::peek(CharReader &reader, Token &token,
                      TokenizedData &data) const
 {
-	return next<false>(reader, token, data);
+	if (engine == Engine::AHO_CORASICK) {
+		return next<Engine::AHO_CORASICK, false>(reader, token, data);
+	}
+	return next<Engine::LOOKUPS, false>(reader, token, data);
 }
 
 TokenId Tokenizer::registerToken(const std::string &token, bool primary)
@@ -324,6 +429,7 @@ TokenId Tokenizer::registerToken(const std::string &token, bool primary)
 		nextTokenId = type;
 		return Tokens::Empty;
 	}
+	updateTokenStart();
 	return type;
 }
 
@@ -333,6 +439,7 @@ bool Tokenizer::unregisterToken(TokenId id)
 	if (id < tokens.size() && trie.unregisterToken(tokens[id].string)) {
 		tokens[id] = TokenDescriptor();
 		nextTokenId = id;
+		updateTokenStart();
 		return true;
 	}
 	return false;
@@ -350,9 +457,12 @@ const Tokenizer::TokenDescriptor &Tokenizer::lookupToken(TokenId id) const
 
 /* Explicitly instantiate all possible instantiations of the "next" member
    function */
-template bool Tokenizer::next<false>(CharReader &, Token &,
-                                     TokenizedData &) const;
-template bool Tokenizer::next<true>(CharReader &, Token &,
-                                    TokenizedData &) const;
+template bool Tokenizer::next<Tokenizer::Engine::LOOKUPS, false>(
+    CharReader &, Token &, TokenizedData &) const;
+template bool Tokenizer::next<Tokenizer::Engine::LOOKUPS, true>(
+    CharReader &, Token &, TokenizedData &) const;
+template bool Tokenizer::next<Tokenizer::Engine::AHO_CORASICK, false>(
+    CharReader &, Token &, TokenizedData &) const;
+template bool Tokenizer::next<Tokenizer::Engine::AHO_CORASICK, true>(
+    CharReader &, Token &, TokenizedData &) const;
 }
-
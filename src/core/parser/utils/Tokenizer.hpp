@@ -32,6 +32,7 @@
 #include <string>
 #include <vector>
 
+#include <core/common/CharScanner.hpp>
 #include <core/common/Location.hpp>
 #include <core/common/Token.hpp>
 
@@ -54,6 +55,24 @@ class TokenizedData;
  */
 class Tokenizer {
 public:
+	/**
+	 * Enum used to select the algorithm used to find tokens in the input.
+	 * Both engines produce the same tokens.
+	 */
+	enum class Engine {
+		/**
+		 * Starts a new lookup in the token trie at each character and advances
+		 * all running lookups in parallel.
+		 */
+		LOOKUPS,
+
+		/**
+		 * Uses an Aho-Corasick automaton, which tracks all running lookups in
+		 * a single state. Scales better with many overlapping tokens.
+		 */
+		AHO_CORASICK
+	};
+
 	/**
 	 * Internally used structure describing a registered token.
 	 */
@@ -108,11 +127,102 @@ private:
 	 */
 	size_t nextTokenId;
 
+	/**
+	 * Set containing the first character of each registered token. Used to
+	 * quickly skip over text which cannot contain a token.
+	 */
+	CharScanner tokenStart;
+
+	/**
+	 * Internally used structure representing a thread in a running token
+	 * lookup.
+	 */
+	struct TokenLookup {
+		/**
+		 * Current state within the compiled token trie.
+		 */
+		TokenTrie::Table::State state;
+
+		/**
+		 * Start offset within the source file.
+		 */
+		size_t start;
+
+		/**
+		 * Position at which this token starts in the TokenizedData instance.
+		 */
+		size_t dataStartOffset;
+
+		/**
+		 * Constructor of the TokenLookup structure.
+		 *
+		 * @param state is the current state.
+		 * @param start is the start position in the source file.
+		 * @param dataStartOffset is the current length of the TokenizedData
+		 * buffer.
+		 */
+		TokenLookup(TokenTrie::Table::State state, size_t start,
+		            size_t dataStartOffset)
+		    : state(state), start(start), dataStartOffset(dataStartOffset)
+		{
+		}
+	};
+
+	/**
+	 * Scratch buffers holding the currently running token lookups and the
+	 * lookups which will be continued with the next character. Kept as
+	 * members so their capacity is reused between calls to next(), which
+	 * means that a Tokenizer instance must not be used from multiple threads
+	 * at once.
+	 */
+	mutable std::vector<TokenLookup> lookups, nextLookups;
+
+	/**
+	 * Internally used structure storing information about an input character
+	 * which may be the start of a token. Used by the Aho-Corasick engine.
+	 */
+	struct CharInfo {
+		/**
+		 * Start offset of the character within the source file.
+		 */
+		size_t start;
+
+		/**
+		 * Set to true if a token lookup may start at this character.
+		 */
+		bool lookupAllowed;
+	};
+
+	/**
+	 * Ring buffer storing the CharInfo of the most recent characters, indexed
+	 * by their position in the TokenizedData instance. Used by the
+	 * Aho-Corasick engine, its size is a power of two larger than the longest
+	 * token.
+	 */
+	mutable std::vector<CharInfo> recentChars;
+
+	/**
+	 * Engine used to find the tokens.
+	 */
+	Engine engine;
+
+	/**
+	 * Number of characters in the TokenizedData instance at which a data
+	 * token is ended, zero if data tokens are unbounded.
+	 */
+	size_t maxDataSize;
+
+	/**
+	 * Rebuilds the tokenStart set from the token trie.
+	 */
+	void updateTokenStart();
+
 	/**
 	 * Templated function used internally to read the current token. The
 	 * function is templated in order to force optimized code generation for
-	 * both reading and peeking.
+	 * both reading and peeking with both engines.
 	 *
+	 * @tparam tEngine is the engine that should be used to find the tokens.
 	 * @tparam read specifies whether the method should read the token or just
 	 * peek.
 	 * @param reader is the CharReader instance from which the data should be
@@ -123,14 +233,43 @@ private:
 	 * token information should be appended.
 	 * @return false if the end of the stream has been reached, true otherwise.
 	 */
-	template <bool read>
+	template <Engine tEngine, bool read>
 	bool next(CharReader &reader, Token &token, TokenizedData &data) const;
 
 public:
 	/**
 	 * Constructor of the Tokenizer class.
+	 *
+	 * @param engine is the engine that should be used to find the tokens.
+	 */
+	Tokenizer(Engine engine = Engine::LOOKUPS);
+
+	/**
+	 * Returns the engine used to find the tokens.
+	 *
+	 * @return the engine passed to the constructor.
+	 */
+	Engine getEngine() const { return engine; }
+
+	/**
+	 * Limits the amount of data accumulated in the TokenizedData instance.
+	 * Once the TokenizedData holds at least the given number of characters
+	 * and no token lookup is in progress, the current data token is ended
+	 * even though no token follows. Data tokens are only ended after ASCII
+	 * characters, so UTF-8 sequences are never split.
+	 *
+	 * @param size is the number of characters at which data tokens are
+	 * ended. Zero (the default) disables the limit.
+	 */
+	void setMaxDataSize(size_t size) { maxDataSize = size; }
+
+	/**
+	 * Returns the limit set by setMaxDataSize().
+	 *
+	 * @return the number of characters at which data tokens are ended, zero if
+	 * data tokens are unbounded.
 	 */
-	Tokenizer();
+	size_t getMaxDataSize() const { return maxDataSize; }
 
 	/**
 	 * Registers the given string as a token. Returns a unique identifier
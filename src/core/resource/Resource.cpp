@@ -70,6 +70,11 @@ std::unique_ptr<std::istream> Resource::stream() const
 	return locator->stream(location);
 }
 
+std::shared_ptr<Buffer> Resource::buffer() const
+{
+	return locator->buffer(location);
+}
+
 std::string Resource::getResourceTypeName(ResourceType resourceType)
 {
 	auto it = RESOURCE_TYPE_NAME_MAP.find(resourceType);
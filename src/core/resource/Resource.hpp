@@ -36,6 +36,7 @@
 namespace ousia {
 
 // Forward declaration
+class Buffer;
 class ResourceLocator;
 
 /**
@@ -142,6 +143,15 @@ public:
 	 */
 	std::unique_ptr<std::istream> stream() const;
 
+	/**
+	 * This calls the 'buffer' method of the underlying ResourceLocator that
+	 * found this location and returns a Buffer providing the data of the
+	 * Resource at this location.
+	 *
+	 * @return a Buffer containing the data of the Resource at this location.
+	 */
+	std::shared_ptr<Buffer> buffer() const;
+
 	/**
 	 * Returns whether this resource is valid or not.
 	 *
@@ -0,0 +1,211 @@
+/*
+    Ousía
+    Copyright (C) 2014, 2015  Benjamin Paaßen, Andreas Stöckel
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cstring>
+
+#include <core/model/BinaryGraph.hpp>
+
+#include "ResourceCache.hpp"
+
+namespace ousia {
+
+/* Helper functions for the entry format */
+
+/**
+ * Appends a 64 bit little endian integer to the given string.
+ */
+static void writeInt(std::string &out, uint64_t v)
+{
+	for (int i = 0; i < 8; i++) {
+		out.push_back(char((v >> (i * 8)) & 0xFF));
+	}
+}
+
+/**
+ * Appends a string prefixed with its length to the given string.
+ */
+static void writeString(std::string &out, const std::string &s)
+{
+	writeInt(out, s.size());
+	out.append(s);
+}
+
+/**
+ * Reads a 64 bit little endian integer at the given position.
+ */
+static bool readInt(const std::string &data, size_t &pos, uint64_t &v)
+{
+	if (data.size() - pos < 8) {
+		return false;
+	}
+	v = 0;
+	for (int i = 0; i < 8; i++) {
+		v |= uint64_t(uint8_t(data[pos++])) << (i * 8);
+	}
+	return true;
+}
+
+/**
+ * Reads a string prefixed with its length at the given position.
+ */
+static bool readString(const std::string &data, size_t &pos, std::string &s)
+{
+	uint64_t size;
+	if (!readInt(data, pos, size) || data.size() - pos < size) {
+		return false;
+	}
+	s = data.substr(pos, size);
+	pos += size;
+	return true;
+}
+
+/* Class ResourceCache */
+
+const uint32_t ResourceCache::VERSION = 2;
+
+const uint32_t ResourceCache::PARSER_VERSION = 1;
+
+/**
+ * Magic number at the beginning of each entry.
+ */
+static const char ENTRY_MAGIC[8] = {'O', 'U', 'S', 'I', 'A', 'R', 'C', '\0'};
+
+uint64_t ResourceCache::hash(const char *data, size_t size, uint64_t hash)
+{
+	for (size_t i = 0; i < size; i++) {
+		hash ^= uint8_t(data[i]);
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+std::string ResourceCache::key(const std::string &location,
+                               const std::string &mimetype)
+{
+	uint64_t h = hash(location.data(), location.size());
+	h = hash(mimetype.data(), mimetype.size() + 1, h);
+
+	static const char *digits = "0123456789abcdef";
+	std::string res;
+	for (int i = 15; i >= 0; i--) {
+		res.push_back(digits[(h >> (i * 4)) & 0xF]);
+	}
+	return res;
+}
+
+bool ResourceCache::load(const std::string &location,
+                         const std::string &mimetype, uint64_t contentHash,
+                         Entry &entry)
+{
+	std::string data;
+	if (!doLoad(key(location, mimetype), data)) {
+		return false;
+	}
+
+	// Check the header, the entry must have been written with the same
+	// versions and for the same resource and content
+	size_t pos = sizeof(ENTRY_MAGIC);
+	uint64_t version, graphVersion, storedParserVersion, dependencyCount;
+	std::string storedLocation, storedMimetype;
+	if (data.size() < pos ||
+	    memcmp(data.data(), ENTRY_MAGIC, sizeof(ENTRY_MAGIC)) != 0 ||
+	    !readInt(data, pos, version) || version != VERSION ||
+	    !readInt(data, pos, graphVersion) ||
+	    graphVersion != BinaryGraph::VERSION ||
+	    !readInt(data, pos, storedParserVersion) ||
+	    storedParserVersion != parserVersion ||
+	    !readString(data, pos, storedLocation) || storedLocation != location ||
+	    !readString(data, pos, storedMimetype) || storedMimetype != mimetype ||
+	    !readInt(data, pos, entry.contentHash) ||
+	    entry.contentHash != contentHash ||
+	    !readInt(data, pos, dependencyCount)) {
+		return false;
+	}
+
+	// Read the dependencies and the graph
+	entry.dependencies.clear();
+	for (uint64_t i = 0; i < dependencyCount; i++) {
+		Dependency dependency;
+		uint64_t typeCount;
+		if (!readString(data, pos, dependency.path) ||
+		    !readString(data, pos, dependency.mimetype) ||
+		    !readString(data, pos, dependency.rel) ||
+		    !readInt(data, pos, typeCount)) {
+			return false;
+		}
+		for (uint64_t j = 0; j < typeCount; j++) {
+			std::string type;
+			if (!readString(data, pos, type)) {
+				return false;
+			}
+			dependency.supportedTypes.emplace_back(std::move(type));
+		}
+		if (!readInt(data, pos, dependency.graphHash)) {
+			return false;
+		}
+		entry.dependencies.emplace_back(std::move(dependency));
+	}
+	return readString(data, pos, entry.graph) && pos == data.size();
+}
+
+void ResourceCache::store(const std::string &location,
+                          const std::string &mimetype, const Entry &entry)
+{
+	std::string data{ENTRY_MAGIC, sizeof(ENTRY_MAGIC)};
+	writeInt(data, VERSION);
+	writeInt(data, BinaryGraph::VERSION);
+	writeInt(data, parserVersion);
+	writeString(data, location);
+	writeString(data, mimetype);
+	writeInt(data, entry.contentHash);
+	writeInt(data, entry.dependencies.size());
+	for (const Dependency &dependency : entry.dependencies) {
+		writeString(data, dependency.path);
+		writeString(data, dependency.mimetype);
+		writeString(data, dependency.rel);
+		writeInt(data, dependency.supportedTypes.size());
+		for (const std::string &type : dependency.supportedTypes) {
+			writeString(data, type);
+		}
+		writeInt(data, dependency.graphHash);
+	}
+	writeString(data, entry.graph);
+
+	doStore(key(location, mimetype), data);
+	stores++;
+}
+
+/* Class StaticResourceCache */
+
+bool StaticResourceCache::doLoad(const std::string &key, std::string &data)
+{
+	auto it = entries.find(key);
+	if (it == entries.end()) {
+		return false;
+	}
+	data = it->second;
+	return true;
+}
+
+void StaticResourceCache::doStore(const std::string &key,
+                                  const std::string &data)
+{
+	entries[key] = data;
+}
+}
+
@@ -0,0 +1,265 @@
+/*
+    Ousía
+    Copyright (C) 2014, 2015  Benjamin Paaßen, Andreas Stöckel
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file ResourceCache.hpp
+ *
+ * Contains the ResourceCache class which stores the binary graph of parsed
+ * ontologies and typesystems, so they do not have to be parsed again in a
+ * later run.
+ *
+ * @author Andreas Stöckel (astoecke@techfak.uni-bielefeld.de)
+ */
+
+#ifndef _OUSIA_RESOURCE_CACHE_HPP_
+#define _OUSIA_RESOURCE_CACHE_HPP_
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ousia {
+
+/**
+ * The ResourceCache class is the abstract base class of the caches used by
+ * the ResourceManager to store parsed resources. An entry is stored under the
+ * location and mimetype of the resource and is only used if the hash of the
+ * resource content, the cache version and the imported resources still match.
+ * Derived classes only have to implement storing and loading the raw entry
+ * data.
+ */
+class ResourceCache {
+public:
+	/**
+	 * Version of the cache entry format. Must be incremented whenever the
+	 * layout of the entries written by store() changes. Changes to the
+	 * binary graph format are covered by BinaryGraph::VERSION.
+	 */
+	static const uint32_t VERSION;
+
+	/**
+	 * Version of the code producing the cached graphs. Must be incremented
+	 * whenever the OSML or OSXML parsers, the handlers in core/parser/stack or
+	 * the model classes change in a way that affects the parsed graph.
+	 * Entries written with another parser version are ignored. Since the
+	 * version is maintained by hand, the command line interface only uses a
+	 * cache if a cache directory is given explicitly.
+	 */
+	static const uint32_t PARSER_VERSION;
+
+	/**
+	 * Describes a resource imported by the cached resource. The imports are
+	 * performed again before the cached graph is read.
+	 */
+	struct Dependency {
+		/**
+		 * Path given in the import command.
+		 */
+		std::string path;
+
+		/**
+		 * Mimetype given in the import command, may be empty.
+		 */
+		std::string mimetype;
+
+		/**
+		 * Relation given in the import command, may be empty.
+		 */
+		std::string rel;
+
+		/**
+		 * Names of the types the importing node can reference.
+		 */
+		std::vector<std::string> supportedTypes;
+
+		/**
+		 * Hash of the binary graph of the imported node at the time the
+		 * cached resource was parsed.
+		 */
+		uint64_t graphHash;
+	};
+
+	/**
+	 * Entry describing a cached resource.
+	 */
+	struct Entry {
+		/**
+		 * Hash of the resource content.
+		 */
+		uint64_t contentHash = 0;
+
+		/**
+		 * Resources imported by the cached resource, in the order of the
+		 * import commands.
+		 */
+		std::vector<Dependency> dependencies;
+
+		/**
+		 * Binary graph of the parsed node, see BinaryGraphWriter.
+		 */
+		std::string graph;
+	};
+
+private:
+	/**
+	 * Parser version written to and expected in the entries.
+	 */
+	uint32_t parserVersion;
+
+	/**
+	 * Number of entries that were successfully loaded.
+	 */
+	size_t hits = 0;
+
+	/**
+	 * Number of entries that were stored.
+	 */
+	size_t stores = 0;
+
+protected:
+	/**
+	 * Loads the raw data stored under the given key.
+	 *
+	 * @param key is the key of the entry.
+	 * @param data is the string the data should be written to.
+	 * @return true if an entry with the given key exists.
+	 */
+	virtual bool doLoad(const std::string &key, std::string &data) = 0;
+
+	/**
+	 * Stores the given raw data under the given key, replacing any existing
+	 * entry.
+	 *
+	 * @param key is the key of the entry.
+	 * @param data is the data that should be stored.
+	 */
+	virtual void doStore(const std::string &key, const std::string &data) = 0;
+
+public:
+	/**
+	 * Constructor of the ResourceCache class.
+	 *
+	 * @param parserVersion is the parser version written to and expected in
+	 * the entries. Only differs from PARSER_VERSION in tests.
+	 */
+	ResourceCache(uint32_t parserVersion = PARSER_VERSION)
+	    : parserVersion(parserVersion)
+	{
+	}
+
+	/**
+	 * Virtual destructor of the ResourceCache class.
+	 */
+	virtual ~ResourceCache() {}
+
+	/**
+	 * Computes the 64 bit FNV-1a hash of the given data.
+	 *
+	 * @param data is the data that should be hashed.
+	 * @param size is the size of the data in bytes.
+	 * @param hash is the hash of the preceding data, allowing to hash data
+	 * that is not contiguous in memory.
+	 * @return the hash of the data.
+	 */
+	static uint64_t hash(const char *data, size_t size,
+	                     uint64_t hash = 14695981039346656037ULL);
+
+	/**
+	 * Returns the key of the entry for the given resource.
+	 *
+	 * @param location is the canonical location of the resource.
+	 * @param mimetype is the mimetype the resource is parsed with.
+	 * @return a key consisting of hexadecimal digits, which can be used as
+	 * file name.
+	 */
+	static std::string key(const std::string &location,
+	                       const std::string &mimetype);
+
+	/**
+	 * Loads the entry for the given resource.
+	 *
+	 * @param location is the canonical location of the resource.
+	 * @param mimetype is the mimetype the resource is parsed with.
+	 * @param contentHash is the hash of the current resource content.
+	 * @param entry is the entry the data should be written to.
+	 * @return true if a valid entry with the given content hash, written with
+	 * the same parser version, exists.
+	 */
+	bool load(const std::string &location, const std::string &mimetype,
+	          uint64_t contentHash, Entry &entry);
+
+	/**
+	 * Stores the given entry.
+	 *
+	 * @param location is the canonical location of the resource.
+	 * @param mimetype is the mimetype the resource was parsed with.
+	 * @param entry is the entry that should be stored.
+	 */
+	void store(const std::string &location, const std::string &mimetype,
+	           const Entry &entry);
+
+	/**
+	 * Returns the number of entries that were used instead of parsing the
+	 * resource. Counted by the ResourceManager.
+	 *
+	 * @return the number of cache hits.
+	 */
+	size_t getHits() const { return hits; }
+
+	/**
+	 * Increments the number of cache hits.
+	 */
+	void hit() { hits++; }
+
+	/**
+	 * Returns the number of entries that were stored.
+	 *
+	 * @return the number of stored entries.
+	 */
+	size_t getStores() const { return stores; }
+};
+
+/**
+ * The StaticResourceCache class keeps all entries in memory. It is mainly
+ * used for testing.
+ */
+class StaticResourceCache : public ResourceCache {
+private:
+	/**
+	 * Map containing the raw entry data.
+	 */
+	std::unordered_map<std::string, std::string> entries;
+
+protected:
+	bool doLoad(const std::string &key, std::string &data) override;
+
+	void doStore(const std::string &key, const std::string &data) override;
+
+public:
+	/**
+	 * Returns the number of entries in the cache.
+	 *
+	 * @return the number of entries.
+	 */
+	size_t size() const { return entries.size(); }
+};
+}
+
+#endif /* _OUSIA_RESOURCE_CACHE_HPP_ */
+
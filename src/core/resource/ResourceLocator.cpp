@@ -18,6 +18,8 @@
 
 #include <sstream>
 
+#include <core/common/CharReader.hpp>
+
 #include "Resource.hpp"
 #include "ResourceLocator.hpp"
 
@@ -90,6 +92,19 @@ std::unique_ptr<std::istream> ResourceLocator::stream(
 	return doStream(location);
 }
 
+std::shared_ptr<Buffer> ResourceLocator::buffer(
+    const std::string &location) const
+{
+	return doBuffer(location);
+}
+
+std::shared_ptr<Buffer> ResourceLocator::doBuffer(
+    const std::string &location) const
+{
+	return std::make_shared<Buffer>(
+	    std::shared_ptr<std::istream>{doStream(location)});
+}
+
 std::vector<std::string> ResourceLocator::doAutocomplete(
     const std::string &path, const ResourceType type,
     const std::string &relativeTo) const
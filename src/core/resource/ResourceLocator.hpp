@@ -92,6 +92,17 @@ protected:
 	virtual std::unique_ptr<std::istream> doStream(
 	    const std::string &location) const = 0;
 
+	/**
+	 * This method returns a Buffer providing the data of the resource at the
+	 * given location. The default implementation wraps the stream returned by
+	 * doStream(). Locators which are able to provide direct access to the
+	 * resource data (e.g. by memory mapping a file) may override this method.
+	 *
+	 * @param location is a found location, most likely from a Location.
+	 * @return a Buffer containing the data of the Resource at this location.
+	 */
+	virtual std::shared_ptr<Buffer> doBuffer(const std::string &location) const;
+
 public:
 	/**
 	 * Virtual destructor of the ResourceLocator interface.
@@ -179,6 +190,15 @@ public:
 	 *         streams.
 	 */
 	std::unique_ptr<std::istream> stream(const std::string &location) const;
+
+	/**
+	 * This method returns a Buffer providing the data of the resource at the
+	 * given location.
+	 *
+	 * @param location is a found location, most likely from a Location.
+	 * @return a Buffer containing the data of the Resource at this location.
+	 */
+	std::shared_ptr<Buffer> buffer(const std::string &location) const;
 };
 
 /**
@@ -16,6 +16,8 @@
     along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <algorithm>
+#include <iterator>
 #include <vector>
 
 #include <core/common/CharReader.hpp>
@@ -24,18 +26,80 @@
 #include <core/common/Rtti.hpp>
 #include <core/common/SourceContextReader.hpp>
 #include <core/common/Utils.hpp>
+#include <core/managed/Manager.hpp>
+#include <core/model/BinaryGraph.hpp>
 #include <core/model/Node.hpp>
 #include <core/model/Project.hpp>
+#include <core/model/Typesystem.hpp>
 #include <core/parser/Parser.hpp>
 #include <core/parser/ParserContext.hpp>
 #include <core/parser/ParserScope.hpp>
 #include <core/Registry.hpp>
 
+#include "ResourceCache.hpp"
 #include "ResourceManager.hpp"
 #include "ResourceRequest.hpp"
 
 namespace ousia {
 
+namespace RttiTypes {
+extern const Rtti Ontology;
+extern const Rtti Typesystem;
+}
+
+/**
+ * Types which may be passed as supported types to imports performed by a
+ * cached resource.
+ */
+static const Rtti *CACHEABLE_REFERENCE_TYPES[] = {&RttiTypes::Ontology,
+                                                  &RttiTypes::Typesystem};
+
+/**
+ * Computes the hash of the data in the given Buffer without consuming it.
+ *
+ * @param buffer is the buffer whose data should be hashed.
+ * @return the hash of the data.
+ */
+static uint64_t hashBuffer(Buffer &buffer)
+{
+	uint64_t hash = ResourceCache::hash(nullptr, 0);
+	Buffer::CursorId cursor = buffer.createCursor();
+	const char *data;
+	size_t size;
+	while ((size = buffer.span(cursor, data)) > 0) {
+		hash = ResourceCache::hash(data, size, hash);
+		buffer.moveCursor(cursor, size);
+	}
+	buffer.deleteCursor(cursor);
+	return hash;
+}
+
+/**
+ * GuardedLogger which additionally keeps track of whether warnings or errors
+ * were logged.
+ */
+class CountingGuardedLogger : public GuardedLogger {
+private:
+	size_t count = 0;
+
+protected:
+	bool filterMessage(const Message &msg) override
+	{
+		if (msg.severity >= Severity::WARNING) {
+			count++;
+		}
+		return GuardedLogger::filterMessage(msg);
+	}
+
+public:
+	using GuardedLogger::GuardedLogger;
+
+	/**
+	 * Returns true if no warnings or errors were logged.
+	 */
+	bool isClean() const { return count == 0; }
+};
+
 /* Class ResourceManager */
 
 SourceId ResourceManager::allocateSourceId(const Resource &resource)
@@ -70,6 +134,176 @@ void ResourceManager::purgeResource(SourceId sourceId)
 	contextReaders.erase(sourceId);
 }
 
+void ResourceManager::recordImport(ParserContext &ctx, const std::string &path,
+                                   const std::string &mimetype,
+                                   const std::string &rel,
+                                   const RttiSet &supportedTypes,
+                                   SourceId sourceId, ParseMode mode)
+{
+	// Only record imports performed by a resource that is currently parsed
+	// with the cache enabled
+	auto it = cacheStates.find(ctx.getSourceId());
+	if (it == cacheStates.end() || !currentlyParsing.count(ctx.getSourceId())) {
+		return;
+	}
+	CacheState &state = it->second;
+	if (mode == ParseMode::INCLUDE) {
+		state.cacheable = false;
+		return;
+	}
+
+	ResourceCache::Dependency dependency{path, mimetype, rel, {}, 0};
+	for (const Rtti *type : supportedTypes) {
+		const Rtti **end = std::end(CACHEABLE_REFERENCE_TYPES);
+		if (std::find(std::begin(CACHEABLE_REFERENCE_TYPES), end, type) ==
+		    end) {
+			state.cacheable = false;
+		}
+		dependency.supportedTypes.emplace_back(type->name);
+	}
+	std::sort(dependency.supportedTypes.begin(),
+	          dependency.supportedTypes.end());
+	state.imports.emplace_back(std::move(dependency));
+	state.dependencies.push_back(sourceId);
+}
+
+bool ResourceManager::cacheDependencies(ParserContext &ctx,
+                                        const CacheState &state,
+                                        std::vector<Rooted<Node>> &dependencies)
+{
+	dependencies.clear();
+	dependencies.emplace_back(ctx.getProject()->getSystemTypesystem());
+	for (SourceId dependency : state.dependencies) {
+		Rooted<Node> node = getNode(ctx.getManager(), dependency);
+		if (node == nullptr) {
+			return false;
+		}
+		dependencies.emplace_back(node);
+	}
+	return true;
+}
+
+bool ResourceManager::currentGraphHash(ParserContext &ctx, SourceId sourceId,
+                                       uint64_t &hash)
+{
+	auto it = cacheStates.find(sourceId);
+	if (it == cacheStates.end() || !it->second.hashed) {
+		return false;
+	}
+	std::vector<Rooted<Node>> dependencies;
+	Rooted<Node> node = getNode(ctx.getManager(), sourceId);
+	if (node == nullptr || !cacheDependencies(ctx, it->second, dependencies)) {
+		return false;
+	}
+	std::string graph;
+	if (!BinaryGraphWriter(dependencies, sourceId).write(node, graph)) {
+		return false;
+	}
+	hash = ResourceCache::hash(graph.data(), graph.size());
+	return true;
+}
+
+Rooted<Node> ResourceManager::loadCached(ParserContext &ctx,
+                                         const ResourceRequest &req,
+                                         SourceId sourceId,
+                                         uint64_t contentHash)
+{
+	const Resource &resource = getResource(sourceId);
+	ResourceCache::Entry entry;
+	if (!cache->load(resource.getLocation(), req.getMimetype(), contentHash,
+	                 entry)) {
+		return nullptr;
+	}
+
+	// Perform the imports of the cached resource again. The imported graphs
+	// must not have changed since the entry was written.
+	ParserScope innerScope;
+	ParserContext childCtx = ctx.clone(innerScope, sourceId);
+	for (const ResourceCache::Dependency &dependency : entry.dependencies) {
+		RttiSet supportedTypes;
+		for (const Rtti *type : CACHEABLE_REFERENCE_TYPES) {
+			if (std::binary_search(dependency.supportedTypes.begin(),
+			                       dependency.supportedTypes.end(),
+			                       std::string(type->name))) {
+				supportedTypes.insert(type);
+			}
+		}
+		uint64_t graphHash;
+		if (import(childCtx, dependency.path, dependency.mimetype,
+		           dependency.rel, supportedTypes) == nullptr ||
+		    !currentGraphHash(ctx, cacheStates[sourceId].dependencies.back(),
+		                      graphHash) ||
+		    graphHash != dependency.graphHash) {
+			return nullptr;
+		}
+	}
+
+	// Read the graph
+	CacheState &state = cacheStates[sourceId];
+	std::vector<Rooted<Node>> dependencies;
+	if (!cacheDependencies(ctx, state, dependencies)) {
+		return nullptr;
+	}
+	Rooted<Node> node;
+	try {
+		node = BinaryGraphReader::read(ctx.getManager(), entry.graph.data(),
+		                               entry.graph.size(), dependencies,
+		                               sourceId);
+	}
+	catch (const LoggableException &) {
+		return nullptr;
+	}
+	Logger nullLogger;
+	if (!node->validate(nullLogger)) {
+		return nullptr;
+	}
+
+	// The graph written by the BinaryGraphWriter is reproduced exactly
+	state.hashed = true;
+	state.graphHash = ResourceCache::hash(entry.graph.data(),
+	                                      entry.graph.size());
+	cache->hit();
+	return node;
+}
+
+void ResourceManager::storeCached(ParserContext &ctx,
+                                  const ResourceRequest &req,
+                                  SourceId sourceId, uint64_t contentHash,
+                                  Handle<Node> node, bool clean)
+{
+	CacheState &state = cacheStates[sourceId];
+	std::vector<Rooted<Node>> dependencies;
+	ResourceCache::Entry entry;
+	if (!cacheDependencies(ctx, state, dependencies) ||
+	    !BinaryGraphWriter(dependencies, sourceId).write(node, entry.graph)) {
+		return;
+	}
+	state.hashed = true;
+	state.graphHash =
+	    ResourceCache::hash(entry.graph.data(), entry.graph.size());
+	if (!clean || !state.cacheable) {
+		return;
+	}
+
+	// Make sure the imported graphs were not modified by this resource (or
+	// by any other resource since they were imported), these modifications
+	// would be lost when loading the cached graph
+	entry.contentHash = contentHash;
+	entry.dependencies = state.imports;
+	for (size_t i = 0; i < state.dependencies.size(); i++) {
+		auto it = cacheStates.find(state.dependencies[i]);
+		uint64_t graphHash;
+		if (it == cacheStates.end() ||
+		    !currentGraphHash(ctx, state.dependencies[i], graphHash) ||
+		    graphHash != it->second.graphHash) {
+			return;
+		}
+		entry.dependencies[i].graphHash = graphHash;
+	}
+	cache->store(getResource(sourceId).getLocation(), req.getMimetype(),
+	             entry);
+}
+
 template <class T>
 class GuardedSetInsertion {
 private:
@@ -118,6 +352,8 @@ ManagedVector<Node> ResourceManager::parse(
 		newResource = true;
 		sourceId = allocateSourceId(resource);
 	}
+	recordImport(ctx, path, mimetype, rel, supportedTypes, sourceId, mode);
+
 	// check for cycles.
 	GuardedSetInsertion<SourceId> cycleDetection{currentlyParsing, sourceId};
 	if (!cycleDetection.isSuccess()) {
@@ -135,37 +371,62 @@ ManagedVector<Node> ResourceManager::parse(
 		// Set the current source id in the logger instance. Note that this
 		// modifies the logger instance -- the GuardedLogger is just used to
 		// make sure the default location is popped from the stack again.
-		GuardedLogger guardedLogger(logger, SourceLocation{sourceId});
+		CountingGuardedLogger guardedLogger(logger, SourceLocation{sourceId});
+
+		// The object graph mostly grows while parsing, suspend the garbage
+		// collector until the file has been processed
+		GcPause gcPause{ctx.getManager()};
 
 		try {
-			// Fetch the input stream and create a char reader
-			std::unique_ptr<std::istream> is = resource.stream();
-			CharReader reader(*is, sourceId);
+			// Fetch the resource data and create a char reader
+			std::shared_ptr<Buffer> buffer = resource.buffer();
+			CharReader reader(buffer, sourceId);
 
 			// Actually parse the input stream, distinguish the IMPORT and the
 			// INCLUDE mode
 			switch (mode) {
 				case ParseMode::IMPORT: {
+					// Try to load ontologies and typesystems from the cache
+					const bool useCache =
+					    cache != nullptr &&
+					    (req.getResourceType() == ResourceType::ONTOLOGY ||
+					     req.getResourceType() == ResourceType::TYPESYSTEM);
+					uint64_t contentHash = 0;
+					if (useCache) {
+						contentHash = hashBuffer(*buffer);
+						cacheStates[sourceId] = CacheState{};
+						Rooted<Node> cached =
+						    loadCached(ctx, req, sourceId, contentHash);
+						if (cached != nullptr) {
+							parsedNodes.push_back(cached);
+							storeNode(sourceId, cached);
+							break;
+						}
+						cacheStates[sourceId] = CacheState{};
+					}
+
 					// Create a new, empty parser scope instance and a new
-					// parser
-					// context with this instance in place
+					// parser context with this instance in place. Messages
+					// are logged via the guarded logger, which tracks whether
+					// the result may be cached.
 					ParserScope innerScope;
-					ParserContext childCtx = ctx.clone(innerScope, sourceId);
+					ParserContext childCtx{registry, *this, innerScope,
+					                       ctx.getProject(), guardedLogger,
+					                       sourceId};
 
 					// Run the parser
 					req.getParser()->parse(reader, childCtx);
 
 					// Make sure the scope has been unwound and perform all
 					// deferred resolutions
-					innerScope.checkUnwound(logger);
-					innerScope.performDeferredResolution(logger);
+					innerScope.checkUnwound(guardedLogger);
+					innerScope.performDeferredResolution(guardedLogger);
 
 					// Fetch the nodes that were parsed by this parser instance
-					// and
-					// validate them
+					// and validate them
 					parsedNodes = innerScope.getTopLevelNodes();
 					for (auto parsedNode : parsedNodes) {
-						parsedNode->validate(logger);
+						parsedNode->validate(guardedLogger);
 					}
 
 					// Make sure the number of elements is exactly one -- we can
@@ -183,6 +444,10 @@ ManagedVector<Node> ResourceManager::parse(
 
 					// Store the parsed node along with the sourceId
 					storeNode(sourceId, parsedNodes[0]);
+					if (useCache) {
+						storeCached(ctx, req, sourceId, contentHash,
+						            parsedNodes[0], guardedLogger.isClean());
+					}
 
 					break;
 				}
@@ -258,8 +523,7 @@ SourceContext ResourceManager::readContext(const SourceLocation &location,
 	const Resource &resource = getResource(location.getSourceId());
 	if (resource.isValid()) {
 		// Fetch a char reader for the resource
-		std::unique_ptr<std::istream> is = resource.stream();
-		CharReader reader{*is, location.getSourceId()};
+		CharReader reader{resource.buffer(), location.getSourceId()};
 
 		// Return the context
 		return contextReaders[location.getSourceId()].readContext(
@@ -31,6 +31,7 @@
 
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include <core/common/Location.hpp>
 #include <core/common/Rtti.hpp>
@@ -38,6 +39,7 @@
 #include <core/model/Node.hpp>
 
 #include "Resource.hpp"
+#include "ResourceCache.hpp"
 
 namespace ousia {
 
@@ -93,6 +95,49 @@ private:
 	 */
 	std::unordered_map<SourceId, SourceContextReader> contextReaders;
 
+	/**
+	 * Describes an ontology or typesystem imported while the cache is enabled.
+	 */
+	struct CacheState {
+		/**
+		 * Set to false if the resource must not be stored in the cache, e.g.
+		 * because it includes other resources.
+		 */
+		bool cacheable = true;
+
+		/**
+		 * Set to true once the graph hash is known.
+		 */
+		bool hashed = false;
+
+		/**
+		 * Hash of the binary graph of the node once it was imported.
+		 */
+		uint64_t graphHash = 0;
+
+		/**
+		 * Imports performed while the resource was parsed.
+		 */
+		std::vector<ResourceCache::Dependency> imports;
+
+		/**
+		 * SourceIds of the imported resources, in the same order.
+		 */
+		std::vector<SourceId> dependencies;
+	};
+
+	/**
+	 * Cache used to store the parsed ontologies and typesystems, nullptr if
+	 * caching is disabled.
+	 */
+	ResourceCache *cache = nullptr;
+
+	/**
+	 * Map between the SourceId of imported ontologies and typesystems and
+	 * their CacheState.
+	 */
+	std::unordered_map<SourceId, CacheState> cacheStates;
+
 	/**
 	 * Allocates a new SourceId for the given resource.
 	 *
@@ -117,6 +162,76 @@ private:
 	 */
 	void purgeResource(SourceId sourceId);
 
+	/**
+	 * Records an import or include performed while parsing the resource with
+	 * the SourceId given in the context.
+	 *
+	 * @param ctx is the context of the importing resource.
+	 * @param path, mimetype, rel and supportedTypes are the arguments of the
+	 * import.
+	 * @param sourceId is the SourceId of the imported resource.
+	 * @param mode is the mode of the import.
+	 */
+	void recordImport(ParserContext &ctx, const std::string &path,
+	                  const std::string &mimetype, const std::string &rel,
+	                  const RttiSet &supportedTypes, SourceId sourceId,
+	                  ParseMode mode);
+
+	/**
+	 * Returns the root nodes of the dependencies of the given cached resource
+	 * as used by the BinaryGraphWriter and the BinaryGraphReader. The first
+	 * dependency is the system typesystem of the project.
+	 *
+	 * @param ctx is the current parser context.
+	 * @param state is the CacheState of the resource.
+	 * @param dependencies is the list the root nodes are written to.
+	 * @return false if one of the dependencies no longer exists.
+	 */
+	bool cacheDependencies(ParserContext &ctx, const CacheState &state,
+	                       std::vector<Rooted<Node>> &dependencies);
+
+	/**
+	 * Computes the hash of the current binary graph of the given resource.
+	 *
+	 * @param ctx is the current parser context.
+	 * @param sourceId is the id of the resource.
+	 * @param hash is set to the hash of the graph.
+	 * @return false if the graph of the resource cannot be serialized.
+	 */
+	bool currentGraphHash(ParserContext &ctx, SourceId sourceId,
+	                      uint64_t &hash);
+
+	/**
+	 * Tries to load the given resource from the cache. The resources imported
+	 * by the cached resource are imported first.
+	 *
+	 * @param ctx is the context of the importing resource.
+	 * @param req is the request describing the resource.
+	 * @param sourceId is the SourceId of the resource.
+	 * @param contentHash is the hash of the current resource content.
+	 * @return the node read from the cache or nullptr if there is no valid
+	 * cache entry.
+	 */
+	Rooted<Node> loadCached(ParserContext &ctx, const ResourceRequest &req,
+	                        SourceId sourceId, uint64_t contentHash);
+
+	/**
+	 * Stores the given node parsed from the given resource in the cache, if
+	 * the node and its imports allow it.
+	 *
+	 * @param ctx is the context of the importing resource.
+	 * @param req is the request describing the resource.
+	 * @param sourceId is the SourceId of the resource.
+	 * @param contentHash is the hash of the resource content.
+	 * @param node is the parsed node.
+	 * @param clean must be false if warnings or errors were logged while
+	 * parsing, these would not be reported again if the node was loaded from
+	 * the cache.
+	 */
+	void storeCached(ParserContext &ctx, const ResourceRequest &req,
+	                 SourceId sourceId, uint64_t contentHash,
+	                 Handle<Node> node, bool clean);
+
 	/**
 	 * Used internally to parse the given resource. Can either operate in the
 	 * "import" or the "include" mode. In the latter case the ParserScope
@@ -141,6 +256,25 @@ private:
 	                       const RttiSet &supportedTypes, ParseMode mode);
 
 public:
+	/**
+	 * Sets the cache used to store parsed ontologies and typesystems. Before
+	 * an ontology or typesystem is parsed, the cache is consulted for an entry
+	 * with the same location, mimetype and content. Only resources which do
+	 * not include other resources, were parsed without warnings and do not
+	 * modify the resources they import are stored.
+	 *
+	 * @param cache is the cache that should be used, nullptr (the default)
+	 * disables caching. The cache must exist as long as resources are parsed.
+	 */
+	void setCache(ResourceCache *cache) { this->cache = cache; }
+
+	/**
+	 * Returns the cache used to store parsed ontologies and typesystems.
+	 *
+	 * @return the cache or nullptr if caching is disabled.
+	 */
+	ResourceCache *getCache() const { return cache; }
+
 	/**
 	 * Resolves the reference to the file specified by the given path and -- if
 	 * this has not already happened -- parses the file. The parser that is
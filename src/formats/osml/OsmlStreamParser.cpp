@@ -363,6 +363,20 @@ private:
 	 */
 	bool checkIssueData();
 
+	/**
+	 * Returns true if the streaming mode is enabled and the data collected so
+	 * far has reached the maximum chunk size. In this case the data is issued
+	 * before the next command is reached, which allows the CharReader to
+	 * release the consumed input.
+	 *
+	 * @return true if the data should be issued now.
+	 */
+	bool dataChunkFull() const
+	{
+		const size_t maxChunkSize = tokenizer.getMaxDataSize();
+		return maxChunkSize > 0 && data.size() >= maxChunkSize;
+	}
+
 	/**
 	 * Returns a reference at the current command at the top of the command
 	 * stack.
@@ -395,6 +409,9 @@ public:
 	TokenId registerToken(const std::string &token);
 	void unregisterToken(TokenId id);
 
+	void setMaxDataChunkSize(size_t size) { tokenizer.setMaxDataSize(size); }
+	size_t getMaxDataChunkSize() const { return tokenizer.getMaxDataSize(); }
+
 	const TokenizedData &getData() const { return data; }
 	const Variant &getCommandName() const { return cmd().getName(); }
 	const Variant &getCommandArguments() const { return cmd().getArguments(); }
@@ -836,9 +853,15 @@ OsmlStreamParserImpl::State OsmlStreamParserImpl::parse()
 			// Append the character to the output data, mark it as protected
 			data.append(c, charStart, charEnd, true);
 			reader.consumePeek();
+			if (dataChunkFull() && checkIssueData()) {
+				return State::DATA;
+			}
 			continue;
 		} else if (type == Tokens::Data) {
 			reader.consumePeek();
+			if (dataChunkFull() && checkIssueData()) {
+				return State::DATA;
+			}
 			continue;
 		} else if (type == tokens.lineComment) {
 			reader.consumePeek();
@@ -964,6 +987,16 @@ OsmlStreamParser::State OsmlStreamParser::parse()
 	return static_cast<State>(impl->parse());
 }
 
+void OsmlStreamParser::setMaxDataChunkSize(size_t size)
+{
+	impl->setMaxDataChunkSize(size);
+}
+
+size_t OsmlStreamParser::getMaxDataChunkSize() const
+{
+	return impl->getMaxDataChunkSize();
+}
+
 const TokenizedData &OsmlStreamParser::getData() const
 {
 	return impl->getData();
@@ -151,6 +151,29 @@ public:
 	 */
 	State parse();
 
+	/**
+	 * Enables the streaming mode by limiting the size of the data chunks
+	 * returned by the parser. Without a limit all text up to the next command
+	 * is collected into a single State::DATA event, which requires the text
+	 * and the underlying input to be held in memory. With a limit, text
+	 * longer than the given number of characters is split into multiple
+	 * consecutive State::DATA events, so the memory needed for parsing is
+	 * independent of the length of the text. Note that whitespace handling
+	 * (trimming and collapsing) is performed for each chunk separately.
+	 *
+	 * @param size is the approximate maximum number of characters in a data
+	 * chunk. Zero (the default) disables the streaming mode.
+	 */
+	void setMaxDataChunkSize(size_t size);
+
+	/**
+	 * Returns the maximum data chunk size set by setMaxDataChunkSize().
+	 *
+	 * @return the maximum number of characters in a data chunk, zero if the
+	 * streaming mode is disabled.
+	 */
+	size_t getMaxDataChunkSize() const;
+
 	/**
 	 * Returns a reference at the internally stored command name. Only valid if
 	 * State::COMMAND_START, State::ANNOTATION_START or State::ANNOTATION_END
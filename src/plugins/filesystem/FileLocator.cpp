@@ -29,9 +29,12 @@
 
 #include <boost/filesystem.hpp>
 
+#include <core/common/CharReader.hpp>
+#include <core/common/Exceptions.hpp>
 #include <core/common/Utils.hpp>
 
 #include "FileLocator.hpp"
+#include "MappedFile.hpp"
 #include "SpecialPaths.hpp"
 
 namespace fs = boost::filesystem;
@@ -263,4 +266,21 @@ std::unique_ptr<std::istream> FileLocator::doStream(
 {
 	return std::unique_ptr<std::istream>{new std::ifstream(location)};
 }
+
+std::shared_ptr<Buffer> FileLocator::doBuffer(
+    const std::string &location) const
+{
+	// Map the file into memory, the Buffer keeps the mapping alive. Empty
+	// files and files which cannot be mapped are streamed instead.
+	try {
+		auto file = std::make_shared<MappedFile>(location);
+		if (file->getData() != nullptr) {
+			return std::make_shared<Buffer>(file->getData(), file->getSize(),
+			                                file);
+		}
+	}
+	catch (const LoggableException &) {
+	}
+	return ResourceLocator::doBuffer(location);
+}
 }
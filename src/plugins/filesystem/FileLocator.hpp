@@ -85,6 +85,14 @@ protected:
 	std::unique_ptr<std::istream> doStream(
 	    const std::string &location) const override;
 
+	/**
+	 * Maps regular files into memory and returns a Buffer operating directly
+	 * on the mapped region. Falls back to the stream based Buffer if the file
+	 * cannot be mapped (e.g. because it is empty or a special file).
+	 */
+	std::shared_ptr<Buffer> doBuffer(
+	    const std::string &location) const override;
+
 public:
 	FileLocator() : searchPaths() {}
 
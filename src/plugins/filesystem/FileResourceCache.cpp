@@ -0,0 +1,72 @@
+/*
+    Ousía
+    Copyright (C) 2014, 2015  Benjamin Paaßen, Andreas Stöckel
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <unistd.h>
+
+#include <fstream>
+#include <iterator>
+
+#include <boost/filesystem.hpp>
+
+#include "FileResourceCache.hpp"
+
+namespace fs = boost::filesystem;
+
+namespace ousia {
+
+bool FileResourceCache::doLoad(const std::string &key, std::string &data)
+{
+	std::ifstream is((fs::path{dir} / key).string(), std::ios::binary);
+	if (!is) {
+		return false;
+	}
+	data.assign(std::istreambuf_iterator<char>(is),
+	            std::istreambuf_iterator<char>());
+	return !is.bad();
+}
+
+void FileResourceCache::doStore(const std::string &key,
+                                const std::string &data)
+{
+	// Failing to write the cache is not an error, the resource is simply
+	// parsed again in the next run
+	boost::system::error_code ec;
+	fs::create_directories(dir, ec);
+	if (ec) {
+		return;
+	}
+
+	// Write the entry to a temporary file and move it to its final place
+	const fs::path path = fs::path{dir} / key;
+	const fs::path tmp =
+	    fs::path{dir} / (key + ".tmp" + std::to_string(getpid()));
+	{
+		std::ofstream os(tmp.string(), std::ios::binary | std::ios::trunc);
+		if (!os.write(data.data(), data.size())) {
+			os.close();
+			fs::remove(tmp, ec);
+			return;
+		}
+	}
+	fs::rename(tmp, path, ec);
+	if (ec) {
+		fs::remove(tmp, ec);
+	}
+}
+}
+
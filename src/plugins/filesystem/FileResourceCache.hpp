@@ -0,0 +1,80 @@
+/*
+    Ousía
+    Copyright (C) 2014, 2015  Benjamin Paaßen, Andreas Stöckel
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file FileResourceCache.hpp
+ *
+ * Contains the FileResourceCache class which stores the cached resources in a
+ * directory of the filesystem.
+ *
+ * @author Andreas Stöckel (astoecke@techfak.uni-bielefeld.de)
+ */
+
+#ifndef _OUSIA_FILE_RESOURCE_CACHE_HPP_
+#define _OUSIA_FILE_RESOURCE_CACHE_HPP_
+
+#include <string>
+
+#include <core/resource/ResourceCache.hpp>
+
+namespace ousia {
+
+/**
+ * The FileResourceCache class is an implementation of the ResourceCache
+ * interface which stores each entry as a file in a cache directory. Entries
+ * are written to a temporary file first and then renamed, so concurrent runs
+ * never read partially written entries.
+ */
+class FileResourceCache : public ResourceCache {
+private:
+	/**
+	 * Directory in which the entries are stored.
+	 */
+	std::string dir;
+
+protected:
+	bool doLoad(const std::string &key, std::string &data) override;
+
+	void doStore(const std::string &key, const std::string &data) override;
+
+public:
+	/**
+	 * Constructor of the FileResourceCache class. The directory is created
+	 * once the first entry is stored.
+	 *
+	 * @param dir is the directory in which the entries should be stored.
+	 * @param parserVersion is the parser version written to and expected in
+	 * the entries. Only differs from PARSER_VERSION in tests.
+	 */
+	FileResourceCache(std::string dir,
+	                  uint32_t parserVersion = ResourceCache::PARSER_VERSION)
+	    : ResourceCache(parserVersion), dir(std::move(dir))
+	{
+	}
+
+	/**
+	 * Returns the directory in which the entries are stored.
+	 *
+	 * @return the cache directory.
+	 */
+	const std::string &getDir() const { return dir; }
+};
+}
+
+#endif /* _OUSIA_FILE_RESOURCE_CACHE_HPP_ */
+
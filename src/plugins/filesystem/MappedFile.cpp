@@ -0,0 +1,67 @@
+/*
+    Ousía
+    Copyright (C) 2014, 2015  Benjamin Paaßen, Andreas Stöckel
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <core/common/Exceptions.hpp>
+
+#include "MappedFile.hpp"
+
+namespace ousia {
+
+MappedFile::MappedFile(const std::string &path) : data(nullptr), size(0)
+{
+	const int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0) {
+		throw LoggableException{std::string("Cannot open file \"") + path +
+		                        "\""};
+	}
+
+	// Empty files cannot be mapped, they are represented by a nullptr
+	struct stat st;
+	if (fstat(fd, &st) != 0) {
+		close(fd);
+		throw LoggableException{std::string("Cannot read file \"") + path +
+		                        "\""};
+	}
+	if (st.st_size > 0) {
+		void *res = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (res == MAP_FAILED) {
+			close(fd);
+			throw LoggableException{std::string("Cannot map file \"") +
+			                        path + "\""};
+		}
+		data = static_cast<const char *>(res);
+		size = st.st_size;
+	}
+
+	// The mapping stays valid after the file is closed
+	close(fd);
+}
+
+MappedFile::~MappedFile()
+{
+	if (data != nullptr) {
+		munmap(const_cast<char *>(data), size);
+	}
+}
+}
+
@@ -0,0 +1,90 @@
+/*
+    Ousía
+    Copyright (C) 2014, 2015  Benjamin Paaßen, Andreas Stöckel
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file MappedFile.hpp
+ *
+ * Contains the MappedFile class which maps a file into memory, e.g. to read a
+ * binary graph in place.
+ *
+ * @author Andreas Stöckel (astoecke@techfak.uni-bielefeld.de)
+ */
+
+#ifndef _OUSIA_MAPPED_FILE_HPP_
+#define _OUSIA_MAPPED_FILE_HPP_
+
+#include <cstddef>
+#include <string>
+
+namespace ousia {
+
+/**
+ * The MappedFile class maps a file read-only into memory. The file content is
+ * loaded lazily by the operating system and shared with other processes
+ * mapping the same file. The mapping is removed once the instance is
+ * destroyed.
+ */
+class MappedFile {
+private:
+	/**
+	 * Pointer at the mapped file content, nullptr for empty files.
+	 */
+	const char *data;
+
+	/**
+	 * Size of the file in bytes.
+	 */
+	size_t size;
+
+public:
+	/**
+	 * Maps the file at the given path into memory. Throws a LoggableException
+	 * if the file cannot be opened or mapped.
+	 *
+	 * @param path is the path of the file that should be mapped.
+	 */
+	MappedFile(const std::string &path);
+
+	/**
+	 * Removes the mapping.
+	 */
+	~MappedFile();
+
+	// No copy
+	MappedFile(const MappedFile &) = delete;
+	MappedFile &operator=(const MappedFile &) = delete;
+
+	/**
+	 * Returns a pointer at the file content.
+	 *
+	 * @return a pointer at the first byte of the file, nullptr if the file is
+	 * empty.
+	 */
+	const char *getData() const { return data; }
+
+	/**
+	 * Returns the size of the file.
+	 *
+	 * @return the size of the file in bytes.
+	 */
+	size_t getSize() const { return size; }
+};
+}
+
+#endif /* _OUSIA_MAPPED_FILE_HPP_ */
+
@@ -168,7 +168,7 @@ static Rooted<Element> createImportElement(Handle<Element> parent,
 		return nullptr;
 	}
 	// if we found it we create an import element.
-	Rooted<Element> import{new Element{
+	Rooted<Element> import{new (P.mgr) Element{
 	    P.mgr, parent, "import", {{"rel", rel}, {"src", res.getLocation()}}}};
 	return import;
 }
@@ -182,7 +182,7 @@ void XmlTransformer::writeXml(Handle<Document> doc, std::ostream &out,
 
 	Manager &mgr = doc->getManager();
 	// the outermost tag is the document itself.
-	Rooted<Element> document{new Element{mgr, {nullptr}, "document"}};
+	Rooted<Element> document{new (mgr) Element{mgr, {nullptr}, "document"}};
 	// create parameter wrapper object
 	TransformParams P{mgr, logger, pretty, flat,
 	                  doc->getLocation().getSourceId()};
@@ -276,13 +276,13 @@ static Rooted<Element> transformTokenDescriptor(Handle<Element> parent,
 	if (descr.isEmpty()) {
 		return nullptr;
 	}
-	Rooted<Element> tag{new Element(P.mgr, parent, tagName)};
+	Rooted<Element> tag{new (P.mgr) Element(P.mgr, parent, tagName)};
 	Rooted<xml::Node> token;
 	if (descr.special) {
 		token = Rooted<Element>{
-		    new Element(P.mgr, tag, Token::specialName(descr.id))};
+		    new (P.mgr) Element(P.mgr, tag, Token::specialName(descr.id))};
 	} else {
-		token = Rooted<Text>{new Text(P.mgr, tag, descr.token)};
+		token = Rooted<Text>{new (P.mgr) Text(P.mgr, tag, descr.token)};
 	}
 	tag->addChild(token);
 	if (!descr.greedy) {
@@ -314,9 +314,10 @@ static Rooted<Element> transformFieldDescriptor(Handle<Element> parent,
 	}
 	// TODO: whitespace mode?
 	// create the XML element itself.
-	Rooted<Element> fieldDescriptor{new Element(P.mgr, parent, tagName, attrs)};
+	Rooted<Element> fieldDescriptor{new (P.mgr)
+	    Element(P.mgr, parent, tagName, attrs)};
 	// translate the syntax.
-	Rooted<Element> syntax{new Element(P.mgr, parent, "syntax")};
+	Rooted<Element> syntax{new (P.mgr) Element(P.mgr, parent, "syntax")};
 	{
 		Rooted<Element> open =
 		    transformTokenDescriptor(syntax, fd->getOpenToken(), "open", P);
@@ -337,7 +338,7 @@ static Rooted<Element> transformFieldDescriptor(Handle<Element> parent,
 		for (auto s : fd->getChildren()) {
 			std::string ref =
 			    getStructuredClassRef(fd->getParent().cast<Descriptor>(), s);
-			Rooted<Element> childRef{new Element(P.mgr, fieldDescriptor,
+			Rooted<Element> childRef{new (P.mgr) Element(P.mgr, fieldDescriptor,
 			                                     "childRef", {{"ref", ref}})};
 			fieldDescriptor->addChild(childRef);
 		}
@@ -386,7 +387,8 @@ static Rooted<Element> transformStructuredClass(Handle<Element> parent,
                                                 Handle<StructuredClass> s,
                                                 TransformParams &P)
 {
-	Rooted<Element> structuredClass{new Element(P.mgr, parent, "struct")};
+	Rooted<Element> structuredClass{new (P.mgr)
+	    Element(P.mgr, parent, "struct")};
 	// transform the specific StructuredClass properties.
 	if (s->getCardinality() != Cardinality::any()) {
 		structuredClass->getAttributes().emplace(
@@ -406,7 +408,8 @@ static Rooted<Element> transformStructuredClass(Handle<Element> parent,
 	}
 
 	// transform the syntactic sugar descriptors
-	Rooted<Element> syntax{new Element(P.mgr, structuredClass, "syntax")};
+	Rooted<Element> syntax{new (P.mgr)
+	    Element(P.mgr, structuredClass, "syntax")};
 	{
 		Rooted<Element> shortForm =
 		    transformTokenDescriptor(syntax, s->getShortToken(), "short", P);
@@ -427,8 +430,10 @@ static Rooted<Element> transformAnnotationClass(Handle<Element> parent,
                                                 Handle<AnnotationClass> a,
                                                 TransformParams &P)
 {
-	Rooted<Element> annotationClass{new Element(P.mgr, parent, "struct")};
-	Rooted<Element> syntax{new Element(P.mgr, annotationClass, "syntax")};
+	Rooted<Element> annotationClass{new (P.mgr)
+	    Element(P.mgr, parent, "struct")};
+	Rooted<Element> syntax{new (P.mgr)
+	    Element(P.mgr, annotationClass, "syntax")};
 	transformDescriptor(annotationClass, syntax, a, P);
 	if (!syntax->getChildren().empty()) {
 		annotationClass->addChild(syntax);
@@ -467,7 +472,7 @@ static Rooted<Element> transformOntology(Handle<Element> parent,
 
 	// transform the ontology itself.
 	// create an XML element for the ontology.
-	Rooted<Element> ontology{new Element(P.mgr, parent, "ontology")};
+	Rooted<Element> ontology{new (P.mgr) Element(P.mgr, parent, "ontology")};
 	addNameAttribute(o, ontology->getAttributes());
 	// transform all StructuredClasses.
 	for (auto s : o->getStructureClasses()) {
@@ -511,7 +516,7 @@ static Rooted<Element> transformStructTypeEntry(Handle<Element> parent,
                                                 TransformParams &P)
 {
 	// create an xml element for the attribute.
-	Rooted<Element> attribute{new Element(P.mgr, parent, tagName)};
+	Rooted<Element> attribute{new (P.mgr) Element(P.mgr, parent, tagName)};
 	addNameAttribute(a, attribute->getAttributes());
 	// add the type reference
 	{
@@ -535,7 +540,8 @@ static Rooted<Element> transformStructType(Handle<Element> parent,
                                            TransformParams &P)
 {
 	// create an xml element for the struct type itself.
-	Rooted<Element> structType{new Element(P.mgr, parent, structTagName)};
+	Rooted<Element> structType{new (P.mgr)
+	    Element(P.mgr, parent, structTagName)};
 	addNameAttribute(t, structType->getAttributes());
 	// transformt the parent reference.
 	if (t->getParentStructure() != nullptr) {
@@ -556,13 +562,14 @@ static Rooted<Element> transformEnumType(Handle<Element> parent,
                                          Handle<EnumType> e, TransformParams &P)
 {
 	// create an xml element for the enum type itself.
-	Rooted<Element> enumType{new Element(P.mgr, parent, "enum")};
+	Rooted<Element> enumType{new (P.mgr) Element(P.mgr, parent, "enum")};
 	addNameAttribute(e, enumType->getAttributes());
 	// add all entries.
 	for (std::string &name : e->names()) {
-		Rooted<Element> enumEntry{new Element(P.mgr, enumType, "entry")};
+		Rooted<Element> enumEntry{new (P.mgr)
+		    Element(P.mgr, enumType, "entry")};
 		enumType->addChild(enumEntry);
-		Rooted<Text> enumName{new Text(P.mgr, enumEntry, name)};
+		Rooted<Text> enumName{new (P.mgr) Text(P.mgr, enumEntry, name)};
 		enumEntry->addChild(enumName);
 	}
 	return enumType;
@@ -573,7 +580,7 @@ static Rooted<Element> transformConstant(Handle<Element> parent,
                                          Handle<Constant> c, TransformParams &P)
 {
 	// create an xml element for the constant.
-	Rooted<Element> constant{new Element(P.mgr, parent, "constant")};
+	Rooted<Element> constant{new (P.mgr) Element(P.mgr, parent, "constant")};
 	addNameAttribute(c, constant->getAttributes());
 	// add the type reference
 	{
@@ -613,7 +620,8 @@ static Rooted<Element> transformTypesystem(Handle<Element> parent,
 
 	// transform the typesystem itself.
 	// create an XML element for the ontology.
-	Rooted<Element> typesystem{new Element(P.mgr, parent, "typesystem")};
+	Rooted<Element> typesystem{new (P.mgr)
+	    Element(P.mgr, parent, "typesystem")};
 	addNameAttribute(t, typesystem->getAttributes());
 	// transform all types
 	for (auto tp : t->getTypes()) {
@@ -697,7 +705,7 @@ static void transformChildren(DocumentEntity *parentEntity,
 		Rooted<Element> par = parent;
 		if (fieldDesc->getFieldType() != FieldDescriptor::FieldType::TREE) {
 			par = Rooted<Element>{
-			    new Element(P.mgr, parent, fieldDesc->getName())};
+			    new (P.mgr) Element(P.mgr, parent, fieldDesc->getName())};
 			parent->addChild(par);
 		}
 		if (!fieldDesc->isPrimitive()) {
@@ -739,7 +747,7 @@ static Rooted<Element> transformStructuredEntity(Handle<Element> parent,
                                                  TransformParams &P)
 {
 	// create the XML element itself.
-	Rooted<Element> elem{new Element{
+	Rooted<Element> elem{new (P.mgr) Element{
 	    P.mgr, parent, s->getDescriptor()->getName(),
 	    transformAttributes(s->getName(), s.get(), P),
 	    s->getDescriptor()->getParent().cast<Ontology>()->getName()}};
@@ -760,7 +768,7 @@ static Rooted<Element> transformAnchor(Handle<Element> parent, Handle<Anchor> a,
 		// transform the attributes.
 		auto attrs = transformAttributes("", a->getAnnotation().get(), P);
 
-		elem = Rooted<Element>{new Element(
+		elem = Rooted<Element>{new (P.mgr) Element(
 		    P.mgr, parent, a->getAnnotation()->getDescriptor()->getName(),
 		    attrs, "a:start")};
 		// and handle the children.
@@ -777,7 +785,7 @@ static Rooted<Element> transformAnchor(Handle<Element> parent, Handle<Anchor> a,
 		 */
 		std::map<std::string, std::string> attrs;
 		addNameAttribute(a->getAnnotation(), attrs);
-		elem = Rooted<Element>{new Element(
+		elem = Rooted<Element>{new (P.mgr) Element(
 		    P.mgr, parent, a->getAnnotation()->getDescriptor()->getName(),
 		    attrs, "a:end")};
 	} else {
@@ -821,7 +829,7 @@ static Rooted<Text> transformPrimitive(Handle<Element> parent,
 		}
 		content = std::move(map);
 	}
-	Rooted<Text> text{new Text(P.mgr, parent, toString(content, P))};
+	Rooted<Text> text{new (P.mgr) Text(P.mgr, parent, toString(content, P))};
 	return text;
 }
 }
@@ -0,0 +1,118 @@
+/*
+    Ousía
+    Copyright (C) 2014, 2015  Benjamin Paaßen, Andreas Stöckel
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file Benchmark.hpp
+ *
+ * Minimal framework used for the micro benchmarks in the test tree.
+ * Benchmarks are registered with the BENCHMARK macro and executed by the
+ * "ousia_benchmark" executable, which runs all benchmarks whose name contains
+ * one of the strings passed on the command line. The executable replaces the
+ * global allocation functions, so benchmarks can report the number of heap
+ * allocations and the number of bytes allocated by the code under test.
+ *
+ * @author Andreas Stöckel (astoecke@techfak.uni-bielefeld.de)
+ */
+
+#ifndef _OUSIA_BENCHMARK_HPP_
+#define _OUSIA_BENCHMARK_HPP_
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+
+namespace ousia {
+namespace benchmark {
+
+/**
+ * Function type of a single benchmark.
+ */
+using BenchmarkFunction = void (*)();
+
+/**
+ * Class used to register a benchmark at static initialization time. Use the
+ * BENCHMARK macro instead of using this class directly.
+ */
+struct BenchmarkRegistration {
+	/**
+	 * Registers the given benchmark function under the given name.
+	 *
+	 * @param name is the name of the benchmark.
+	 * @param f is the function that should be executed.
+	 */
+	BenchmarkRegistration(const char *name, BenchmarkFunction f);
+};
+
+/**
+ * Returns the number of heap allocations performed since the program start.
+ */
+size_t allocationCount();
+
+/**
+ * Returns the number of bytes currently allocated on the heap.
+ */
+size_t allocatedBytes();
+
+/**
+ * Prints a single benchmark result.
+ *
+ * @param name is a descriptive name of the measured quantity.
+ * @param value is the measured value.
+ * @param unit is the unit of the measured value.
+ */
+void report(const std::string &name, double value, const std::string &unit);
+
+/**
+ * Simple wall clock timer, starts when being constructed.
+ */
+class Timer {
+private:
+	/**
+	 * Time point at which the timer was started.
+	 */
+	std::chrono::steady_clock::time_point start;
+
+public:
+	/**
+	 * Constructor of the Timer class, starts the timer.
+	 */
+	Timer() : start(std::chrono::steady_clock::now()) {}
+
+	/**
+	 * Returns the number of seconds elapsed since the timer was started.
+	 */
+	double elapsed() const
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+		                                     start).count();
+	}
+};
+}
+}
+
+/**
+ * Defines and registers a benchmark with the given name.
+ */
+#define BENCHMARK(NAME)                                                  \
+	static void benchmark_##NAME();                                      \
+	static ousia::benchmark::BenchmarkRegistration benchmarkRegistration_ \
+	    ##NAME(#NAME, benchmark_##NAME);                                 \
+	static void benchmark_##NAME()
+
+#endif /* _OUSIA_BENCHMARK_HPP_ */
+
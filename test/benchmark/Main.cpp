@@ -0,0 +1,139 @@
+/*
+    Ousía
+    Copyright (C) 2014, 2015  Benjamin Paaßen, Andreas Stöckel
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file Main.cpp
+ *
+ * Entry point of the benchmark executable. Replaces the global allocation
+ * functions with counting versions and runs the registered benchmarks.
+ *
+ * @author Andreas Stöckel (astoecke@techfak.uni-bielefeld.de)
+ */
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "Benchmark.hpp"
+
+namespace ousia {
+namespace benchmark {
+
+namespace {
+/**
+ * Number of allocations performed so far.
+ */
+size_t counterAllocations = 0;
+
+/**
+ * Number of bytes currently allocated.
+ */
+size_t counterBytes = 0;
+
+/**
+ * Size of the header stored in front of each allocated block. Chosen to
+ * preserve the alignment guaranteed by malloc.
+ */
+constexpr size_t HEADER_SIZE = 16;
+
+/**
+ * Returns the list of registered benchmarks.
+ */
+std::vector<std::pair<const char *, BenchmarkFunction>> &benchmarks()
+{
+	static std::vector<std::pair<const char *, BenchmarkFunction>> res;
+	return res;
+}
+}
+
+BenchmarkRegistration::BenchmarkRegistration(const char *name,
+                                             BenchmarkFunction f)
+{
+	benchmarks().emplace_back(name, f);
+}
+
+size_t allocationCount() { return counterAllocations; }
+
+size_t allocatedBytes() { return counterBytes; }
+
+void report(const std::string &name, double value, const std::string &unit)
+{
+	std::cout << "    " << std::left << std::setw(48) << name << std::right
+	          << std::setw(14) << std::fixed << std::setprecision(2) << value
+	          << " " << unit << std::endl;
+}
+}
+}
+
+/* Counting allocation functions */
+
+static void *countingAlloc(size_t size)
+{
+	void *p = std::malloc(size + ousia::benchmark::HEADER_SIZE);
+	if (!p) {
+		throw std::bad_alloc();
+	}
+	*static_cast<size_t *>(p) = size;
+	ousia::benchmark::counterAllocations++;
+	ousia::benchmark::counterBytes += size;
+	return static_cast<char *>(p) + ousia::benchmark::HEADER_SIZE;
+}
+
+static void countingFree(void *p)
+{
+	if (p) {
+		void *block = static_cast<char *>(p) - ousia::benchmark::HEADER_SIZE;
+		ousia::benchmark::counterBytes -= *static_cast<size_t *>(block);
+		std::free(block);
+	}
+}
+
+void *operator new(size_t size) { return countingAlloc(size); }
+
+void *operator new[](size_t size) { return countingAlloc(size); }
+
+void operator delete(void *p) noexcept { countingFree(p); }
+
+void operator delete[](void *p) noexcept { countingFree(p); }
+
+void operator delete(void *p, size_t) noexcept { countingFree(p); }
+
+void operator delete[](void *p, size_t) noexcept { countingFree(p); }
+
+int main(int argc, char **argv)
+{
+	using namespace ousia::benchmark;
+
+	for (const auto &benchmark : benchmarks()) {
+		// Only run the benchmark if its name matches one of the filters
+		bool run = argc <= 1;
+		for (int i = 1; i < argc && !run; i++) {
+			run = std::string(benchmark.first).find(argv[i]) !=
+			      std::string::npos;
+		}
+		if (run) {
+			std::cout << "[ " << benchmark.first << " ]" << std::endl;
+			benchmark.second();
+		}
+	}
+	return 0;
+}
+
@@ -0,0 +1,202 @@
+/*
+    Ousía
+    Copyright (C) 2014, 2015  Benjamin Paaßen, Andreas Stöckel
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <core/common/CharReader.hpp>
+
+#include <benchmark/Benchmark.hpp>
+
+namespace ousia {
+
+namespace {
+
+/**
+ * Size of the generated OSXML document in bytes.
+ */
+constexpr size_t DOCUMENT_SIZE = 100 * 1000 * 1000;
+
+/**
+ * Size of the chunks in which the data is read (same as in the
+ * OsxmlEventParser).
+ */
+constexpr size_t CHUNK_SIZE = 64 * 1024;
+
+/**
+ * Generates an OSXML document of (roughly) the given size.
+ */
+std::string generateOsxml(size_t size)
+{
+	static const std::string PARAGRAPH =
+	    "\t\t<paragraph>\n\t\t\tLorem ipsum dolor sit amet, consectetur "
+	    "<emphasized>adipiscing</emphasized> elit, sed do eiusmod tempor "
+	    "incididunt ut labore et dolore magna aliqua.\n\t\t</paragraph>\n";
+	std::string res =
+	    "<?xml version=\"1.0\" standalone=\"yes\"?>\n<document>\n"
+	    "\t<import rel=\"ontology\" src=\"book\"/>\n\t<book>\n";
+	res.reserve(size + PARAGRAPH.size());
+	while (res.size() < size) {
+		res.append(PARAGRAPH);
+	}
+	res.append("\t</book>\n</document>\n");
+	return res;
+}
+
+/**
+ * Reads the complete data from the given reader character by character, the
+ * way CharReader::readRaw used to work.
+ */
+size_t readCharacterWise(CharReader &reader, std::vector<char> &buf)
+{
+	size_t total = 0;
+	while (true) {
+		size_t n = 0;
+		while (n < buf.size() && reader.read(buf[n])) {
+			n++;
+		}
+		total += n;
+		if (n < buf.size()) {
+			return total;
+		}
+	}
+}
+
+/**
+ * Reads the complete data from the given reader, peeks a few characters ahead
+ * of each character that is read.
+ */
+size_t readPeek(CharReader &reader)
+{
+	size_t total = 0;
+	char c;
+	while (true) {
+		for (int i = 0; i < 8 && reader.peek(c); i++) {
+		}
+		reader.resetPeek();
+		if (!reader.read(c)) {
+			return total;
+		}
+		total++;
+	}
+}
+
+/**
+ * Reads the complete data from the given reader in short forks which are
+ * committed to the reader.
+ */
+size_t readForkCommit(CharReader &reader)
+{
+	char c;
+	while (!reader.atEnd()) {
+		CharReaderFork fork = reader.fork();
+		for (int i = 0; i < 64 && fork.read(c); i++) {
+		}
+		fork.commit();
+	}
+	return reader.getOffset();
+}
+
+/**
+ * Reads the complete data from the given reader using readRaw.
+ */
+size_t readRaw(CharReader &reader, std::vector<char> &buf)
+{
+	size_t total = 0;
+	while (true) {
+		const size_t n = reader.readRaw(buf.data(), buf.size());
+		total += n;
+		if (n < buf.size()) {
+			return total;
+		}
+	}
+}
+}
+
+BENCHMARK(charReaderReadRaw)
+{
+	const std::string doc = generateOsxml(DOCUMENT_SIZE);
+	std::vector<char> buf(CHUNK_SIZE);
+
+	for (bool raw : {false, true}) {
+		std::istringstream is(doc);
+		CharReader reader{is};
+		benchmark::Timer t;
+		const size_t n =
+		    raw ? readRaw(reader, buf) : readCharacterWise(reader, buf);
+		benchmark::report(raw ? "ranged bucket copy" : "character-wise read",
+		                  n / t.elapsed() / 1e6, "MB/s");
+	}
+}
+
+BENCHMARK(charReaderSpan)
+{
+	const std::string doc = generateOsxml(DOCUMENT_SIZE);
+	std::vector<char> buf(CHUNK_SIZE);
+
+	// Compare the copying bucket list with a Buffer directly operating on the
+	// memory region, as used for memory mapped files
+	for (bool span : {false, true}) {
+		benchmark::Timer t;
+		std::istringstream is(doc);
+		CharReader reader =
+		    span ? CharReader{std::make_shared<Buffer>(doc.data(), doc.size(),
+		                                               nullptr)}
+		         : CharReader{is};
+		const size_t n = readCharacterWise(reader, buf);
+		benchmark::report(span ? "span" : "bucket list",
+		                  n / t.elapsed() / 1e6, "MB/s");
+	}
+}
+
+BENCHMARK(charReaderStorage)
+{
+	const std::string doc = generateOsxml(DOCUMENT_SIZE / 4);
+	std::vector<char> buf(CHUNK_SIZE);
+
+	const std::vector<std::pair<Buffer::Storage, std::string>> storages{
+	    {Buffer::Storage::BUCKETS, "bucket list"},
+	    {Buffer::Storage::RING, "ring"}};
+	for (const auto &storage : storages) {
+		for (int op = 0; op < 3; op++) {
+			std::istringstream is(doc);
+			CharReader reader{std::make_shared<Buffer>(is, storage.first)};
+			benchmark::Timer t;
+			size_t n;
+			std::string name;
+			switch (op) {
+				case 0:
+					n = readCharacterWise(reader, buf);
+					name = "read";
+					break;
+				case 1:
+					n = readPeek(reader);
+					name = "peek";
+					break;
+				default:
+					n = readForkCommit(reader);
+					name = "fork/commit";
+					break;
+			}
+			benchmark::report(storage.second + " " + name,
+			                  n / t.elapsed() / 1e6, "MB/s");
+		}
+	}
+}
+}
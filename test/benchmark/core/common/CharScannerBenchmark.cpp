@@ -0,0 +1,53 @@
+/*
+    Ousía
+    Copyright (C) 2014, 2015  Benjamin Paaßen, Andreas Stöckel
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <core/common/CharScanner.hpp>
+
+#include <benchmark/Benchmark.hpp>
+
+namespace ousia {
+
+BENCHMARK(charScannerFind)
+{
+	// Text without any of the searched characters, except for the last one
+	std::string data(64 * 1024 * 1024, 'a');
+	data.back() = '\\';
+
+	const std::vector<std::pair<CharScanner::Implementation, std::string>>
+	    impls{{CharScanner::Implementation::SCALAR, "scalar"},
+	          {CharScanner::Implementation::SSE2, "sse2"},
+	          {CharScanner::Implementation::AVX2, "avx2"}};
+	for (const std::string &chars : {std::string("\r"), std::string("\\%{}<")}) {
+		CharScanner scanner{chars};
+		for (const auto &impl : impls) {
+			if (!CharScanner::supported(impl.first)) {
+				continue;
+			}
+			benchmark::Timer t;
+			const size_t n = scanner.find(data.data(), data.size(), impl.first);
+			benchmark::report(impl.second + ", " + std::to_string(chars.size()) +
+			                      " char(s)",
+			                  (n + 1) / t.elapsed() / 1e6, "MB/s");
+		}
+	}
+}
+}
@@ -0,0 +1,267 @@
+/*
+    Ousía
+    Copyright (C) 2014, 2015  Benjamin Paaßen, Andreas Stöckel
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <core/managed/Managed.hpp>
+
+#include <benchmark/Benchmark.hpp>
+
+namespace ousia {
+
+namespace {
+
+/**
+ * Number of objects used in the benchmarks.
+ */
+constexpr size_t N_OBJECTS = 100000;
+
+/**
+ * Fan-out of the tree built from the objects.
+ */
+constexpr size_t FANOUT = 4;
+
+/**
+ * Number of addRef/deleteRef pairs executed in the throughput benchmark.
+ */
+constexpr size_t N_OPS = 1000000;
+
+/**
+ * Object descriptor layout used by the Manager before the introduction of the
+ * slot array, used as baseline.
+ */
+struct LegacyObjectDescriptor {
+	ManagedUid uid;
+	int rootRefCount = 0;
+	std::unordered_map<Managed *, int> refIn;
+	std::unordered_map<Managed *, int> refOut;
+
+	LegacyObjectDescriptor(ManagedUid uid) : uid(uid) {}
+
+	static void incr(std::unordered_map<Managed *, int> &m, Managed *o)
+	{
+		auto it = m.find(o);
+		if (it == m.end()) {
+			m.emplace(o, 1);
+		} else {
+			it->second++;
+		}
+	}
+
+	static void decr(std::unordered_map<Managed *, int> &m, Managed *o)
+	{
+		auto it = m.find(o);
+		if (it != m.end() && --(it->second) == 0) {
+			m.erase(it);
+		}
+	}
+};
+
+/**
+ * Baseline descriptor store, mirrors the former "objects" and "uids" maps.
+ */
+struct LegacyStore {
+	std::unordered_map<Managed *, LegacyObjectDescriptor> objects;
+	std::unordered_map<ManagedUid, Managed *> uids;
+	ManagedUid nextUid = 1;
+
+	void manage(Managed *o)
+	{
+		objects.emplace(o, LegacyObjectDescriptor{nextUid});
+		uids.emplace(nextUid, o);
+		nextUid++;
+	}
+
+	void addRef(Managed *tar, Managed *src)
+	{
+		LegacyObjectDescriptor &dTar = objects.find(tar)->second;
+		if (src) {
+			LegacyObjectDescriptor::incr(dTar.refIn, src);
+			LegacyObjectDescriptor::incr(objects.find(src)->second.refOut,
+			                             tar);
+		} else {
+			dTar.rootRefCount++;
+		}
+	}
+
+	void deleteRef(Managed *tar, Managed *src)
+	{
+		LegacyObjectDescriptor &dTar = objects.find(tar)->second;
+		if (src) {
+			LegacyObjectDescriptor::decr(dTar.refIn, src);
+			LegacyObjectDescriptor::decr(objects.find(src)->second.refOut,
+			                             tar);
+		} else {
+			dTar.rootRefCount--;
+		}
+	}
+};
+
+/**
+ * Returns fake, distinct Managed pointers for the legacy store.
+ */
+Managed *fakePtr(size_t i)
+{
+	return reinterpret_cast<Managed *>(uintptr_t((i + 1) * 64));
+}
+
+/**
+ * Returns pairs of object indices used in the throughput benchmark.
+ */
+std::vector<std::pair<size_t, size_t>> randomPairs()
+{
+	std::mt19937 gen(4711);
+	std::uniform_int_distribution<size_t> dist(0, N_OBJECTS - 1);
+	std::vector<std::pair<size_t, size_t>> res;
+	res.reserve(N_OPS);
+	for (size_t i = 0; i < N_OPS; i++) {
+		res.emplace_back(dist(gen), dist(gen));
+	}
+	return res;
+}
+}
+
+BENCHMARK(managerMemoryPerObject)
+{
+	using benchmark::allocatedBytes;
+
+	// Legacy layout: descriptors and tree references
+	{
+		const size_t before = allocatedBytes();
+		LegacyStore store;
+		for (size_t i = 0; i < N_OBJECTS; i++) {
+			store.manage(fakePtr(i));
+			if (i == 0) {
+				store.addRef(fakePtr(i), nullptr);
+			} else {
+				store.addRef(fakePtr(i), fakePtr((i - 1) / FANOUT));
+			}
+		}
+		benchmark::report("legacy unordered_map layout",
+		                  double(allocatedBytes() - before) / N_OBJECTS,
+		                  "bytes/object");
+	}
+
+	// Slot array layout, subtract the size of the objects themselves
+	{
+		Manager mgr;
+		const size_t before = allocatedBytes();
+		std::vector<Managed *> objects;
+		objects.reserve(N_OBJECTS);
+		for (size_t i = 0; i < N_OBJECTS; i++) {
+			objects.push_back(new Managed(mgr));
+			if (i == 0) {
+				mgr.addRef(objects[i], nullptr);
+			} else {
+				mgr.addRef(objects[i], objects[(i - 1) / FANOUT]);
+			}
+		}
+		const size_t bytes =
+		    allocatedBytes() - before -
+		    N_OBJECTS * (sizeof(Managed) + sizeof(Managed *));
+		benchmark::report("slot array layout", double(bytes) / N_OBJECTS,
+		                  "bytes/object");
+		mgr.deleteRef(objects[0], nullptr);
+	}
+}
+
+BENCHMARK(managerAddDeleteRef)
+{
+	const std::vector<std::pair<size_t, size_t>> pairs = randomPairs();
+
+	// Legacy layout
+	{
+		LegacyStore store;
+		for (size_t i = 0; i < N_OBJECTS; i++) {
+			store.manage(fakePtr(i));
+			store.addRef(fakePtr(i), nullptr);
+		}
+		benchmark::Timer t;
+		for (const auto &p : pairs) {
+			store.addRef(fakePtr(p.first), fakePtr(p.second));
+		}
+		for (const auto &p : pairs) {
+			store.deleteRef(fakePtr(p.first), fakePtr(p.second));
+		}
+		benchmark::report("legacy unordered_map layout",
+		                  2.0 * N_OPS / t.elapsed() / 1e6, "Mops/s");
+	}
+
+	// Slot array layout, all objects are rooted, so no object is marked or
+	// deleted while the references are removed
+	{
+		Manager mgr;
+		std::vector<Managed *> objects;
+		for (size_t i = 0; i < N_OBJECTS; i++) {
+			objects.push_back(new Managed(mgr));
+			mgr.addRef(objects[i], nullptr);
+		}
+		benchmark::Timer t;
+		for (const auto &p : pairs) {
+			mgr.addRef(objects[p.first], objects[p.second]);
+		}
+		for (const auto &p : pairs) {
+			mgr.deleteRef(objects[p.first], objects[p.second]);
+		}
+		benchmark::report("slot array layout",
+		                  2.0 * N_OPS / t.elapsed() / 1e6, "Mops/s");
+		for (Managed *o : objects) {
+			mgr.deleteRef(o, nullptr);
+		}
+	}
+}
+
+BENCHMARK(managerGcPause)
+{
+	// Simulates a parser: nodes are created, temporarily rooted and attached
+	// to the growing graph. Releasing the rooted handle marks each node, which
+	// causes a sweep every SWEEP_THRESHOLD nodes. In the deep graph each
+	// sweep has to trace back to the root.
+	for (size_t fanout : {FANOUT, size_t(1)}) {
+		const size_t n = fanout == 1 ? N_OBJECTS / 4 : N_OBJECTS;
+		const std::string graph = fanout == 1 ? "deep graph" : "tree";
+		for (bool paused : {false, true}) {
+			Manager mgr;
+			Rooted<Managed> root{new Managed(mgr)};
+			std::vector<Managed *> nodes{root.get()};
+			nodes.reserve(n);
+			benchmark::Timer t;
+			{
+				std::unique_ptr<GcPause> pause;
+				if (paused) {
+					pause = std::unique_ptr<GcPause>(new GcPause(mgr));
+				}
+				for (size_t i = 1; i < n; i++) {
+					Rooted<Managed> node{new Managed(mgr)};
+					mgr.addRef(node.get(), nodes[(i - 1) / fanout]);
+					nodes.push_back(node.get());
+				}
+			}
+			const std::string name =
+			    graph + (paused ? ", paused" : ", unpaused");
+			benchmark::report(name, n / t.elapsed() / 1e6, "Mnodes/s");
+			benchmark::report(name, mgr.getStatistics().sweeps, "sweeps");
+		}
+	}
+}
+}
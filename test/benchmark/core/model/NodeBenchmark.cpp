@@ -0,0 +1,132 @@
+/*
+    Ousía
+    Copyright (C) 2014, 2015  Benjamin Paaßen, Andreas Stöckel
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <string>
+#include <vector>
+
+#include <core/managed/Managed.hpp>
+#include <core/model/Node.hpp>
+
+#include <benchmark/Benchmark.hpp>
+
+namespace ousia {
+
+namespace {
+
+/**
+ * Number of nodes used in the benchmarks.
+ */
+constexpr size_t N_NODES = 100000;
+
+/**
+ * Number of times each node is renamed.
+ */
+constexpr size_t N_RENAMES = 4;
+
+/**
+ * Node with an indexed child list, each child registers a name change event
+ * handler owned by the parent.
+ */
+class BenchmarkNode : public Node {
+public:
+	NodeVector<BenchmarkNode> children;
+
+	BenchmarkNode(Manager &mgr, std::string name, Handle<Node> parent = nullptr)
+	    : Node(mgr, name, parent), children(this)
+	{
+	}
+};
+}
+
+BENCHMARK(nodeRenameEvents)
+{
+	Manager mgr;
+	Rooted<BenchmarkNode> root{new BenchmarkNode(mgr, "root")};
+	std::vector<BenchmarkNode *> nodes;
+	nodes.reserve(N_NODES);
+	for (size_t i = 0; i < N_NODES; i++) {
+		Rooted<BenchmarkNode> node{
+		    new BenchmarkNode(mgr, "n" + std::to_string(i), root)};
+		root->children.push_back(node);
+		nodes.push_back(node.get());
+	}
+
+	// Prepare the names outside of the timed loop
+	std::vector<std::string> names;
+	names.reserve(N_NODES * N_RENAMES);
+	for (size_t r = 0; r < N_RENAMES; r++) {
+		for (size_t i = 0; i < N_NODES; i++) {
+			names.push_back("r" + std::to_string(r) + "_" + std::to_string(i));
+		}
+	}
+
+	const size_t allocs = benchmark::allocationCount();
+	benchmark::Timer t;
+	for (size_t r = 0; r < N_RENAMES; r++) {
+		for (size_t i = 0; i < N_NODES; i++) {
+			nodes[i]->setName(names[r * N_NODES + i]);
+		}
+	}
+	const double elapsed = t.elapsed();
+	benchmark::report("rename with index update",
+	                  N_NODES * N_RENAMES / elapsed / 1e6, "Mrenames/s");
+	benchmark::report("heap allocations",
+	                  double(benchmark::allocationCount() - allocs) /
+	                      (N_NODES * N_RENAMES),
+	                  "allocs/rename");
+}
+
+BENCHMARK(nodeReadData)
+{
+	Manager mgr;
+	Rooted<BenchmarkNode> root{new BenchmarkNode(mgr, "root")};
+	std::vector<BenchmarkNode *> nodes;
+	nodes.reserve(N_NODES);
+	for (size_t i = 0; i < N_NODES; i++) {
+		Rooted<BenchmarkNode> node{
+		    new BenchmarkNode(mgr, "n" + std::to_string(i), root)};
+		root->children.push_back(node);
+		node->storeData("id", new BenchmarkNode(mgr, "id"));
+		nodes.push_back(node.get());
+	}
+
+	size_t found = 0;
+	{
+		benchmark::Timer t;
+		for (size_t r = 0; r < N_RENAMES; r++) {
+			for (BenchmarkNode *node : nodes) {
+				found += node->hasDataKey("id") ? 1 : 0;
+			}
+		}
+		benchmark::report("string key", N_NODES * N_RENAMES / t.elapsed() / 1e6,
+		                  "Mlookups/s");
+	}
+	{
+		const DataKey key = mgr.internDataKey("id");
+		benchmark::Timer t;
+		for (size_t r = 0; r < N_RENAMES; r++) {
+			for (BenchmarkNode *node : nodes) {
+				found += node->hasDataKey(key) ? 1 : 0;
+			}
+		}
+		benchmark::report("interned key",
+		                  N_NODES * N_RENAMES / t.elapsed() / 1e6, "Mlookups/s");
+	}
+	benchmark::report("found", found, "entries");
+}
+}
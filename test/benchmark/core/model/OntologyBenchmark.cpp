@@ -0,0 +1,176 @@
+/*
+    Ousía
+    Copyright (C) 2014, 2015  Benjamin Paaßen, Andreas Stöckel
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <iostream>
+#include <string>
+
+#include <core/common/Logger.hpp>
+#include <core/model/Ontology.hpp>
+#include <core/model/Typesystem.hpp>
+
+#include <benchmark/Benchmark.hpp>
+
+namespace ousia {
+
+namespace {
+
+/**
+ * Number of transparent classes between the start and the target class.
+ */
+constexpr size_t DEPTH = 32;
+
+/**
+ * Number of non-transparent siblings allowed next to each transparent class.
+ */
+constexpr size_t N_SIBLINGS = 16;
+
+/**
+ * Number of times the path from start to target is requested.
+ */
+constexpr size_t N_PATHS = 10000;
+
+/**
+ * Number of classes in the inheritance chain.
+ */
+constexpr size_t N_CLASSES = 8;
+
+/**
+ * Number of fields each class in the inheritance chain declares.
+ */
+constexpr size_t N_FIELDS = 4;
+
+/**
+ * Number of field lookups.
+ */
+constexpr size_t N_LOOKUPS = 100000;
+}
+
+BENCHMARK(ontologyPathTo)
+{
+	Logger logger;
+	Manager mgr;
+	Rooted<SystemTypesystem> sys{new SystemTypesystem(mgr)};
+	Rooted<Ontology> ontology{new Ontology(mgr, sys, "deep")};
+
+	// Build a chain of transparent classes from start to target, each field
+	// additionally allows a number of non-transparent classes
+	Rooted<StructuredClass> start{new StructuredClass(
+	    mgr, "start", ontology, Cardinality::any(), {nullptr}, false, true)};
+	Rooted<StructuredClass> target{
+	    new StructuredClass(mgr, "target", ontology, Cardinality::any())};
+	Rooted<StructuredClass> current = start;
+	for (size_t i = 0; i <= DEPTH; i++) {
+		Rooted<FieldDescriptor> field =
+		    current->createFieldDescriptor(logger).first;
+		for (size_t j = 0; j < N_SIBLINGS; j++) {
+			field->addChild(new StructuredClass(
+			    mgr, "s" + std::to_string(i) + "_" + std::to_string(j),
+			    ontology, Cardinality::any()));
+		}
+		if (i == DEPTH) {
+			field->addChild(target);
+		} else {
+			Rooted<StructuredClass> transparent{new StructuredClass(
+			    mgr, "t" + std::to_string(i), ontology, Cardinality::any(),
+			    {nullptr}, true, false)};
+			field->addChild(transparent);
+			current = transparent;
+		}
+	}
+	if (!ontology->validate(logger)) {
+		std::cerr << "Could not validate the ontology" << std::endl;
+		return;
+	}
+
+	size_t found = 0;
+	{
+		// Reporting an invalidation before each request defeats the cache
+		benchmark::Timer t;
+		for (size_t i = 0; i < N_PATHS; i++) {
+			mgr.invalidated();
+			found += start->pathTo(target, logger).size();
+		}
+		benchmark::report("uncached", N_PATHS / t.elapsed() / 1e3,
+		                  "kpaths/s");
+	}
+	{
+		benchmark::Timer t;
+		for (size_t i = 0; i < N_PATHS; i++) {
+			found += start->pathTo(target, logger).size();
+		}
+		benchmark::report("cached", N_PATHS / t.elapsed() / 1e3, "kpaths/s");
+	}
+	if (found != 2 * N_PATHS * (2 * DEPTH + 1)) {
+		std::cerr << "Unexpected path length" << std::endl;
+	}
+}
+
+BENCHMARK(structuredClassFields)
+{
+	Logger logger;
+	Manager mgr;
+	Rooted<SystemTypesystem> sys{new SystemTypesystem(mgr)};
+	Rooted<Ontology> ontology{new Ontology(mgr, sys, "inheritance")};
+
+	// Build a chain of classes, each one inheriting from the previous one and
+	// declaring some fields of its own
+	Rooted<StructuredClass> current;
+	for (size_t i = 0; i < N_CLASSES; i++) {
+		Rooted<StructuredClass> strct{
+		    new StructuredClass(mgr, "c" + std::to_string(i), ontology,
+		                        Cardinality::any(), current, false, true)};
+		for (size_t j = 0; j < N_FIELDS; j++) {
+			strct->createPrimitiveFieldDescriptor(
+			    sys->getStringType(), logger,
+			    FieldDescriptor::FieldType::SUBTREE,
+			    "f" + std::to_string(i) + "_" + std::to_string(j));
+		}
+		current = strct;
+	}
+	if (!ontology->validate(logger)) {
+		std::cerr << "Could not validate the ontology" << std::endl;
+		return;
+	}
+
+	const std::string name = "f0_0";
+	ssize_t found = 0;
+	{
+		// Reporting an invalidation before each lookup defeats the field table
+		benchmark::Timer t;
+		for (size_t i = 0; i < N_LOOKUPS; i++) {
+			mgr.invalidated();
+			found += current->getFieldDescriptorIndex(name);
+			found += current->getFieldDescriptor(name) != nullptr;
+		}
+		benchmark::report("uncached", N_LOOKUPS / t.elapsed() / 1e3,
+		                  "klookups/s");
+	}
+	{
+		benchmark::Timer t;
+		for (size_t i = 0; i < N_LOOKUPS; i++) {
+			found += current->getFieldDescriptorIndex(name);
+			found += current->getFieldDescriptor(name) != nullptr;
+		}
+		benchmark::report("cached", N_LOOKUPS / t.elapsed() / 1e3,
+		                  "klookups/s");
+	}
+	if (found != ssize_t(2 * N_LOOKUPS)) {
+		std::cerr << "Could not find the field" << std::endl;
+	}
+}
+}
@@ -0,0 +1,103 @@
+/*
+    Ousía
+    Copyright (C) 2014, 2015  Benjamin Paaßen, Andreas Stöckel
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <core/common/Logger.hpp>
+#include <core/model/Document.hpp>
+#include <core/model/Ontology.hpp>
+#include <core/parser/ParserScope.hpp>
+
+#include <core/model/TestOntology.hpp>
+
+#include <benchmark/Benchmark.hpp>
+
+namespace ousia {
+
+namespace {
+
+/**
+ * Number of paragraphs already present in the section on the stack.
+ */
+constexpr size_t N_PARAGRAPHS = 100;
+
+/**
+ * Number of times the paragraph class is resolved.
+ */
+constexpr size_t N_RESOLVE = 100000;
+}
+
+BENCHMARK(parserScopeResolve)
+{
+	Logger logger;
+	Manager mgr;
+	Rooted<SystemTypesystem> sys{new SystemTypesystem(mgr)};
+	Rooted<Ontology> ontology = constructBookOntology(mgr, sys, logger);
+	Rooted<StructuredClass> bookClass = ontology->getStructureClasses()[0];
+	Rooted<StructuredClass> sectionClass = ontology->getStructureClasses()[1];
+	Rooted<StructuredClass> paragraphClass =
+	    ontology->getStructureClasses()[2];
+
+	// Build the stack the DocumentHandler has while parsing the paragraphs of
+	// a section
+	Rooted<Document> doc{new Document(mgr, "doc")};
+	doc->referenceOntology(ontology);
+	Rooted<StructuredEntity> book = doc->createRootStructuredEntity(bookClass);
+	Rooted<StructuredEntity> section =
+	    book->createChildStructuredEntity(sectionClass);
+	for (size_t i = 0; i < N_PARAGRAPHS; i++) {
+		section->createChildStructuredEntity(paragraphClass);
+	}
+	ParserScope scope;
+	scope.push(doc);
+	scope.push(book);
+	scope.push(section);
+
+	const std::vector<std::string> path{"paragraph"};
+	size_t found = 0;
+	{
+		// Reporting a change before each lookup defeats the cache
+		benchmark::Timer t;
+		for (size_t i = 0; i < N_RESOLVE; i++) {
+			mgr.namesChanged();
+			found += scope.resolve<StructuredClass>(path, logger) != nullptr;
+		}
+		benchmark::report("uncached", N_RESOLVE / t.elapsed() / 1e6,
+		                  "Mresolves/s");
+	}
+	{
+		const size_t hits = scope.getResolutionCacheHits();
+		benchmark::Timer t;
+		for (size_t i = 0; i < N_RESOLVE; i++) {
+			found += scope.resolve<StructuredClass>(path, logger) != nullptr;
+		}
+		benchmark::report("cached", N_RESOLVE / t.elapsed() / 1e6,
+		                  "Mresolves/s");
+		benchmark::report(
+		    "hit rate",
+		    double(scope.getResolutionCacheHits() - hits) / N_RESOLVE * 100.0,
+		    "%");
+	}
+	if (found != 2 * N_RESOLVE) {
+		std::cerr << "Could not resolve the paragraph class" << std::endl;
+	}
+}
+}
+
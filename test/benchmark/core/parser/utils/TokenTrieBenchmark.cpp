@@ -0,0 +1,110 @@
+/*
+    Ousía
+    Copyright (C) 2014, 2015  Benjamin Paaßen, Andreas Stöckel
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <string>
+#include <vector>
+
+#include <core/parser/utils/TokenTrie.hpp>
+
+#include <benchmark/Benchmark.hpp>
+
+namespace ousia {
+
+namespace {
+
+/**
+ * Tokens registered in the trie, similar to the OSML tokens plus a set of
+ * user defined tokens.
+ */
+const std::vector<std::string> TOKENS{
+    "\\", "%", "%{", "}%", "{", "}", "{!", "<\\", "\\>", "**", "__", "~~",
+    "==", "--", "->", "=>", "<=", "::", "..", "!!", "??", "++", "##", "$$"};
+
+/**
+ * Number of characters in the generated text.
+ */
+constexpr size_t TEXT_SIZE = 16 * 1000 * 1000;
+
+/**
+ * Generates text consisting of the characters used in the tokens and some
+ * letters.
+ */
+std::string generateText(size_t size)
+{
+	static const std::string CHARS = "\\%{}!<>*_~=-:.?+#$abc";
+	uint32_t v = 0xF3A99148;
+	std::string res;
+	res.reserve(size);
+	while (res.size() < size) {
+		v = v ^ (v >> 17);
+		v = v ^ (v << 15);
+		v = v ^ (v >> 5);
+		res.push_back(CHARS[v % CHARS.size()]);
+	}
+	return res;
+}
+}
+
+BENCHMARK(tokenTrieLookup)
+{
+	TokenTrie trie;
+	for (size_t i = 0; i < TOKENS.size(); i++) {
+		trie.registerToken(TOKENS[i], i);
+	}
+	const std::string text = generateText(TEXT_SIZE);
+
+	// Start a lookup at each character and advance it until it fails, once
+	// by traversing the trie nodes and once using the transition table
+	size_t matches = 0;
+	{
+		benchmark::Timer t;
+		for (size_t i = 0; i < text.size(); i++) {
+			const TokenTrie::Node *node = trie.getRoot();
+			for (size_t j = i; j < text.size(); j++) {
+				auto it = node->children.find(text[j]);
+				if (it == node->children.end()) {
+					break;
+				}
+				node = it->second.get();
+				matches += node->id != Tokens::Empty;
+			}
+		}
+		benchmark::report("trie nodes", text.size() / t.elapsed() / 1e6,
+		                  "Mchars/s");
+	}
+	{
+		benchmark::Timer t;
+		const TokenTrie::Table &table = trie.getTable();
+		for (size_t i = 0; i < text.size(); i++) {
+			TokenTrie::Table::State state = TokenTrie::Table::ROOT;
+			for (size_t j = i; j < text.size(); j++) {
+				state = table.next(state, text[j]);
+				if (state == TokenTrie::Table::NONE) {
+					break;
+				}
+				matches -= table.id(state) != Tokens::Empty;
+			}
+		}
+		benchmark::report("transition table", text.size() / t.elapsed() / 1e6,
+		                  "Mchars/s");
+	}
+	if (matches != 0) {
+		benchmark::report("mismatch", matches, "");
+	}
+}
+}
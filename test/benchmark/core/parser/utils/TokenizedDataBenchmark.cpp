@@ -0,0 +1,129 @@
+/*
+    Ousía
+    Copyright (C) 2014, 2015  Benjamin Paaßen, Andreas Stöckel
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <string>
+#include <vector>
+
+#include <core/parser/utils/TokenizedData.hpp>
+
+#include <benchmark/Benchmark.hpp>
+
+namespace ousia {
+
+namespace {
+
+/**
+ * Number of characters appended to the TokenizedData instance.
+ */
+constexpr size_t TEXT_SIZE = 16 * 1000 * 1000;
+
+/**
+ * Generates prose consisting of lines of words separated by linebreaks.
+ */
+std::string generateText(size_t size)
+{
+	static const std::string WORDS[] = {"lorem", "ipsum", "dolor", "sit",
+	                                    "amet",  "consectetur", "adipiscing"};
+	uint32_t v = 0xF3A99148;
+	std::string res;
+	res.reserve(size + 16);
+	while (res.size() < size) {
+		v = v ^ (v >> 17);
+		v = v ^ (v << 15);
+		v = v ^ (v >> 5);
+		res.append(WORDS[v % 7]);
+		res.push_back(v % 13 == 0 ? '\n' : ' ');
+	}
+	return res;
+}
+}
+
+BENCHMARK(tokenizedDataMemory)
+{
+	const std::string text = generateText(TEXT_SIZE);
+
+	// Append the text character by character, as done by the Tokenizer while
+	// matching tokens
+	{
+		const size_t bytes = benchmark::allocatedBytes();
+		benchmark::Timer t;
+		TokenizedData data;
+		for (size_t i = 0; i < text.size(); i++) {
+			data.append(text[i], i, i + 1);
+		}
+		benchmark::report("char append throughput",
+		                  text.size() / t.elapsed() / 1e6, "MB/s");
+		benchmark::report("char append memory",
+		                  double(benchmark::allocatedBytes() - bytes) /
+		                      text.size(),
+		                  "bytes/char");
+	}
+
+	// Append the text in spans of 64 bytes, as done by the Tokenizer for text
+	// which cannot contain tokens
+	{
+		const size_t bytes = benchmark::allocatedBytes();
+		benchmark::Timer t;
+		TokenizedData data;
+		for (size_t i = 0; i < text.size(); i += 64) {
+			const size_t len = std::min<size_t>(64, text.size() - i);
+			data.appendSpan(&text[i], len, i);
+		}
+		benchmark::report("span append throughput",
+		                  text.size() / t.elapsed() / 1e6, "MB/s");
+		benchmark::report("span append memory",
+		                  double(benchmark::allocatedBytes() - bytes) /
+		                      text.size(),
+		                  "bytes/char");
+	}
+}
+
+BENCHMARK(tokenizedDataRead)
+{
+	// Read the text as paragraphs of 4096 characters with each whitespace mode
+	const std::string text = generateText(TEXT_SIZE);
+	constexpr size_t PARAGRAPH_SIZE = 4096;
+	std::vector<TokenizedData> paragraphs;
+	for (size_t i = 0; i < text.size(); i += PARAGRAPH_SIZE) {
+		const size_t len = std::min(PARAGRAPH_SIZE, text.size() - i);
+		paragraphs.emplace_back(text.substr(i, len), i);
+	}
+
+	for (WhitespaceMode mode :
+	     {WhitespaceMode::PRESERVE, WhitespaceMode::TRIM,
+	      WhitespaceMode::COLLAPSE}) {
+		benchmark::Timer t;
+		size_t size = 0;
+		Token token;
+		for (const TokenizedData &data : paragraphs) {
+			TokenizedDataReader reader = data.reader();
+			while (reader.read(token, TokenSet{}, mode)) {
+				size += token.content.size();
+			}
+		}
+		const std::string name = mode == WhitespaceMode::PRESERVE
+		                             ? "preserve"
+		                             : mode == WhitespaceMode::TRIM
+		                                   ? "trim"
+		                                   : "collapse";
+		benchmark::report(name + " throughput",
+		                  text.size() / t.elapsed() / 1e6, "MB/s");
+		benchmark::report(name + " output", size, "bytes");
+	}
+}
+}
@@ -0,0 +1,167 @@
+/*
+    Ousía
+    Copyright (C) 2014, 2015  Benjamin Paaßen, Andreas Stöckel
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <string>
+#include <vector>
+
+#include <core/common/CharReader.hpp>
+#include <core/parser/utils/TokenizedData.hpp>
+#include <core/parser/utils/Tokenizer.hpp>
+
+#include <benchmark/Benchmark.hpp>
+
+namespace ousia {
+
+namespace {
+
+/**
+ * Primary tokens registered in the tokenizer, similar to the OSML tokens.
+ */
+const std::vector<std::string> PRIMARY_TOKENS{"\\", "%", "%{", "}%", "{",
+                                              "}", "{!", "<\\", "\\>"};
+
+/**
+ * Non-primary tokens registered in the tokenizer.
+ */
+const std::vector<std::string> NON_PRIMARY_TOKENS{"**", "__", "->", "=>"};
+
+/**
+ * Number of characters in the generated text.
+ */
+constexpr size_t TEXT_SIZE = 8 * 1000 * 1000;
+
+/**
+ * Generates text consisting of words interspersed with registered tokens.
+ */
+std::string generateText(size_t size)
+{
+	static const std::vector<std::string> WORDS{
+	    "lorem", "ipsum", "dolor", "sit", "amet", "\\emph", "{", "}", "**",
+	    "->", "%{", "}%", "\n", "<\\", "\\>", "__", "=>", "{!", "%"};
+	uint32_t v = 0xF3A99148;
+	std::string res;
+	res.reserve(size + 16);
+	while (res.size() < size) {
+		v = v ^ (v >> 17);
+		v = v ^ (v << 15);
+		v = v ^ (v >> 5);
+		res.append(WORDS[v % WORDS.size()]);
+		res.push_back(' ');
+	}
+	return res;
+}
+}
+
+BENCHMARK(tokenizerAllocations)
+{
+	Tokenizer tokenizer;
+	for (const std::string &token : PRIMARY_TOKENS) {
+		tokenizer.registerToken(token, true);
+	}
+	for (const std::string &token : NON_PRIMARY_TOKENS) {
+		tokenizer.registerToken(token, false);
+	}
+	const std::string text = generateText(TEXT_SIZE);
+
+	// Read all tokens, clear the data after each token as the parsers do. The
+	// first half of the text warms up the scratch buffers, allocations are
+	// only counted for the second half.
+	CharReader reader(text);
+	TokenizedData data;
+	Token token;
+	size_t tokens = 0;
+	size_t allocations = 0;
+	benchmark::Timer t;
+	while (tokenizer.read(reader, token, data)) {
+		data.clear();
+		if (reader.getOffset() < text.size() / 2) {
+			allocations = benchmark::allocationCount();
+			continue;
+		}
+		tokens++;
+	}
+	const double elapsed = t.elapsed();
+	allocations = benchmark::allocationCount() - allocations;
+
+	benchmark::report("throughput", text.size() / elapsed / 1e6, "MB/s");
+	benchmark::report("tokens", tokens, "");
+	benchmark::report("allocations per token", double(allocations) / tokens,
+	                  "");
+}
+
+BENCHMARK(tokenizerEngines)
+{
+	// Register many user defined tokens built from a small set of characters,
+	// so that many token prefixes overlap in the text
+	static const std::string CHARS = "=-<>*~";
+	std::vector<std::string> userTokens;
+	uint32_t v = 0x2545F491;
+	while (userTokens.size() < 256) {
+		std::string token;
+		v = v ^ (v >> 17);
+		v = v ^ (v << 15);
+		v = v ^ (v >> 5);
+		for (uint32_t w = v; token.size() < 2 + v % 15; w /= CHARS.size()) {
+			token.push_back(CHARS[w % CHARS.size()]);
+		}
+		userTokens.push_back(token);
+	}
+
+	// Generate text containing runs of these characters between words
+	std::string text;
+	text.reserve(TEXT_SIZE + 64);
+	while (text.size() < TEXT_SIZE) {
+		v = v ^ (v >> 17);
+		v = v ^ (v << 15);
+		v = v ^ (v >> 5);
+		text.append("word ");
+		for (size_t i = 0; i < 4 + v % 24; i++) {
+			text.push_back(CHARS[(v >> i) % CHARS.size()]);
+		}
+		text.push_back(' ');
+	}
+
+	for (Tokenizer::Engine engine :
+	     {Tokenizer::Engine::LOOKUPS, Tokenizer::Engine::AHO_CORASICK}) {
+		Tokenizer tokenizer{engine};
+		for (const std::string &token : PRIMARY_TOKENS) {
+			tokenizer.registerToken(token, true);
+		}
+		for (size_t i = 0; i < userTokens.size(); i++) {
+			tokenizer.registerToken(userTokens[i], i % 2 == 0);
+		}
+
+		CharReader reader(text);
+		TokenizedData data;
+		Token token;
+		size_t tokens = 0;
+		benchmark::Timer t;
+		while (tokenizer.read(reader, token, data)) {
+			data.clear();
+			tokens++;
+		}
+		const double elapsed = t.elapsed();
+		const std::string name = engine == Tokenizer::Engine::LOOKUPS
+		                             ? "lookups"
+		                             : "aho-corasick";
+		benchmark::report(name + " throughput", text.size() / elapsed / 1e6,
+		                  "MB/s");
+		benchmark::report(name + " tokens", tokens, "");
+	}
+}
+}
@@ -0,0 +1,136 @@
+/*
+    Ousía
+    Copyright (C) 2014, 2015  Benjamin Paaßen, Andreas Stöckel
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <iostream>
+#include <string>
+
+#include <core/common/Logger.hpp>
+#include <core/frontend/TerminalLogger.hpp>
+#include <core/model/Document.hpp>
+#include <core/resource/ResourceCache.hpp>
+#include <core/resource/ResourceLocator.hpp>
+#include <core/StandaloneEnvironment.hpp>
+#include <formats/osml/OsmlParser.hpp>
+
+#include <benchmark/Benchmark.hpp>
+
+namespace ousia {
+
+namespace {
+
+/**
+ * Number of structs in the generated typesystem.
+ */
+constexpr size_t TYPE_COUNT = 100;
+
+/**
+ * Number of structured classes in the generated ontology.
+ */
+constexpr size_t CLASS_COUNT = 1000;
+
+/**
+ * Number of times each configuration is parsed.
+ */
+constexpr size_t RUNS = 5;
+
+/**
+ * Stores a typesystem, an ontology importing it and a small document
+ * importing the ontology in the given locator.
+ */
+void generateResources(StaticResourceLocator &locator)
+{
+	std::string types = "\\typesystem#types\n";
+	for (size_t i = 0; i < TYPE_COUNT; i++) {
+		const std::string n = std::to_string(i);
+		types += "\t\\struct#t" + n + "\n\t\t\\field#a[type=int,default=" +
+		         n + "]\n\t\t\\field#b[type=string,default=\"" + n + "\"]\n";
+	}
+
+	std::string ontology =
+	    "\\ontology#big\n\t\\import[typesystem]{types.osml}\n"
+	    "\t\\struct#root[root=true]\n\t\t\\field\n"
+	    "\t\t\t\\childRef[ref=c0]\n";
+	for (size_t i = 0; i < CLASS_COUNT; i++) {
+		const std::string n = std::to_string(i);
+		ontology += "\t\\struct#c" + n;
+		if (i > 0) {
+			ontology += "[isa=c" + std::to_string(i / 2) + "]";
+		}
+		ontology += "\n\t\t\\attributes\n\t\t\t\\attribute#v" + n +
+		            "[type=t" + std::to_string(i % TYPE_COUNT) +
+		            ",default=[]]\n\t\t\\primitive#p" + n +
+		            "[type=string,optional=true]\n";
+	}
+
+	locator.store("types.osml", types);
+	locator.store("big.osml", ontology);
+	locator.store("doc.osml",
+	              "\\begin{document}\n\\import[ontology]{big.osml}\n"
+	              "\\begin{root}\n\\c1{Text}\n\\end{root}\n"
+	              "\\end{document}\n");
+}
+
+/**
+ * Parses the generated document and returns the time needed in seconds.
+ */
+double parse(StaticResourceLocator &locator, ResourceCache *cache)
+{
+	TerminalLogger logger{std::cerr};
+	OsmlParser parser;
+	StandaloneEnvironment env(logger);
+	env.registry.registerDefaultExtensions();
+	env.registry.registerParser({"text/vnd.ousia.osml"}, {&RttiTypes::Node},
+	                            &parser);
+	env.registry.registerResourceLocator(&locator);
+	env.resourceManager.setCache(cache);
+
+	benchmark::Timer t;
+	Rooted<Node> node =
+	    env.parse("doc.osml", "", "", RttiSet{&RttiTypes::Document});
+	const double elapsed = t.elapsed();
+	if (node == nullptr || logger.hasError()) {
+		std::cerr << "Error while parsing the generated document" << std::endl;
+	}
+	return elapsed;
+}
+}
+
+BENCHMARK(resourceCacheColdWarm)
+{
+	StaticResourceLocator locator;
+	generateResources(locator);
+
+	double uncached = 0.0, cold = 0.0, warm = 0.0;
+	for (size_t i = 0; i < RUNS; i++) {
+		uncached += parse(locator, nullptr);
+
+		// The first run with an empty cache parses and stores the resources,
+		// the second one reads them from the cache
+		StaticResourceCache cache;
+		cold += parse(locator, &cache);
+		warm += parse(locator, &cache);
+		if (cache.getHits() != 2) {
+			std::cerr << "Expected two cache hits" << std::endl;
+		}
+	}
+	benchmark::report("uncached", uncached / RUNS * 1e3, "ms");
+	benchmark::report("cold start", cold / RUNS * 1e3, "ms");
+	benchmark::report("warm start", warm / RUNS * 1e3, "ms");
+	benchmark::report("speedup", uncached / warm, "x");
+}
+}
@@ -0,0 +1,126 @@
+/*
+    Ousía
+    Copyright (C) 2014, 2015  Benjamin Paaßen, Andreas Stöckel
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <string>
+#include <vector>
+
+#include <core/common/CharReader.hpp>
+#include <core/common/Logger.hpp>
+#include <formats/osml/OsmlStreamParser.hpp>
+
+#include <benchmark/Benchmark.hpp>
+
+namespace ousia {
+
+namespace {
+
+/**
+ * Size of the generated OSML document in bytes.
+ */
+constexpr size_t DOCUMENT_SIZE = 16 * 1000 * 1000;
+
+/**
+ * Generates a prose-heavy OSML document of (roughly) the given size.
+ */
+std::string generateOsml(size_t size)
+{
+	static const std::string PARAGRAPH =
+	    "\\paragraph Lorem ipsum dolor sit amet, consectetur adipiscing elit, "
+	    "sed do eiusmod tempor incididunt ut labore et dolore magna aliqua. "
+	    "Ut enim ad minim veniam, quis nostrud exercitation ullamco laboris "
+	    "nisi ut aliquip ex ea commodo consequat. Duis aute irure dolor in "
+	    "reprehenderit in \\emph{voluptate} velit esse cillum dolore eu "
+	    "fugiat nulla pariatur. Excepteur sint occaecat cupidatat non "
+	    "proident, sunt in culpa qui officia deserunt mollit anim id est "
+	    "laborum.\n\n";
+	std::string res = "\\begin{document}\n\\import[ontology]{book}\n";
+	res.reserve(size + PARAGRAPH.size());
+	while (res.size() < size) {
+		res.append(PARAGRAPH);
+	}
+	res.append("\\end{document}\n");
+	return res;
+}
+
+/**
+ * User defined tokens, e.g. registered by the syntax descriptors of an
+ * ontology.
+ */
+const std::vector<std::string> USER_TOKENS{
+    "**", "__", "~~", "==", "--", "->", "=>", "<=", "::", "..", "!!", "??",
+    "++", "##", "$$", "@@", "^^", "||", "&&", "''"};
+
+/**
+ * Generates an OSML document of (roughly) the given size making heavy use of
+ * the user defined tokens.
+ */
+std::string generateOsmlUserTokens(size_t size)
+{
+	static const std::string PARAGRAPH =
+	    "\\paragraph Lorem **ipsum** dolor -> sit amet, __consectetur__ "
+	    "adipiscing => elit: sed ~~do~~ eiusmod == tempor. Incididunt ut "
+	    "labore !! et dolore ?? magna :: aliqua... Ut ++enim++ ad ##minim## "
+	    "veniam, $$quis$$ nostrud @@exercitation@@ <= ullamco ^^laboris^^ "
+	    "nisi || ut && aliquip ''ex'' ea - commodo = consequat.\n\n";
+	std::string res = "\\begin{document}\n\\import[ontology]{book}\n";
+	res.reserve(size + PARAGRAPH.size());
+	while (res.size() < size) {
+		res.append(PARAGRAPH);
+	}
+	res.append("\\end{document}\n");
+	return res;
+}
+}
+
+BENCHMARK(osmlStreamParserProse)
+{
+	const std::string doc = generateOsml(DOCUMENT_SIZE);
+
+	Logger logger;
+	CharReader reader{doc};
+	OsmlStreamParser parser{reader, logger};
+	size_t nData = 0;
+
+	benchmark::Timer t;
+	OsmlStreamParser::State state;
+	while ((state = parser.parse()) != OsmlStreamParser::State::END) {
+		if (state == OsmlStreamParser::State::DATA) {
+			nData++;
+		}
+	}
+	benchmark::report("parse", doc.size() / t.elapsed() / 1e6, "MB/s");
+	benchmark::report("data events", nData, "");
+}
+
+BENCHMARK(osmlStreamParserUserTokens)
+{
+	const std::string doc = generateOsmlUserTokens(DOCUMENT_SIZE);
+
+	Logger logger;
+	CharReader reader{doc};
+	OsmlStreamParser parser{reader, logger};
+	for (const std::string &token : USER_TOKENS) {
+		parser.registerToken(token);
+	}
+
+	benchmark::Timer t;
+	while (parser.parse() != OsmlStreamParser::State::END) {
+	}
+	benchmark::report("parse", doc.size() / t.elapsed() / 1e6, "MB/s");
+}
+}
@@ -433,6 +433,301 @@ TEST(Buffer, streamMoveForward)
 	buf.deleteCursor(cursor);
 }
 
+TEST(Buffer, streamReadRange)
+{
+	VectorReadState state(DATA);
+
+	Buffer buf{readFromVector, &state};
+	Buffer::CursorId cur1 = buf.createCursor();
+	Buffer::CursorId cur2 = buf.createCursor();
+
+	// Read the data in odd-sized chunks spanning multiple buckets, interleave
+	// with reading single characters from the second cursor
+	std::vector<char> res1;
+	std::vector<char> res2;
+	std::vector<char> chunk(12345);
+	char c;
+	while (true) {
+		const size_t n = buf.read(cur1, chunk.data(), chunk.size());
+		res1.insert(res1.end(), chunk.begin(), chunk.begin() + n);
+		ASSERT_EQ(res1.size(), buf.offset(cur1));
+		for (size_t i = 0; i < n && buf.read(cur2, c); i++) {
+			res2.push_back(c);
+		}
+		if (n < chunk.size()) {
+			break;
+		}
+	}
+	while (buf.read(cur2, c)) {
+		res2.push_back(c);
+	}
+
+	ASSERT_TRUE(buf.atEnd(cur1));
+	ASSERT_EQ(0U, buf.read(cur1, chunk.data(), chunk.size()));
+	ASSERT_EQ(DATA, res1);
+	ASSERT_EQ(DATA, res2);
+
+	buf.deleteCursor(cur1);
+	buf.deleteCursor(cur2);
+}
+
+TEST(Buffer, streamReleaseBuckets)
+{
+	VectorReadState state(DATA);
+
+	Buffer buf{readFromVector, &state};
+	Buffer::CursorId cur1 = buf.createCursor();
+	Buffer::CursorId cur2 = buf.createCursor();
+
+	// Let the first cursor run far ahead, then let the second cursor catch up
+	// so the buckets in between are no longer reachable and can be released
+	// once new data is streamed
+	std::vector<char> res1;
+	std::vector<char> res2;
+	char c;
+	for (size_t i = 0; i < DATA_LENGTH / 2 && buf.read(cur1, c); i++) {
+		res1.push_back(c);
+	}
+	while (buf.offset(cur2) < buf.offset(cur1) && buf.read(cur2, c)) {
+		res2.push_back(c);
+	}
+	while (buf.read(cur1, c)) {
+		res1.push_back(c);
+		if (buf.read(cur2, c)) {
+			res2.push_back(c);
+		}
+	}
+	while (buf.read(cur2, c)) {
+		res2.push_back(c);
+	}
+
+	ASSERT_EQ(DATA, res1);
+	ASSERT_EQ(DATA, res2);
+
+	// Moving backward is still possible within the current buckets
+	ASSERT_EQ(-100, buf.moveCursor(cur2, -100));
+	ASSERT_EQ(DATA_LENGTH - 100, buf.offset(cur2));
+
+	buf.deleteCursor(cur1);
+	buf.deleteCursor(cur2);
+}
+
+TEST(Buffer, ringStreamTwoCursors)
+{
+	VectorReadState state(DATA);
+
+	// The second cursor stays at the beginning, the ring has to grow until it
+	// can hold the complete data
+	Buffer buf{readFromVector, &state, Buffer::Storage::RING};
+	Buffer::CursorId cur1 = buf.createCursor();
+	Buffer::CursorId cur2 = buf.createCursor();
+
+	char c;
+	std::vector<char> res1;
+	while (buf.read(cur1, c)) {
+		res1.push_back(c);
+	}
+
+	ASSERT_TRUE(buf.atEnd(cur1));
+	ASSERT_FALSE(buf.atEnd(cur2));
+	ASSERT_EQ(DATA_LENGTH, buf.offset(cur1));
+	ASSERT_EQ(0U, buf.offset(cur2));
+
+	std::vector<char> res2;
+	while (buf.read(cur2, c)) {
+		res2.push_back(c);
+	}
+
+	ASSERT_TRUE(buf.atEnd(cur2));
+	ASSERT_EQ(DATA_LENGTH, buf.offset(cur2));
+	ASSERT_EQ(DATA, res1);
+	ASSERT_EQ(DATA, res2);
+
+	buf.deleteCursor(cur1);
+	buf.deleteCursor(cur2);
+}
+
+TEST(Buffer, ringStreamTwoCursorsMovingInterleaved)
+{
+	VectorReadState state(DATA);
+
+	// Both cursors advance at the same speed, so the data wraps around at the
+	// end of the ring
+	Buffer buf{readFromVector, &state, Buffer::Storage::RING};
+	Buffer::CursorId cur1 = buf.createCursor();
+	Buffer::CursorId cur2 = buf.createCursor();
+
+	char c;
+	std::vector<char> res1;
+	std::vector<char> res2;
+	while (!buf.atEnd(cur1) || !buf.atEnd(cur2)) {
+		for (int i = 0; i < 100; i++) {
+			if (buf.read(cur1, c)) {
+				res1.push_back(c);
+			}
+		}
+		for (int i = 0; i < 120; i++) {
+			if (buf.read(cur2, c)) {
+				res2.push_back(c);
+			}
+		}
+
+		// Move cur2 120 bytes backward and read the content again
+		res2.resize(res2.size() - 120);
+		ASSERT_EQ(-120, buf.moveCursor(cur2, -120));
+		for (int i = 0; i < 120; i++) {
+			if (buf.read(cur2, c)) {
+				res2.push_back(c);
+			}
+		}
+
+		// Move cur1 60 bytes forward and backward
+		buf.moveCursor(cur1, -buf.moveCursor(cur1, 60));
+
+		// Make sure the cursor position is correct
+		ASSERT_EQ(res1.size(), buf.offset(cur1));
+		ASSERT_EQ(res2.size(), buf.offset(cur2));
+	}
+
+	ASSERT_EQ(DATA, res1);
+	ASSERT_EQ(DATA, res2);
+
+	buf.deleteCursor(cur1);
+	buf.deleteCursor(cur2);
+}
+
+TEST(Buffer, ringStreamMoveForward)
+{
+	VectorReadState state(DATA);
+
+	Buffer buf{readFromVector, &state, Buffer::Storage::RING};
+	Buffer::CursorId cursor = buf.createCursor();
+	ASSERT_EQ(ssize_t(DATA_LENGTH) - 100,
+	          buf.moveCursor(cursor, DATA_LENGTH - 100));
+
+	char c;
+	std::vector<char> res;
+	while (buf.read(cursor, c)) {
+		res.push_back(c);
+	}
+	ASSERT_EQ(std::vector<char>(DATA.end() - 100, DATA.end()), res);
+
+	// It must be possible to look back at least a few bytes
+	ASSERT_EQ(-128, buf.moveCursor(cursor, -128));
+	ASSERT_TRUE(buf.read(cursor, c));
+	ASSERT_EQ(DATA[DATA_LENGTH - 128], c);
+
+	buf.deleteCursor(cursor);
+}
+
+TEST(Buffer, ringStreamReadRange)
+{
+	VectorReadState state(DATA);
+
+	Buffer buf{readFromVector, &state, Buffer::Storage::RING};
+	Buffer::CursorId cur1 = buf.createCursor();
+	Buffer::CursorId cur2 = buf.createCursor();
+
+	// Read the data in odd-sized chunks wrapping around at the end of the
+	// ring, interleave with reading single characters from the second cursor
+	std::vector<char> res1;
+	std::vector<char> res2;
+	std::vector<char> chunk(12345);
+	char c;
+	while (true) {
+		const size_t n = buf.read(cur1, chunk.data(), chunk.size());
+		res1.insert(res1.end(), chunk.begin(), chunk.begin() + n);
+		ASSERT_EQ(res1.size(), buf.offset(cur1));
+		for (size_t i = 0; i < n && buf.read(cur2, c); i++) {
+			res2.push_back(c);
+		}
+		if (n < chunk.size()) {
+			break;
+		}
+	}
+	while (buf.read(cur2, c)) {
+		res2.push_back(c);
+	}
+
+	ASSERT_TRUE(buf.atEnd(cur1));
+	ASSERT_EQ(0U, buf.read(cur1, chunk.data(), chunk.size()));
+	ASSERT_EQ(DATA, res1);
+	ASSERT_EQ(DATA, res2);
+
+	buf.deleteCursor(cur1);
+	buf.deleteCursor(cur2);
+}
+
+TEST(Buffer, spanRead)
+{
+	Buffer buf{DATA.data(), DATA.size(), nullptr};
+	Buffer::CursorId cur1 = buf.createCursor();
+	Buffer::CursorId cur2 = buf.createCursor();
+
+	// Read the data with the first cursor in odd-sized chunks and char by char
+	// with the second cursor
+	std::vector<char> res1;
+	std::vector<char> res2;
+	std::vector<char> chunk(12345);
+	size_t n;
+	while ((n = buf.read(cur1, chunk.data(), chunk.size())) > 0) {
+		res1.insert(res1.end(), chunk.begin(), chunk.begin() + n);
+		ASSERT_EQ(res1.size(), buf.offset(cur1));
+	}
+	char c;
+	while (buf.read(cur2, c)) {
+		res2.push_back(c);
+	}
+
+	ASSERT_TRUE(buf.atEnd(cur1));
+	ASSERT_TRUE(buf.atEnd(cur2));
+	ASSERT_FALSE(buf.fetch(cur2, c));
+	ASSERT_EQ(DATA, res1);
+	ASSERT_EQ(DATA, res2);
+
+	buf.deleteCursor(cur1);
+	buf.deleteCursor(cur2);
+}
+
+TEST(Buffer, spanMoveCursor)
+{
+	Buffer buf{DATA.data(), DATA.size(), nullptr};
+	Buffer::CursorId cursor = buf.createCursor();
+
+	char c;
+	ASSERT_EQ(1000, buf.moveCursor(cursor, 1000));
+	ASSERT_EQ(1000U, buf.offset(cursor));
+	ASSERT_TRUE(buf.fetch(cursor, c));
+	ASSERT_EQ(DATA[1000], c);
+
+	ASSERT_EQ(-1000, buf.moveCursor(cursor, -2000));
+	ASSERT_EQ(0U, buf.offset(cursor));
+
+	ASSERT_EQ(ssize_t(DATA_LENGTH), buf.moveCursor(cursor, DATA_LENGTH + 5));
+	ASSERT_TRUE(buf.atEnd(cursor));
+
+	ASSERT_EQ(500U, buf.seekCursor(cursor, 500));
+	ASSERT_TRUE(buf.read(cursor, c));
+	ASSERT_EQ(DATA[500], c);
+	ASSERT_EQ(501U, buf.offset(cursor));
+
+	Buffer::CursorId copy = buf.createCursor(cursor);
+	ASSERT_EQ(501U, buf.offset(copy));
+
+	buf.deleteCursor(copy);
+	buf.deleteCursor(cursor);
+}
+
+TEST(Buffer, spanOwner)
+{
+	auto owner = std::make_shared<std::string>("test");
+	{
+		Buffer buf{owner->data(), owner->size(), owner};
+		ASSERT_EQ(2, owner.use_count());
+	}
+	ASSERT_EQ(1, owner.use_count());
+}
+
 /* CharReader Test */
 
 TEST(CharReader, simpleRead)
@@ -525,6 +820,205 @@ TEST(CharReader, stream)
 	ASSERT_EQ(DATA, res);
 }
 
+TEST(CharReader, readRaw)
+{
+	// Linebreaks must not be substituted
+	CharReader reader{"ab\r\ncd\n\ref"};
+	char c;
+	ASSERT_TRUE(reader.peek(c));
+	ASSERT_EQ('a', c);
+
+	char buf[5];
+	ASSERT_EQ(5U, reader.readRaw(buf, 5));
+	ASSERT_EQ("ab\r\nc", std::string(buf, 5));
+	ASSERT_EQ(5U, reader.getOffset());
+	ASSERT_EQ(5U, reader.getPeekOffset());
+
+	ASSERT_TRUE(reader.read(c));
+	ASSERT_EQ('d', c);
+	ASSERT_EQ(4U, reader.readRaw(buf, 5));
+	ASSERT_EQ("\n\ref", std::string(buf, 4));
+	ASSERT_TRUE(reader.atEnd());
+}
+
+TEST(CharReader, streamReadRaw)
+{
+	std::stringstream ss;
+	std::copy(DATA.begin(), DATA.end(), std::ostream_iterator<char>(ss));
+
+	std::vector<char> res;
+	std::vector<char> chunk(64 * 1024 + 7);
+	CharReader reader{ss};
+	size_t n;
+	while ((n = reader.readRaw(chunk.data(), chunk.size())) > 0) {
+		res.insert(res.end(), chunk.begin(), chunk.begin() + n);
+	}
+	ASSERT_EQ(DATA, res);
+	ASSERT_EQ(DATA_LENGTH, reader.getOffset());
+}
+
+TEST(CharReader, span)
+{
+	std::string testStr{"first line\n\n\rsecond line\n\rlast line"};
+	CharReader reader{std::make_shared<Buffer>(testStr.data(), testStr.size(),
+	                                           nullptr)};
+
+	// Line breaks are substituted just as for the copying Buffer
+	std::string res;
+	char c;
+	while (reader.read(c)) {
+		res.append(&c, 1);
+	}
+	ASSERT_EQ("first line\n\nsecond line\nlast line", res);
+	ASSERT_EQ(testStr.size(), reader.getOffset());
+	ASSERT_TRUE(reader.atEnd());
+
+	// Forks and raw reads operate on plain offsets
+	CharReader reader2{std::make_shared<Buffer>(testStr.data(),
+	                                            testStr.size(), nullptr)};
+	{
+		CharReaderFork fork = reader2.fork();
+		ASSERT_EQ(6U, fork.readRaw(&res[0], 6));
+		ASSERT_EQ("first ", res.substr(0, 6));
+		fork.commit();
+	}
+	ASSERT_EQ(6U, reader2.getOffset());
+	ASSERT_TRUE(reader2.read(c));
+	ASSERT_EQ('l', c);
+}
+
+TEST(CharReader, ringFork)
+{
+	VectorReadState state(DATA);
+	CharReader reader{std::make_shared<Buffer>(readFromVector, &state,
+	                                           Buffer::Storage::RING)};
+
+	// Read with a fork far ahead of the reader, commit the fork and continue
+	// reading with the reader
+	char c;
+	std::vector<char> res;
+	{
+		CharReaderFork fork = reader.fork();
+		for (size_t i = 0; i < DATA_LENGTH / 2; i++) {
+			ASSERT_TRUE(fork.read(c));
+			res.push_back(c);
+		}
+		ASSERT_EQ(0U, reader.getOffset());
+		fork.commit();
+	}
+	ASSERT_EQ(DATA_LENGTH / 2, reader.getOffset());
+	while (reader.read(c)) {
+		res.push_back(c);
+	}
+	ASSERT_EQ(DATA, res);
+}
+
+// Generates data containing all kinds of linebreak sequences
+static std::string generateLinebreakData(size_t len)
+{
+	static const char *PARTS[] = {"abc", "\n", "\r", "\r\n", "\n\r", "\n\n",
+	                              "defgh"};
+	uint32_t v = 0xF3A99148;
+	std::string res;
+	while (res.size() < len) {
+		v = v ^ (v >> 17);
+		v = v ^ (v << 15);
+		v = v ^ (v >> 5);
+		res.append(PARTS[v % 7]);
+	}
+	return res;
+}
+
+// Reads all characters from the reader using the span API
+static std::string readSpans(CharReader &reader, bool peek)
+{
+	std::string res;
+	const char *span;
+	size_t n;
+	while ((n = peek ? reader.peekSpan(span) : reader.span(span)) > 0) {
+		// Only consume a part of longer spans
+		n = std::min<size_t>(n, 7);
+		res.append(span, n);
+		if (peek) {
+			reader.skipPeek(n);
+		} else {
+			reader.consume(n);
+		}
+	}
+	return res;
+}
+
+TEST(CharReader, readSpans)
+{
+	const std::string testStr = generateLinebreakData(200 * 1024);
+
+	std::string expected;
+	{
+		CharReader reader{testStr};
+		char c;
+		while (reader.read(c)) {
+			expected.push_back(c);
+		}
+	}
+
+	for (bool peek : {false, true}) {
+		// Copying buffer
+		{
+			CharReader reader{testStr};
+			ASSERT_EQ(expected, readSpans(reader, peek));
+			if (peek) {
+				ASSERT_EQ(0U, reader.getOffset());
+				ASSERT_EQ(testStr.size(), reader.getPeekOffset());
+			} else {
+				ASSERT_EQ(testStr.size(), reader.getOffset());
+			}
+		}
+
+		// Streaming buffer, linebreak sequences cross bucket boundaries
+		for (auto storage : {Buffer::Storage::BUCKETS, Buffer::Storage::RING}) {
+			std::istringstream is(testStr);
+			CharReader reader{std::make_shared<Buffer>(is, storage)};
+			ASSERT_EQ(expected, readSpans(reader, peek));
+		}
+	}
+}
+
+TEST(CharReader, spanLinebreak)
+{
+	std::string testStr{"ab\n\rcd\ref\n"};
+	//                   01 2 345 678 9
+	CharReader reader{testStr};
+
+	// The '\n' is part of a linebreak sequence and not included in the span
+	const char *span;
+	ASSERT_EQ(2U, reader.span(span));
+	ASSERT_EQ("ab", std::string(span, 2));
+	reader.consume(2);
+
+	// Linebreak sequences are returned as a single character span
+	ASSERT_EQ(1U, reader.span(span));
+	ASSERT_EQ('\n', span[0]);
+	reader.consume(1);
+	ASSERT_EQ(4U, reader.getOffset());
+
+	ASSERT_EQ(2U, reader.span(span));
+	ASSERT_EQ("cd", std::string(span, 2));
+
+	// Consume across the linebreak
+	reader.consume(4);
+	ASSERT_EQ(8U, reader.getOffset());
+
+	// A trailing '\n' is returned as span of its own
+	ASSERT_EQ(1U, reader.span(span));
+	ASSERT_EQ('f', span[0]);
+	reader.consume(1);
+	ASSERT_EQ(1U, reader.span(span));
+	ASSERT_EQ('\n', span[0]);
+	reader.consume(1);
+	ASSERT_EQ(0U, reader.span(span));
+	ASSERT_TRUE(reader.atEnd());
+}
+
 TEST(CharReader, fork)
 {
 	std::string testStr{"first line\n\n\rsecond line\n\rlast line"};
@@ -0,0 +1,113 @@
+/*
+    Ousía
+    Copyright (C) 2014, 2015  Benjamin Paaßen, Andreas Stöckel
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <core/common/CharScanner.hpp>
+
+namespace ousia {
+
+static const std::vector<CharScanner::Implementation> IMPLEMENTATIONS{
+    CharScanner::Implementation::AUTO, CharScanner::Implementation::SCALAR,
+    CharScanner::Implementation::SSE2, CharScanner::Implementation::AVX2};
+
+TEST(CharScanner, empty)
+{
+	CharScanner scanner;
+	std::string data{"abc\n"};
+	ASSERT_EQ(0U, scanner.size());
+	ASSERT_FALSE(scanner.contains('\n'));
+	for (auto impl : IMPLEMENTATIONS) {
+		ASSERT_EQ(data.size(), scanner.find(data.data(), data.size(), impl));
+	}
+}
+
+TEST(CharScanner, contains)
+{
+	CharScanner scanner{"\\{}\xff"};
+	ASSERT_EQ(4U, scanner.size());
+	ASSERT_TRUE(scanner.contains('\\'));
+	ASSERT_TRUE(scanner.contains('{'));
+	ASSERT_TRUE(scanner.contains('}'));
+	ASSERT_TRUE(scanner.contains('\xff'));
+	ASSERT_FALSE(scanner.contains('a'));
+
+	scanner.add('{');
+	ASSERT_EQ(4U, scanner.size());
+
+	scanner.clear();
+	ASSERT_EQ(0U, scanner.size());
+	ASSERT_FALSE(scanner.contains('{'));
+}
+
+TEST(CharScanner, findPosition)
+{
+	// Place the character at all positions around the vector boundaries
+	CharScanner scanner{"\r\n"};
+	for (size_t size = 0; size < 100; size++) {
+		for (size_t pos = 0; pos <= size; pos++) {
+			std::string data(size, 'a');
+			if (pos < size) {
+				data[pos] = (pos % 2) ? '\r' : '\n';
+			}
+			for (auto impl : IMPLEMENTATIONS) {
+				ASSERT_EQ(pos, scanner.find(data.data(), data.size(), impl))
+				    << "size " << size << " pos " << pos;
+			}
+		}
+	}
+}
+
+TEST(CharScanner, findRandom)
+{
+	// Pseudo-random data
+	uint32_t v = 0xF3A99148;
+	std::string data;
+	for (size_t i = 0; i < 64 * 1024; i++) {
+		v = v ^ (v >> 17);
+		v = v ^ (v << 15);
+		v = v ^ (v >> 5);
+		data.push_back(v & 0xFF);
+	}
+
+	// Compare all implementations with the scalar one for different set
+	// sizes, including sets which are too large for the vector implementations
+	for (const std::string &chars :
+	     {std::string("\x80"), std::string("\\%{}<"),
+	      std::string("01234567"), std::string("0123456789abcdef")}) {
+		CharScanner scanner{chars};
+		size_t offs = 0;
+		while (offs < data.size()) {
+			const size_t expected =
+			    scanner.find(data.data() + offs, data.size() - offs,
+			                 CharScanner::Implementation::SCALAR);
+			for (auto impl : IMPLEMENTATIONS) {
+				ASSERT_EQ(expected, scanner.find(data.data() + offs,
+				                                 data.size() - offs, impl));
+			}
+			ASSERT_TRUE(expected == data.size() - offs ||
+			            scanner.contains(data[offs + expected]));
+			offs += expected + 1;
+		}
+	}
+}
+}
+
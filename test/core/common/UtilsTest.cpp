@@ -134,6 +134,40 @@ TEST(Utils, collapse)
 	ASSERT_EQ("long test", Utils::collapse("     long    test   "));
 }
 
+TEST(Utils, trimCollapseSpan)
+{
+	// Compare the span versions with the generic versions using a filter for
+	// random strings, including strings longer than the vector width
+	uint32_t v = 0x2545F491;
+	const std::string chars = "ab    \t\n\r";
+	for (size_t iteration = 0; iteration < 10000; iteration++) {
+		std::string s;
+		v = v ^ (v << 13);
+		v = v ^ (v >> 17);
+		v = v ^ (v << 5);
+		const size_t len = v % 80;
+		for (size_t i = 0; i < len; i++) {
+			v = v ^ (v << 13);
+			v = v ^ (v >> 17);
+			v = v ^ (v << 5);
+			s.push_back((v % 4 == 0) ? chars[v % chars.size()] : 'x');
+		}
+		auto filter = [&s](size_t i) { return Utils::isWhitespace(s[i]); };
+
+		size_t start1, end1, start2, end2;
+		ASSERT_EQ(Utils::trim(s, s.size(), start1, end1, filter),
+		          Utils::trim(s.data(), s.size(), start2, end2));
+		ASSERT_EQ(start1, start2);
+		ASSERT_EQ(end1, end2);
+
+		ASSERT_EQ(Utils::collapse(s, s.size(), start1, end1, filter),
+		          Utils::collapse(s.data(), s.size(), start2, end2))
+		    << "\"" << s << "\"";
+		ASSERT_EQ(start1, start2);
+		ASSERT_EQ(end1, end2);
+	}
+}
+
 TEST(Utils, isUserDefinedToken)
 {
 	EXPECT_FALSE(Utils::isUserDefinedToken(""));
@@ -517,6 +517,68 @@ TEST(Manager, fullyConnectedGraph)
 	}
 }
 
+TEST(Manager, fullyConnectedGraphIncremental)
+{
+	constexpr int nElem = 64;
+	std::array<bool, nElem> a;
+
+	Manager mgr(1, Manager::SweepMode::INCREMENTAL, 8);
+	{
+		Rooted<TestManaged> n = createFullyConnectedGraph(mgr, nElem, &a[0]);
+		for (bool v : a) {
+			ASSERT_TRUE(v);
+		}
+	}
+
+	for (bool v : a) {
+		ASSERT_FALSE(v);
+	}
+}
+
+TEST(Manager, sweepStep)
+{
+	constexpr int nCycles = 4;
+	std::array<bool, 2 * nCycles + 1> a;
+
+	Manager mgr(128, Manager::SweepMode::INCREMENTAL, 1);
+	{
+		// Create a number of independent cycles referenced by a rooted node
+		{
+			Rooted<TestManaged> root{new TestManaged(mgr, a[2 * nCycles])};
+			for (int i = 0; i < nCycles; i++) {
+				TestManaged *n1 = new TestManaged(mgr, a[2 * i]);
+				TestManaged *n2 = new TestManaged(mgr, a[2 * i + 1]);
+				root->addRef(n1);
+				n1->addRef(n2);
+				n2->addRef(n1);
+			}
+			for (bool v : a) {
+				ASSERT_TRUE(v);
+			}
+		}
+
+		// The root node is dead, the cycles are still alive as the threshold
+		// has not been reached
+		ASSERT_FALSE(a[2 * nCycles]);
+		for (int i = 0; i < 2 * nCycles; i++) {
+			ASSERT_TRUE(a[i]);
+		}
+
+		// Each step with a minimal budget should free exactly one cycle
+		for (int step = 1; step <= nCycles; step++) {
+			ASSERT_EQ(step == nCycles, mgr.sweepStep(1));
+			int nDead = 0;
+			for (int i = 0; i < nCycles; i++) {
+				ASSERT_EQ(a[2 * i], a[2 * i + 1]);
+				if (!a[2 * i]) {
+					nDead++;
+				}
+			}
+			ASSERT_EQ(step, nDead);
+		}
+	}
+}
+
 class HidingTestManaged : public TestManaged {
 private:
 	Rooted<Managed> hidden;
@@ -590,6 +652,179 @@ TEST(Manager, storeData)
 	ASSERT_FALSE(a[0] || a[1] || a[2] || a[3] || a[4]);
 }
 
+TEST(Manager, storeDataKey)
+{
+	Manager mgr(1);
+
+	std::array<bool, 3> a;
+
+	const DataKey key1 = mgr.internDataKey("key1");
+	const DataKey key2 = mgr.internDataKey("key2");
+	ASSERT_NE(key1, key2);
+	ASSERT_EQ(key1, mgr.internDataKey("key1"));
+	ASSERT_EQ("key2", mgr.getDataKeyName(key2));
+
+	{
+		Rooted<TestManaged> n{new TestManaged{mgr, a[0]}};
+
+		Managed *m1 = new TestManaged{mgr, a[1]};
+		mgr.storeData(n.get(), key1, m1);
+		ASSERT_EQ(m1, mgr.readData(n.get(), key1));
+		ASSERT_EQ(m1, mgr.readData(n.get(), "key1"));
+		ASSERT_EQ(nullptr, mgr.readData(n.get(), key2));
+		ASSERT_EQ(nullptr, mgr.readData(n.get(), "unknown"));
+
+		// Storing the same data twice must not leak a reference
+		mgr.storeData(n.get(), key1, m1);
+		mgr.storeData(n.get(), "key2", new TestManaged{mgr, a[2]});
+		ASSERT_TRUE(mgr.deleteData(n.get(), key1));
+		ASSERT_FALSE(a[1]);
+		ASSERT_TRUE(a[2]);
+		ASSERT_TRUE(mgr.deleteData(n.get(), "key2"));
+		ASSERT_FALSE(a[2]);
+		ASSERT_FALSE(mgr.deleteData(n.get(), key2));
+	}
+
+	ASSERT_FALSE(a[0] || a[1] || a[2]);
+}
+
+TEST(Manager, arena)
+{
+	std::array<bool, 3> a;
+
+	Manager mgr;
+	mgr.enableArena();
+	{
+		Rooted<TestManaged> n1{new (mgr) TestManaged(mgr, a[0])};
+		n1->addRef(new (mgr) TestManaged(mgr, a[1]));
+		n1->addRef(new TestManaged(mgr, a[2]));
+		ASSERT_TRUE(a[0] && a[1] && a[2]);
+
+		const ManagedArena::Statistics &stats = mgr.getArena()->getStatistics();
+		ASSERT_EQ(2U, stats.liveBlocks);
+		ASSERT_EQ(2U, stats.allocations);
+		ASSERT_LE(2 * sizeof(TestManaged), stats.liveBytes);
+		ASSERT_LE(stats.liveBytes, stats.reservedBytes);
+
+		auto types = mgr.getAllocationStatistics();
+		ASSERT_EQ(1U, types.size());
+		ASSERT_EQ(3U, types.begin()->second.count);
+		ASSERT_EQ(stats.liveBytes, types.begin()->second.bytes);
+	}
+	ASSERT_FALSE(a[0] || a[1] || a[2]);
+	ASSERT_EQ(0U, mgr.getArena()->getStatistics().liveBlocks);
+	ASSERT_EQ(0U, mgr.getArena()->getStatistics().liveBytes);
+	ASSERT_TRUE(mgr.getAllocationStatistics().empty());
+}
+
+TEST(Manager, bulkTeardown)
+{
+	std::array<bool, 3> a;
+	{
+		Manager mgr;
+		mgr.enableArena();
+		{
+			Rooted<TestManaged> n1{new (mgr) TestManaged(mgr, a[0])};
+			TestManaged *n2 = new (mgr) TestManaged(mgr, a[1]);
+			TestManaged *n3 = new TestManaged(mgr, a[2]);
+			n1->addRef(n2);
+			n2->addRef(n3);
+			n3->addRef(n2);
+
+			mgr.bulkTeardown();
+		}
+
+		// The objects are kept alive until the manager is destroyed
+		ASSERT_TRUE(a[0] && a[1] && a[2]);
+	}
+	ASSERT_FALSE(a[0] || a[1] || a[2]);
+}
+
+TEST(Manager, statistics)
+{
+	std::array<bool, 4> a;
+
+	Manager mgr(1);
+	{
+		Rooted<TestManaged> n1{new TestManaged(mgr, a[0])};
+		TestManaged *n2 = new TestManaged(mgr, a[1]);
+		TestManaged *n3 = new TestManaged(mgr, a[2]);
+		n1->addRef(n2);
+		n2->addRef(n3);
+		n3->addRef(n2);
+		{
+			Rooted<TestManaged> n4{new TestManaged(mgr, a[3])};
+		}
+
+		Manager::Statistics stats = mgr.getStatistics();
+		ASSERT_EQ(3U, stats.liveObjects);
+		ASSERT_EQ(4U, stats.peakObjects);
+		ASSERT_EQ(1U, stats.objectsFreed);
+		ASSERT_EQ(0U, stats.sweeps);
+
+		// Cutting the cycle from the root requires a trace
+		n1->deleteRef(n2);
+		ASSERT_FALSE(a[1] || a[2]);
+		stats = mgr.getStatistics();
+		ASSERT_EQ(1U, stats.liveObjects);
+		ASSERT_EQ(3U, stats.objectsFreed);
+		ASSERT_LE(1U, stats.sweeps);
+		ASSERT_LE(2U, stats.objectsVisited);
+		ASSERT_LE(stats.sweepTimeMax, stats.sweepTimeTotal);
+
+		size_t histogramSweeps = 0;
+		for (size_t n : stats.sweepLatency) {
+			histogramSweeps += n;
+		}
+		ASSERT_EQ(stats.sweeps, histogramSweeps);
+
+		mgr.resetStatistics();
+		stats = mgr.getStatistics();
+		ASSERT_EQ(0U, stats.sweeps);
+		ASSERT_EQ(0U, stats.objectsFreed);
+		ASSERT_EQ(1U, stats.peakObjects);
+	}
+	ASSERT_EQ(0U, mgr.getStatistics().liveObjects);
+}
+
+TEST(Manager, gcPause)
+{
+	constexpr int nCycles = 4;
+	std::array<bool, 2 * nCycles + 1> a;
+
+	Manager mgr(1);
+	{
+		GcPause pause{mgr};
+		{
+			GcPause innerPause{mgr};
+			Rooted<TestManaged> root{new TestManaged(mgr, a[2 * nCycles])};
+			for (int i = 0; i < nCycles; i++) {
+				TestManaged *n1 = new TestManaged(mgr, a[2 * i]);
+				TestManaged *n2 = new TestManaged(mgr, a[2 * i + 1]);
+				root->addRef(n1);
+				n1->addRef(n2);
+				n2->addRef(n1);
+			}
+		}
+
+		// The root node was freed immediately, the cycles are kept alive
+		// while sweeping is paused
+		ASSERT_TRUE(mgr.isSweepPaused());
+		ASSERT_FALSE(a[2 * nCycles]);
+		for (int i = 0; i < 2 * nCycles; i++) {
+			ASSERT_TRUE(a[i]);
+		}
+		ASSERT_EQ(0U, mgr.getStatistics().sweeps);
+	}
+
+	// All cycles are collected at once
+	ASSERT_FALSE(mgr.isSweepPaused());
+	for (bool v : a) {
+		ASSERT_FALSE(v);
+	}
+	ASSERT_EQ(1U, mgr.getStatistics().sweeps);
+}
+
 class TestDeleteOrderManaged : public Managed {
 private:
 	const int id;
@@ -0,0 +1,218 @@
+/*
+    Ousía
+    Copyright (C) 2014, 2015  Benjamin Paaßen, Andreas Stöckel
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <set>
+#include <utility>
+
+#include <gtest/gtest.h>
+
+#include <core/managed/RefList.hpp>
+
+namespace ousia {
+
+/**
+ * Memory the fake Managed pointers stored in the lists point at. The RefList
+ * never dereferences the pointers.
+ */
+static char objects[64];
+
+static Managed *obj(size_t i)
+{
+	return reinterpret_cast<Managed *>(&objects[i]);
+}
+
+static size_t id(Managed *o) { return reinterpret_cast<char *>(o) - objects; }
+
+/**
+ * Fills the list with the objects 0 to n - 1, each object i has the reference
+ * count i + 1.
+ */
+static void fill(RefList &l, size_t n, std::set<size_t> &ids)
+{
+	for (size_t i = ids.size(); i < n; i++) {
+		l.emplace(obj(i), static_cast<int>(i + 1));
+		ids.insert(i);
+	}
+}
+
+/**
+ * Makes sure that the list contains exactly the objects in ids, that find()
+ * returns the entry of each of them and nothing for all other objects.
+ */
+static void checkList(RefList &l, const std::set<size_t> &ids)
+{
+	ASSERT_EQ(ids.size(), l.size());
+	ASSERT_EQ(ids.empty(), l.empty());
+	ASSERT_EQ(ids.size(), static_cast<size_t>(l.end() - l.begin()));
+	for (size_t i = 0; i < sizeof(objects); i++) {
+		auto it = l.find(obj(i));
+		if (ids.count(i)) {
+			ASSERT_NE(l.end(), it) << "object " << i;
+			ASSERT_EQ(obj(i), it->first);
+			ASSERT_EQ(static_cast<int>(i + 1), it->second);
+		} else {
+			ASSERT_EQ(l.end(), it) << "object " << i;
+		}
+	}
+	for (const RefList::Entry &e : l) {
+		ASSERT_EQ(&e, l.find(e.first));
+	}
+}
+
+TEST(RefList, inlineToHeap)
+{
+	RefList l;
+	std::set<size_t> ids;
+	checkList(l, ids);
+
+	// The first entries are stored inline, the third moves them to the heap
+	for (size_t n = 1; n <= 5; n++) {
+		fill(l, n, ids);
+		checkList(l, ids);
+	}
+
+	// Reference counts can be changed through the iterator
+	l.find(obj(3))->second += 10;
+	ASSERT_EQ(14, l.find(obj(3))->second);
+	l.find(obj(3))->second -= 10;
+	checkList(l, ids);
+}
+
+TEST(RefList, indexThreshold)
+{
+	RefList l;
+	std::set<size_t> ids;
+
+	// Grow the list beyond 16 entries, the index is built on the way
+	for (size_t n = 1; n <= 24; n++) {
+		fill(l, n, ids);
+		checkList(l, ids);
+	}
+
+	// Shrink the list below 16 entries, the index is dropped on the way
+	for (size_t i = 0; i < 16; i++) {
+		const size_t erasedId = (i * 7) % 24;
+		ASSERT_TRUE(ids.count(erasedId));
+		l.erase(l.find(obj(erasedId)));
+		ids.erase(erasedId);
+		checkList(l, ids);
+	}
+	ASSERT_EQ(8U, l.size());
+
+	// Cross the threshold once more, the index is built from the remaining
+	// entries
+	for (size_t i = 24; i < 40; i++) {
+		l.emplace(obj(i), static_cast<int>(i + 1));
+		ids.insert(i);
+		checkList(l, ids);
+	}
+}
+
+TEST(RefList, erase)
+{
+	// Inline, heap and indexed heap storage
+	for (size_t n : {2, 8, 20}) {
+		RefList l;
+		std::set<size_t> ids;
+		fill(l, n, ids);
+
+		// Erase the last entry, all other entries stay in place
+		RefList::Entry last = *(l.end() - 1);
+		const RefList::Entry *first = l.begin();
+		l.erase(l.end() - 1);
+		ids.erase(id(last.first));
+		ASSERT_EQ(l.end(), l.find(last.first));
+		ASSERT_EQ(first, l.begin());
+		checkList(l, ids);
+
+		// Erase the first entry, the last entry is moved into its place
+		last = *(l.end() - 1);
+		RefList::Entry erased = *l.begin();
+		l.erase(l.begin());
+		ids.erase(id(erased.first));
+		ASSERT_EQ(l.end(), l.find(erased.first));
+		if (!l.empty()) {
+			ASSERT_EQ(l.begin(), l.find(last.first));
+		}
+		checkList(l, ids);
+
+		// Erase an entry from the middle
+		if (l.size() > 2) {
+			RefList::iterator it = l.begin() + l.size() / 2;
+			const size_t idx = it - l.begin();
+			last = *(l.end() - 1);
+			erased = *it;
+			l.erase(it);
+			ids.erase(id(erased.first));
+			ASSERT_EQ(l.end(), l.find(erased.first));
+			ASSERT_EQ(l.begin() + idx, l.find(last.first));
+			checkList(l, ids);
+		}
+
+		// Erase all remaining entries
+		while (!l.empty()) {
+			erased = *l.begin();
+			l.erase(l.begin());
+			ids.erase(id(erased.first));
+			checkList(l, ids);
+		}
+	}
+}
+
+TEST(RefList, copyMove)
+{
+	// Inline and heap storage
+	for (size_t n : {2, 20}) {
+		RefList l;
+		std::set<size_t> ids;
+		fill(l, n, ids);
+
+		// Copies are independent of the original list
+		RefList copy{l};
+		checkList(copy, ids);
+		copy.erase(copy.find(obj(0)));
+		checkList(l, ids);
+
+		RefList assigned;
+		assigned.emplace(obj(50), 51);
+		assigned = l;
+		checkList(assigned, ids);
+		assigned.erase(assigned.find(obj(1)));
+		checkList(l, ids);
+
+		// Moving leaves the original list empty
+		RefList moved{std::move(assigned)};
+		std::set<size_t> movedIds = ids;
+		movedIds.erase(1);
+		checkList(moved, movedIds);
+		checkList(assigned, std::set<size_t>{});
+
+		RefList moveAssigned;
+		std::set<size_t> otherIds;
+		fill(moveAssigned, 20, otherIds);
+		moveAssigned = std::move(l);
+		checkList(moveAssigned, ids);
+		checkList(l, std::set<size_t>{});
+
+		// The moved-from lists can be reused
+		std::set<size_t> reusedIds;
+		fill(l, 3, reusedIds);
+		checkList(l, reusedIds);
+	}
+}
+}
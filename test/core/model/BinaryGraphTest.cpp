@@ -0,0 +1,353 @@
+/*
+    Ousía
+    Copyright (C) 2014, 2015  Benjamin Paaßen, Andreas Stöckel
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include <core/common/Exceptions.hpp>
+#include <core/common/Logger.hpp>
+#include <core/common/Rtti.hpp>
+#include <core/model/BinaryGraph.hpp>
+#include <core/model/Document.hpp>
+#include <core/model/Ontology.hpp>
+#include <core/model/Typesystem.hpp>
+
+#include "TestOntology.hpp"
+
+namespace ousia {
+
+/**
+ * Returns a variant containing the given magic value.
+ */
+static Variant magic(const char *s)
+{
+	Variant res;
+	res.setMagic(s);
+	return res;
+}
+
+/**
+ * Writes the given root node, reads it back and checks whether writing the
+ * result again yields the same data.
+ */
+static Rooted<Node> roundTrip(Manager &mgr, Handle<Node> root,
+                              const std::vector<Rooted<Node>> &dependencies)
+{
+	std::string data;
+	EXPECT_TRUE(BinaryGraphWriter(dependencies).write(root, data));
+
+	Rooted<Node> res =
+	    BinaryGraphReader::read(mgr, data.data(), data.size(), dependencies);
+	EXPECT_TRUE(res != nullptr);
+	EXPECT_NE(root, res);
+
+	std::string data2;
+	EXPECT_TRUE(BinaryGraphWriter(dependencies).write(res, data2));
+	EXPECT_EQ(data, data2);
+	return res;
+}
+
+TEST(BinaryGraph, typesystem)
+{
+	Logger logger;
+	Manager mgr{1};
+	Rooted<SystemTypesystem> sys{new SystemTypesystem(mgr)};
+	Rooted<Typesystem> typesystem{new Typesystem(mgr, sys, "color")};
+
+	Rooted<EnumType> mode = typesystem->createEnumType("mode");
+	mode->addEntries({"rgb", "hsv"}, logger);
+
+	Rooted<StructType> base = typesystem->createStructType("base");
+	base->createAttribute("mode", magic("hsv"), true, logger)
+	    ->setType(mode, logger);
+	Rooted<StructType> color = typesystem->createStructType("color");
+	color->setParentStructure(base, logger);
+	color->createAttribute("r", Variant{0.5}, true, logger)
+	    ->setType(sys->getDoubleType(), logger);
+	color->createAttribute("tags", Variant{nullptr}, false, logger)
+	    ->setType(new ArrayType(sys->getStringType()), logger);
+	typesystem->createConstant("white", Variant::arrayType{"rgb", 1.0, 2})
+	    ->setType(color, logger);
+
+	Rooted<Typesystem> res =
+	    roundTrip(mgr, typesystem, {sys}).cast<Typesystem>();
+	ASSERT_TRUE(res->isa(&RttiTypes::Typesystem));
+	EXPECT_EQ("color", res->getName());
+	ASSERT_EQ(1U, res->getTypesystemReferences().size());
+	EXPECT_EQ(sys, res->getTypesystemReferences()[0]);
+	ASSERT_EQ(3U, res->getTypes().size());
+
+	Rooted<EnumType> mode2 = res->getTypes()[0].cast<EnumType>();
+	EXPECT_EQ("rgb", mode2->nameOf(0));
+	EXPECT_EQ("hsv", mode2->nameOf(1));
+
+	Rooted<StructType> color2 = res->getTypes()[2].cast<StructType>();
+	EXPECT_EQ(res->getTypes()[1], color2->getParentStructure());
+	ASSERT_EQ(3U, color2->getAttributes().size());
+	EXPECT_EQ("mode", color2->getAttributes()[0]->getName());
+	EXPECT_EQ(mode2, color2->getAttributes()[0]->getType());
+	EXPECT_EQ(Variant{1}, color2->getAttributes()[0]->getDefaultValue());
+	EXPECT_EQ(sys->getDoubleType(), color2->getAttributes()[1]->getType());
+	EXPECT_EQ(Variant{0.5}, color2->getAttributes()[1]->getDefaultValue());
+	EXPECT_TRUE(
+	    color2->getAttributes()[2]->getType()->isa(&RttiTypes::ArrayType));
+
+	ASSERT_EQ(1U, res->getConstants().size());
+	EXPECT_EQ(color2, res->getConstants()[0]->getType());
+	EXPECT_EQ(typesystem->getConstants()[0]->getValue(),
+	          res->getConstants()[0]->getValue());
+	EXPECT_TRUE(res->validate(logger));
+}
+
+TEST(BinaryGraph, ontologies)
+{
+	Logger logger;
+	Manager mgr{1};
+	Rooted<SystemTypesystem> sys{new SystemTypesystem(mgr)};
+	Rooted<Ontology> book = constructBookOntology(mgr, sys, logger);
+
+	// Ontology extending the book ontology
+	Rooted<Ontology> list{new Ontology(mgr, sys, "list")};
+	Rooted<StructuredClass> paragraph = book->getStructureClasses()[2];
+	Rooted<StructuredClass> item{new StructuredClass(mgr, "item", list)};
+	item->addFieldDescriptor(paragraph->getFieldDescriptor(), logger);
+	for (const char *name : {"ol", "ul"}) {
+		Rooted<StructuredClass> l{new StructuredClass(
+		    mgr, name, list, Cardinality::any(), paragraph)};
+		l->createFieldDescriptor(logger).first->addChild(item);
+	}
+
+	Rooted<Ontology> emphasis{new Ontology(mgr, sys, "emphasis")};
+	emphasis->createAnnotationClass("emph");
+	emphasis->createAnnotationClass("strong");
+
+	Rooted<Ontology> book2 = roundTrip(mgr, book, {sys}).cast<Ontology>();
+	ASSERT_EQ(5U, book2->getStructureClasses().size());
+	Rooted<StructuredClass> paragraph2 = book2->getStructureClasses()[2];
+	EXPECT_EQ("paragraph", paragraph2->getName());
+	EXPECT_TRUE(paragraph2->isTransparent());
+	Rooted<StructuredClass> root = book2->getStructureClasses()[0];
+	EXPECT_TRUE(root->hasRootPermission());
+	EXPECT_EQ(book->getStructureClasses()[0]->getCardinality(),
+	          root->getCardinality());
+	ASSERT_EQ(1U, root->getFieldDescriptors().size());
+	EXPECT_EQ(std::vector<Rooted<StructuredClass>>(
+	              {book2->getStructureClasses()[1], paragraph2}),
+	          std::vector<Rooted<StructuredClass>>(
+	              root->getFieldDescriptor()->getChildren().begin(),
+	              root->getFieldDescriptor()->getChildren().end()));
+	Rooted<FieldDescriptor> textField =
+	    book2->getStructureClasses()[4]->getFieldDescriptor();
+	EXPECT_TRUE(textField->isPrimitive());
+	EXPECT_EQ(sys->getStringType(), textField->getPrimitiveType());
+	EXPECT_TRUE(book2->validate(logger));
+
+	// The list ontology references classes and fields of the book ontology,
+	// which is a dependency
+	Rooted<Ontology> list2 =
+	    roundTrip(mgr, list, {sys, book}).cast<Ontology>();
+	ASSERT_EQ(3U, list2->getStructureClasses().size());
+	Rooted<StructuredClass> ol = list2->getStructureClasses()[1];
+	EXPECT_EQ(paragraph, ol->getSuperclass());
+	EXPECT_EQ(paragraph->getFieldDescriptor(),
+	          list2->getStructureClasses()[0]->getFieldDescriptors()[0]);
+
+	Rooted<Ontology> emphasis2 =
+	    roundTrip(mgr, emphasis, {sys}).cast<Ontology>();
+	EXPECT_EQ(2U, emphasis2->getAnnotationClasses().size());
+}
+
+TEST(BinaryGraph, inheritanceAndLocations)
+{
+	Logger logger;
+	Manager mgr{1};
+	Rooted<SystemTypesystem> sys{new SystemTypesystem(mgr)};
+	Rooted<Typesystem> types{new Typesystem(mgr, sys, "types")};
+	Rooted<EnumType> level = types->createEnumType("level");
+	level->addEntries({"low", "high"}, logger);
+
+	Rooted<Ontology> ontology{new Ontology(mgr, sys, "ontology")};
+	ontology->referenceTypesystem(types);
+	Rooted<StructuredClass> a{new StructuredClass(mgr, "a", ontology)};
+	a->getAttributesDescriptor()
+	    ->createAttribute("level", magic("high"), true, logger)
+	    ->setType(level, logger);
+	Rooted<StructuredClass> c{new StructuredClass(
+	    mgr, "c", ontology, Cardinality::any(), a)};
+	Rooted<StructuredClass> b{new StructuredClass(
+	    mgr, "b", ontology, Cardinality::any(), a)};
+	b->getAttributesDescriptor()
+	    ->createAttribute("title", Variant::fromString(""), true, logger)
+	    ->setType(sys->getStringType(), logger);
+	b->createPrimitiveFieldDescriptor(new ReferenceType(mgr, "ref", c),
+	                                  logger);
+	b->setLocation(SourceLocation{1, 10, 20});
+
+	std::string data;
+	ASSERT_TRUE(BinaryGraphWriter({sys}, 1).write(ontology, data));
+	Rooted<Ontology> res =
+	    BinaryGraphReader::read(mgr, data.data(), data.size(), {sys}, 2)
+	        .cast<Ontology>();
+
+	// The typesystem is not a dependency and thus written along with the
+	// ontology
+	ASSERT_EQ(2U, res->getTypesystems().size());
+	EXPECT_EQ(sys, res->getTypesystems()[0]);
+	EXPECT_NE(types, res->getTypesystems()[1]);
+	EXPECT_EQ("types", res->getTypesystems()[1]->getName());
+
+	// The order of the subclasses is retained
+	Rooted<StructuredClass> a2 = res->getStructureClasses()[0];
+	Rooted<StructuredClass> b2 = res->getStructureClasses()[2];
+	ASSERT_EQ(2U, a2->getSubclasses().size());
+	EXPECT_EQ("c", a2->getSubclasses()[0]->getName());
+	EXPECT_EQ("b", a2->getSubclasses()[1]->getName());
+	EXPECT_EQ(a2, b2->getSuperclass());
+
+	// Attributes are inherited
+	Rooted<StructType> attrs = b2->getAttributesDescriptor();
+	EXPECT_EQ(a2->getAttributesDescriptor(), attrs->getParentStructure());
+	ASSERT_EQ(2U, attrs->getAttributes().size());
+	EXPECT_EQ(Variant{1}, attrs->getAttributes()[0]->getDefaultValue());
+	EXPECT_EQ(res->getTypesystems()[1]->getTypes()[0],
+	          attrs->getAttributes()[0]->getType());
+
+	// Anonymous reference types are recreated
+	Rooted<Type> ref = b2->getFieldDescriptor()->getPrimitiveType();
+	ASSERT_TRUE(ref->isa(&RttiTypes::ReferenceType));
+	EXPECT_EQ(res->getStructureClasses()[1],
+	          ref.cast<ReferenceType>()->getDescriptor());
+
+	// Only locations in the given source are stored
+	EXPECT_EQ(2U, b2->getLocation().getSourceId());
+	EXPECT_EQ(10U, b2->getLocation().getStart());
+	EXPECT_EQ(20U, b2->getLocation().getEnd());
+	EXPECT_FALSE(a2->getLocation().isValid());
+	EXPECT_TRUE(res->validate(logger));
+}
+
+TEST(BinaryGraph, document)
+{
+	Logger logger;
+	Manager mgr{1};
+	Rooted<SystemTypesystem> sys{new SystemTypesystem(mgr)};
+	Rooted<Ontology> book = constructBookOntology(mgr, sys, logger);
+	Rooted<Ontology> emphasis{new Ontology(mgr, sys, "emphasis")};
+	Rooted<AnnotationClass> emph = emphasis->createAnnotationClass("emph");
+
+	// Book with a paragraph containing an annotated text
+	Rooted<Document> doc{new Document(mgr, "doc")};
+	doc->referenceOntology(book);
+	doc->referenceOntology(emphasis);
+	Rooted<StructuredEntity> root{new StructuredEntity(
+	    mgr, doc, book->getStructureClasses()[0], Variant::mapType{}, "b")};
+	Rooted<StructuredEntity> paragraph{new StructuredEntity(
+	    mgr, root, book->getStructureClasses()[2], size_t(0))};
+	paragraph->setTransparent(true);
+	auto addText = [&](const char *content) {
+		Rooted<StructuredEntity> text{new StructuredEntity(
+		    mgr, paragraph, book->getStructureClasses()[4], size_t(0))};
+		new DocumentPrimitive(mgr, text, Variant::fromString(content), 0);
+	};
+	Rooted<Anchor> start{new Anchor(mgr, paragraph, size_t(0))};
+	addText("Hello");
+	Rooted<Anchor> end{new Anchor(mgr, paragraph, size_t(0))};
+	addText(" World");
+	doc->createChildAnnotation(emph, start, end, Variant::mapType{}, "e");
+
+	// The ontologies are dependencies
+	Rooted<Document> doc2 =
+	    roundTrip(mgr, doc, {sys, book, emphasis}).cast<Document>();
+	ASSERT_EQ(2U, doc2->getOntologies().size());
+	EXPECT_EQ(book, doc2->getOntologies()[0]);
+	Rooted<StructuredEntity> root2 = doc2->getRoot();
+	ASSERT_TRUE(root2 != nullptr);
+	EXPECT_EQ("b", root2->getName());
+	EXPECT_EQ(book->getStructureClasses()[0], root2->getDescriptor());
+	ASSERT_EQ(1U, root2->getField(0).size());
+	Rooted<StructuredEntity> paragraph2 =
+	    root2->getField(0)[0].cast<StructuredEntity>();
+	EXPECT_TRUE(paragraph2->isTransparent());
+	const NodeVector<StructureNode> &children = paragraph2->getField(0);
+	ASSERT_EQ(4U, children.size());
+	EXPECT_EQ(Variant::fromString("Hello"),
+	          children[1]
+	              .cast<StructuredEntity>()
+	              ->getField(0)[0]
+	              .cast<DocumentPrimitive>()
+	              ->getContent());
+	EXPECT_EQ(Variant::fromString(" World"),
+	          children[3]
+	              .cast<StructuredEntity>()
+	              ->getField(0)[0]
+	              .cast<DocumentPrimitive>()
+	              ->getContent());
+	ASSERT_EQ(1U, doc2->getAnnotations().size());
+	Rooted<AnnotationEntity> annotation = doc2->getAnnotations()[0];
+	EXPECT_EQ("e", annotation->getName());
+	EXPECT_EQ(emph, annotation->getDescriptor());
+	EXPECT_EQ(children[0], annotation->getStart());
+	EXPECT_EQ(children[2], annotation->getEnd());
+	EXPECT_TRUE(annotation->getStart()->isStart());
+	EXPECT_TRUE(annotation->getEnd()->isEnd());
+
+	// Without the ontologies as dependencies, they are written along with
+	// the document
+	Rooted<Document> doc3 = roundTrip(mgr, doc, {sys}).cast<Document>();
+	ASSERT_EQ(2U, doc3->getOntologies().size());
+	Rooted<Ontology> book3 = doc3->getOntologies()[0];
+	EXPECT_NE(book, book3);
+	EXPECT_EQ("book", book3->getName());
+	EXPECT_EQ(book3->getStructureClasses()[0],
+	          doc3->getRoot()->getDescriptor());
+	EXPECT_EQ(doc3->getOntologies()[1]->getAnnotationClasses()[0],
+	          doc3->getAnnotations()[0]->getDescriptor());
+	EXPECT_TRUE(doc->validate(logger));
+	EXPECT_TRUE(doc3->validate(logger));
+}
+
+TEST(BinaryGraph, invalidData)
+{
+	Logger logger;
+	Manager mgr{1};
+	Rooted<SystemTypesystem> sys{new SystemTypesystem(mgr)};
+	Rooted<Ontology> book = constructBookOntology(mgr, sys, logger);
+
+	std::string data;
+	ASSERT_TRUE(BinaryGraphWriter({sys}).write(book, data));
+
+	// Truncated data, wrong magic number, missing dependency
+	ASSERT_THROW(BinaryGraphReader::read(mgr, data.data(), data.size() - 1,
+	                                     {sys}),
+	             LoggableException);
+	std::string wrongMagic = data;
+	wrongMagic[0] = 'X';
+	ASSERT_THROW(BinaryGraphReader::read(mgr, wrongMagic.data(),
+	                                     wrongMagic.size(), {sys}),
+	             LoggableException);
+	ASSERT_THROW(BinaryGraphReader::read(mgr, data.data(), data.size(), {}),
+	             LoggableException);
+
+	// Nodes with an unresolved type cannot be written
+	Rooted<Typesystem> typesystem{new Typesystem(mgr, sys, "types")};
+	typesystem->createConstant("unresolved", Variant{1});
+	EXPECT_FALSE(BinaryGraphWriter({sys}).write(typesystem, data));
+}
+}
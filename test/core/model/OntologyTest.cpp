@@ -22,6 +22,7 @@
 
 #include <core/common/Rtti.hpp>
 #include <core/frontend/TerminalLogger.hpp>
+#include <core/model/Document.hpp>
 #include <core/model/Ontology.hpp>
 
 #include "TestOntology.hpp"
@@ -187,6 +188,60 @@ TEST(StructuredClass, getFieldDescriptorsCycles)
 	ASSERT_EQ(A_a, fds[0]);
 }
 
+TEST(StructuredClass, getFieldDescriptorIndex)
+{
+	Logger logger;
+	Manager mgr{1};
+	Rooted<SystemTypesystem> sys{new SystemTypesystem(mgr)};
+	Rooted<Ontology> ontology{new Ontology(mgr, sys, "myOntology")};
+
+	Rooted<StructuredClass> A{new StructuredClass(
+	    mgr, "A", ontology, Cardinality::any(), nullptr, false, true)};
+	Rooted<FieldDescriptor> A_a = createUnsortedPrimitiveField(
+	    A, sys->getStringType(), logger, false, "a");
+	Rooted<FieldDescriptor> A_main = createUnsortedPrimitiveField(
+	    A, sys->getStringType(), logger, true, "main");
+	Rooted<StructuredClass> B{new StructuredClass(
+	    mgr, "B", ontology, Cardinality::any(), A, false, true)};
+	Rooted<FieldDescriptor> B_b = createUnsortedPrimitiveField(
+	    B, sys->getStringType(), logger, false, "b");
+	ASSERT_TRUE(ontology->validate(logger));
+
+	// The lookups are answered by the field table of the validated class
+	ASSERT_EQ(0, B->getFieldDescriptorIndex("a"));
+	ASSERT_EQ(1, B->getFieldDescriptorIndex("b"));
+	ASSERT_EQ(2, B->getFieldDescriptorIndex("main"));
+	ASSERT_EQ(2, B->getFieldDescriptorIndex());
+	ASSERT_EQ(-1, B->getFieldDescriptorIndex("c"));
+	ASSERT_EQ(1, B->getFieldDescriptorIndex(B_b));
+	ASSERT_EQ(B_b, B->getFieldDescriptor("b"));
+	ASSERT_EQ(A_main, B->getFieldDescriptor(2));
+	ASSERT_EQ(nullptr, B->getFieldDescriptor(3));
+	ASSERT_EQ(3U, B->getFieldDescriptors().size());
+
+	// Adding a field to the superclass must be visible in the subclass, both
+	// before and after validating the ontology again
+	Rooted<FieldDescriptor> A_c =
+	    A->createPrimitiveFieldDescriptor(sys->getStringType(), logger,
+	                                      FieldDescriptor::FieldType::SUBTREE,
+	                                      "c").first;
+	for (int i = 0; i < 2; i++) {
+		ASSERT_EQ(1, B->getFieldDescriptorIndex("c"));
+		ASSERT_EQ(2, B->getFieldDescriptorIndex("b"));
+		ASSERT_EQ(3, B->getFieldDescriptorIndex());
+		ASSERT_EQ(A_c, B->getFieldDescriptor(1));
+		ASSERT_EQ(4U, B->getFieldDescriptors().size());
+		ASSERT_TRUE(ontology->validate(logger));
+	}
+
+	// Renaming a field updates the name index
+	B_b->setName("d");
+	ASSERT_TRUE(ontology->validate(logger));
+	ASSERT_EQ(-1, B->getFieldDescriptorIndex("b"));
+	ASSERT_EQ(2, B->getFieldDescriptorIndex("d"));
+	ASSERT_EQ(B_b, B->getFieldDescriptor("d"));
+}
+
 Rooted<StructuredClass> getClass(const std::string name, Handle<Ontology> dom)
 {
 	std::vector<ResolutionResult> res =
@@ -355,6 +410,60 @@ TEST(Descriptor, pathToCycles)
 	ASSERT_EQ(A_field, path[0]);
 }
 
+TEST(Descriptor, pathToCache)
+{
+	// Build an ontology with two paths of the same length from start to
+	// target, via X and via Y.
+	Manager mgr{1};
+	ConcreteLogger logger;
+	Rooted<SystemTypesystem> sys{new SystemTypesystem(mgr)};
+	Rooted<Ontology> ontology{new Ontology(mgr, sys, "ambiguous")};
+	Rooted<StructuredClass> start{new StructuredClass(
+	    mgr, "start", ontology, Cardinality::any(), {nullptr}, false, true)};
+	Rooted<StructuredClass> X{new StructuredClass(
+	    mgr, "X", ontology, Cardinality::any(), {nullptr}, true, false)};
+	Rooted<StructuredClass> Y{new StructuredClass(
+	    mgr, "Y", ontology, Cardinality::any(), {nullptr}, true, false)};
+	Rooted<StructuredClass> target{
+	    new StructuredClass(mgr, "target", ontology, Cardinality::any())};
+	Rooted<FieldDescriptor> start_field =
+	    start->createFieldDescriptor(logger).first;
+	start_field->addChild(X);
+	start_field->addChild(Y);
+	Rooted<FieldDescriptor> X_field = X->createFieldDescriptor(logger).first;
+	X_field->addChild(target);
+	Rooted<FieldDescriptor> Y_field = Y->createFieldDescriptor(logger).first;
+	Y_field->addChild(target);
+	ASSERT_TRUE(ontology->validate(logger));
+
+	// The first search stores the path in the table of the ontology, the
+	// ambiguity is reported for each request
+	NodeVector<Node> path = start->pathTo(target, logger);
+	ASSERT_EQ(3U, path.size());
+	ASSERT_EQ(X, path[1]);
+	ASSERT_EQ(1U, logger.getSeverityCount(Severity::ERROR));
+	ASSERT_EQ(1U, ontology->getTransparentPathCount());
+
+	NodeVector<Node> cached = start->pathTo(target, logger);
+	ASSERT_EQ(std::vector<Rooted<Node>>(path.begin(), path.end()),
+	          std::vector<Rooted<Node>>(cached.begin(), cached.end()));
+	ASSERT_EQ(2U, logger.getSeverityCount(Severity::ERROR));
+	ASSERT_EQ(1U, ontology->getTransparentPathCount());
+
+	// Changing the ontology discards the table, paths are only stored again
+	// once the ontology has been validated
+	X->setTransparent(false);
+	path = start->pathTo(target, logger);
+	ASSERT_EQ(3U, path.size());
+	ASSERT_EQ(Y, path[1]);
+	ASSERT_EQ(2U, logger.getSeverityCount(Severity::ERROR));
+	ASSERT_EQ(0U, ontology->getTransparentPathCount());
+
+	ASSERT_TRUE(ontology->validate(logger));
+	ASSERT_EQ(3U, start->pathTo(target, logger).size());
+	ASSERT_EQ(1U, ontology->getTransparentPathCount());
+}
+
 TEST(Descriptor, getDefaultFields)
 {
 	// construct a ontology with lots of default fields to test.
@@ -673,6 +782,71 @@ TEST(StructuredClass, isSubclassOf)
 	ASSERT_FALSE(F->isSubclassOf(F));
 }
 
+static std::vector<Node *> resolveNodes(Handle<Node> node, const Rtti *type,
+                                        std::vector<std::string> path)
+{
+	std::vector<Node *> res;
+	for (const ResolutionResult &r : node->resolve(type, path)) {
+		res.push_back(r.node.get());
+	}
+	return res;
+}
+
+TEST(Ontology, resolveSymbolTable)
+{
+	Logger logger;
+	Manager mgr{1};
+	Rooted<SystemTypesystem> sys{new SystemTypesystem(mgr)};
+	Rooted<Ontology> book = constructBookOntology(mgr, sys, logger);
+	Rooted<Ontology> other{new Ontology(mgr, sys, "other")};
+	Rooted<StructuredClass> paragraph{
+	    new StructuredClass(mgr, "paragraph", other)};
+	Rooted<Document> doc{new Document(mgr, "doc")};
+	doc->referenceOntology(book);
+	doc->referenceOntology(other);
+
+	// Resolve with the generic traversal first
+	const Rtti *type = &RttiTypes::StructuredClass;
+	std::vector<Node *> ambiguous = resolveNodes(doc, type, {"paragraph"});
+	std::vector<Node *> qualified =
+	    resolveNodes(doc, type, {"book", "section"});
+	ASSERT_EQ(2U, ambiguous.size());
+	ASSERT_EQ(paragraph, ambiguous[1]);
+	ASSERT_EQ(1U, qualified.size());
+	ASSERT_EQ(0U, book->getSymbolCount());
+
+	// Once validated, the symbol table of the ontologies is used and yields
+	// the same results
+	ASSERT_TRUE(book->validate(logger));
+	ASSERT_TRUE(other->validate(logger));
+	ASSERT_EQ(ambiguous, resolveNodes(doc, type, {"paragraph"}));
+	ASSERT_EQ(ambiguous, resolveNodes(doc, type, {"paragraph"}));
+	ASSERT_EQ(qualified, resolveNodes(doc, type, {"book", "section"}));
+	ASSERT_EQ(2U, other->getSymbolCount());
+
+	// The qualified path is resolved via the name of the book ontology, which
+	// does not need an entry in the symbol table
+	ASSERT_EQ(1U, book->getSymbolCount());
+
+	// Changing the ontology discards the symbol table
+	paragraph->setName("chapter");
+	ASSERT_EQ(ValidationState::UNKNOWN, other->getValidationState());
+	ASSERT_EQ(1U, resolveNodes(doc, type, {"paragraph"}).size());
+	ASSERT_EQ(std::vector<Node *>{paragraph.get()},
+	          resolveNodes(doc, type, {"chapter"}));
+	ASSERT_EQ(0U, other->getSymbolCount());
+
+	// The unchanged book ontology is still valid, its table is rebuilt
+	ASSERT_EQ(ValidationState::VALID, book->getValidationState());
+	ASSERT_EQ(2U, book->getSymbolCount());
+
+	// The table is rebuilt after the next validation
+	ASSERT_TRUE(other->validate(logger));
+	ASSERT_EQ(std::vector<Node *>{paragraph.get()},
+	          resolveNodes(doc, type, {"chapter"}));
+	ASSERT_EQ(1U, other->getSymbolCount());
+}
+
 TEST(Ontology, validate)
 {
 	TerminalLogger logger{std::cerr, true};
@@ -19,10 +19,14 @@
 #include <gtest/gtest.h>
 
 #include <core/common/Logger.hpp>
+#include <core/common/RttiBuilder.hpp>
 #include <core/managed/Manager.hpp>
 #include <core/model/Node.hpp>
+#include <core/model/Ontology.hpp>
 #include <core/parser/ParserScope.hpp>
 
+#include <core/model/TestOntology.hpp>
+
 namespace ousia {
 
 TEST(ParserScope, flags)
@@ -52,5 +56,150 @@ TEST(ParserScope, flags)
 	ASSERT_TRUE(scope.getFlag(ParserFlag::POST_HEAD));
 }
 
+TEST(ParserScope, resolutionCache)
+{
+	Logger logger;
+	Manager mgr;
+	Rooted<SystemTypesystem> sys{new SystemTypesystem(mgr)};
+	Rooted<Ontology> book = constructBookOntology(mgr, sys, logger);
+	Rooted<StructuredClass> section = book->getStructureClasses()[1];
+	ParserScope scope;
+	scope.push(book);
+
+	// The second lookup is answered from the cache
+	ASSERT_EQ(section, scope.resolve<StructuredClass>({"section"}, logger));
+	ASSERT_EQ(section, scope.resolve<StructuredClass>({"section"}, logger));
+	ASSERT_EQ(1U, scope.getResolutionCacheHits());
+	ASSERT_EQ(1U, scope.getResolutionCacheMisses());
+
+	// Different paths and stacks are not mixed up
+	ASSERT_EQ(nullptr, scope.resolve<StructuredClass>({"chapter"}, logger));
+	ASSERT_EQ(nullptr, scope.resolve<StructuredClass>({"chapter"}, logger));
+	scope.push(section);
+	ASSERT_EQ(section, scope.resolve<StructuredClass>({"section"}, logger));
+	scope.pop(logger);
+	ASSERT_EQ(section, scope.resolve<StructuredClass>({"section"}, logger));
+	ASSERT_EQ(2U, scope.getResolutionCacheHits());
+	ASSERT_EQ(4U, scope.getResolutionCacheMisses());
+
+	// Renaming the node invalidates the cache
+	section->setName("chapter");
+	ASSERT_EQ(nullptr, scope.resolve<StructuredClass>({"section"}, logger));
+	ASSERT_EQ(section, scope.resolve<StructuredClass>({"chapter"}, logger));
+	ASSERT_EQ(section, scope.resolve<StructuredClass>({"chapter"}, logger));
+	ASSERT_EQ(3U, scope.getResolutionCacheHits());
+	ASSERT_EQ(6U, scope.getResolutionCacheMisses());
+
+	// New named nodes and references invalidate the cache, the result is the
+	// same as without cache
+	Rooted<Ontology> other{new Ontology(mgr, sys, "other")};
+	Rooted<StructuredClass> chapter{
+	    new StructuredClass(mgr, "chapter", other)};
+	ASSERT_EQ(6U, scope.getResolutionCacheMisses());
+	book->referenceOntology(other);
+	ParserScope uncached;
+	uncached.push(book);
+	ASSERT_EQ(uncached.resolve<StructuredClass>({"chapter"}, logger),
+	          scope.resolve<StructuredClass>({"chapter"}, logger));
+	ASSERT_EQ(3U, scope.getResolutionCacheHits());
+	ASSERT_EQ(7U, scope.getResolutionCacheMisses());
+
+	// Removed nodes are no longer returned
+	ASSERT_EQ(section, scope.resolve<StructuredClass>({"book", "chapter"}, logger));
+	book->removeStructuredClass(section);
+	ASSERT_EQ(nullptr, scope.resolve<StructuredClass>({"book", "chapter"}, logger));
 }
 
+namespace {
+/**
+ * Node with named children which can be resolved through an index.
+ */
+class IndexNode : public Node {
+protected:
+	void doResolve(ResolutionState &state) override
+	{
+		continueResolveComposita(children, children.getIndex(), state);
+	}
+
+public:
+	NodeVector<IndexNode> children;
+
+	IndexNode(Manager &mgr, std::string name)
+	    : Node(mgr, name), children(this)
+	{
+	}
+};
+
+const Rtti IndexNodeType = RttiBuilder<IndexNode>("IndexNode")
+                               .parent(&RttiTypes::Node)
+                               .composedOf(&IndexNodeType);
+}
+
+static void deferForwardReferences(ParserScope &scope,
+                                   std::vector<Rooted<IndexNode>> &nodes,
+                                   ResolutionResultCallback callback,
+                                   Logger &logger, size_t n, bool cyclic)
+{
+	// Each node references the node created after it, the last node
+	// references the first one if "cyclic" is set. The nodes are only added
+	// to the tree afterwards, so none of the references can be resolved yet.
+	Manager &mgr = scope.getRoot()->getManager();
+	for (size_t i = 0; i < n; i++) {
+		nodes.emplace_back(new IndexNode(mgr, "n" + std::to_string(i)));
+	}
+	for (size_t i = 0; i < n; i++) {
+		if (i + 1 < n || cyclic) {
+			ASSERT_FALSE(scope.resolve(&IndexNodeType,
+			                           {"n" + std::to_string((i + 1) % n)},
+			                           nodes[i], logger, callback));
+		}
+	}
+	Rooted<IndexNode> root = scope.getRoot().cast<IndexNode>();
+	root->children.insert(root->children.end(), nodes.begin(), nodes.end());
+}
+
+TEST(ParserScope, deferredResolution)
+{
+	static constexpr size_t N = 10000;
+	ConcreteLogger logger;
+	Manager mgr;
+	std::vector<std::pair<Node *, Node *>> resolved;
+	auto callback = [&resolved](Handle<Node> resolvedNode, Handle<Node> owner,
+	                            Logger &logger) {
+		resolved.emplace_back(owner.get(), resolvedNode.get());
+	};
+
+	// Without a cycle the resolutions have to be performed in reverse order
+	{
+		std::vector<Rooted<IndexNode>> nodes;
+		ParserScope scope;
+		scope.push(new IndexNode(mgr, "chain"));
+		deferForwardReferences(scope, nodes, callback, logger, N, false);
+		ASSERT_TRUE(scope.performDeferredResolution(logger, true));
+		ASSERT_EQ(N - 1, resolved.size());
+		for (size_t i = 0; i < N - 1; i++) {
+			ASSERT_EQ(nodes[N - 2 - i], resolved[i].first);
+			ASSERT_EQ(nodes[N - 1 - i], resolved[i].second);
+		}
+	}
+
+	// With a cycle, the resolutions are only performed once the order is no
+	// longer enforced
+	resolved.clear();
+	{
+		std::vector<Rooted<IndexNode>> nodes;
+		ParserScope scope;
+		scope.push(new IndexNode(mgr, "cycle"));
+		deferForwardReferences(scope, nodes, callback, logger, N, true);
+		ASSERT_FALSE(scope.performDeferredResolution(logger, true));
+		ASSERT_TRUE(resolved.empty());
+		ASSERT_TRUE(scope.performDeferredResolution(logger));
+		ASSERT_EQ(N, resolved.size());
+		for (size_t i = 0; i < N; i++) {
+			ASSERT_EQ(nodes[i], resolved[i].first);
+			ASSERT_EQ(nodes[(i + 1) % N], resolved[i].second);
+		}
+	}
+	ASSERT_FALSE(logger.hasError());
+}
+}
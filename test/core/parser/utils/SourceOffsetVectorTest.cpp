@@ -61,4 +61,41 @@ TEST(SourceOffsetVector, gaps)
 	EXPECT_EQ(999U * 3 + 7, elem.first);
 	EXPECT_EQ(999U * 3 + 7, elem.second);
 }
+
+TEST(SourceOffsetVector, runs)
+{
+	SourceOffsetVector vec;
+
+	// Mix contiguous runs, a two-byte character, a gap and characters without
+	// location
+	vec.storeOffsets(10, 1, 5);  // 10-15
+	vec.storeOffset(15, 17);     // two byte linebreak
+	vec.storeOffset(17, 18);
+	vec.storeOffsets(18, 1, 2);  // continues the previous run
+	vec.storeOffsets(30, 1, 3);  // gap
+	vec.storeOffsets(InvalidSourceOffset, 0, 2);
+	ASSERT_EQ(14U, vec.size());
+
+	const std::vector<std::pair<SourceOffset, SourceOffset>> expected{
+	    {10, 11}, {11, 12}, {12, 13}, {13, 14}, {14, 15}, {15, 17}, {17, 18},
+	    {18, 19}, {19, 20}, {30, 31}, {31, 32}, {32, 33},
+	    {InvalidSourceOffset, InvalidSourceOffset},
+	    {InvalidSourceOffset, InvalidSourceOffset}};
+	for (size_t i = 0; i < expected.size(); i++) {
+		EXPECT_EQ(expected[i], vec.loadOffset(i)) << i;
+	}
+
+	// Trim into the middle of a run and continue it
+	vec.trim(8);
+	ASSERT_EQ(8U, vec.size());
+	EXPECT_EQ(SourceOffsetVector::OffsPair(18, 19), vec.loadOffset(7));
+	EXPECT_EQ(SourceOffsetVector::OffsPair(19, 19), vec.loadOffset(8));
+	vec.storeOffset(19, 20);
+	EXPECT_EQ(SourceOffsetVector::OffsPair(19, 20), vec.loadOffset(8));
+
+	vec.trim(0);
+	ASSERT_EQ(0U, vec.size());
+	vec.storeOffset(3, 4);
+	EXPECT_EQ(SourceOffsetVector::OffsPair(3, 4), vec.loadOffset(0));
+}
 }
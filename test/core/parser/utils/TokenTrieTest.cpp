@@ -88,5 +88,90 @@ TEST(TokenTrie, unregisterToken)
 	ASSERT_EQ(Tokens::Empty, tree.hasToken("ab"));
 	ASSERT_EQ(Tokens::Empty, tree.hasToken("b"));
 }
+
+static TokenId tableLookup(const TokenTrie &tree, const std::string &token)
+{
+	const TokenTrie::Table &table = tree.getTable();
+	TokenTrie::Table::State state = TokenTrie::Table::ROOT;
+	for (char c : token) {
+		state = table.next(state, c);
+		if (state == TokenTrie::Table::NONE) {
+			return Tokens::Empty;
+		}
+	}
+	return table.id(state);
 }
 
+TEST(TokenTrie, table)
+{
+	TokenTrie tree;
+	ASSERT_EQ(Tokens::Empty, tableLookup(tree, "a"));
+
+	ASSERT_TRUE(tree.registerToken("a", t1));
+	ASSERT_TRUE(tree.registerToken("ab", t2));
+	ASSERT_TRUE(tree.registerToken("b", t3));
+	ASSERT_TRUE(tree.registerToken("hello", t4));
+
+	for (const char *token : {"a", "ab", "b", "hello", "", "abc", "hell",
+	                          "x", "\xff"}) {
+		ASSERT_EQ(tree.hasToken(token), tableLookup(tree, token)) << token;
+	}
+
+	// Only the states which have outgoing transitions can be advanced
+	const TokenTrie::Table &table = tree.getTable();
+	ASSERT_TRUE(table.canAdvance(TokenTrie::Table::ROOT));
+	ASSERT_TRUE(table.canAdvance(table.next(TokenTrie::Table::ROOT, 'a')));
+	ASSERT_FALSE(table.canAdvance(table.next(TokenTrie::Table::ROOT, 'b')));
+
+	// The table is rebuilt once the trie changes
+	ASSERT_TRUE(tree.unregisterToken("a"));
+	ASSERT_TRUE(tree.unregisterToken("hello"));
+	ASSERT_TRUE(tree.registerToken("hi", t1));
+	for (const char *token : {"a", "ab", "b", "hello", "hi", "h"}) {
+		ASSERT_EQ(tree.hasToken(token), tableLookup(tree, token)) << token;
+	}
+}
+
+TEST(TokenTrie, automaton)
+{
+	TokenTrie tree;
+	ASSERT_TRUE(tree.registerToken("he", t1));
+	ASSERT_TRUE(tree.registerToken("she", t2));
+	ASSERT_TRUE(tree.registerToken("his", t3));
+	ASSERT_TRUE(tree.registerToken("hers", t4));
+
+	const TokenTrie::Automaton &automaton = tree.getAutomaton();
+	ASSERT_EQ(4U, automaton.maxDepth);
+
+	// Feed "ushers" into the automaton, the state is always the longest suffix
+	// which is a token prefix
+	TokenTrie::Automaton::State state = TokenTrie::Table::ROOT;
+	for (char c : std::string("ush")) {
+		state = automaton.next(state, c);
+	}
+	ASSERT_EQ(2U, automaton.depths[state]);
+	ASSERT_EQ(Tokens::Empty, automaton.ids[state]);
+	state = automaton.next(state, 'e');
+
+	// "she" and "he" end here, longest first
+	TokenTrie::Automaton::State match = automaton.firstMatch(state);
+	ASSERT_EQ(t2, automaton.ids[match]);
+	match = automaton.matchLinks[match];
+	ASSERT_EQ(t1, automaton.ids[match]);
+	ASSERT_EQ(TokenTrie::Table::NONE, automaton.matchLinks[match]);
+
+	// "she" cannot be continued, "he" can
+	TokenTrie::Automaton::State adv = automaton.firstAdvanceable(state);
+	ASSERT_EQ(2U, automaton.depths[adv]);
+	ASSERT_EQ(TokenTrie::Table::NONE, automaton.advanceLinks[adv]);
+
+	state = automaton.next(state, 'r');
+	state = automaton.next(state, 's');
+	ASSERT_EQ(t4, automaton.ids[automaton.firstMatch(state)]);
+
+	// Characters which do not continue any token lead back to the root
+	ASSERT_EQ(TokenTrie::Table::ROOT, automaton.next(state, 'x'));
+	ASSERT_EQ(TokenTrie::Table::NONE,
+	          automaton.firstAdvanceable(TokenTrie::Table::ROOT));
+}
+}
@@ -440,5 +440,56 @@ TEST(TokenizedData, endAtWhitespace)
 	                          12, 16);
 	assertEnd(reader);
 }
+
+TEST(TokenizedData, appendSpan)
+{
+	// Appending spans must produce the same special tokens and locations as
+	// appending single characters
+	const std::string text =
+	    "first line\n  indented\n\n\tmore\n\n\n  text  \n dedent";
+	TokenizedData chars;
+	for (size_t i = 0; i < text.size(); i++) {
+		chars.append(text[i], 10 + i, 11 + i);
+	}
+
+	for (size_t split : {1, 3, 11, 17}) {
+		TokenizedData spans;
+		for (size_t i = 0; i < text.size(); i += split) {
+			const size_t len = std::min(split, text.size() - i);
+			ASSERT_EQ(i + len, spans.appendSpan(&text[i], len, 10 + i));
+		}
+		ASSERT_EQ(chars.size(), spans.size());
+		ASSERT_EQ(chars.hasNonWhitespaceChar(), spans.hasNonWhitespaceChar());
+		ASSERT_EQ(chars.lastCharIsWhitespace(), spans.lastCharIsWhitespace());
+
+		const TokenSet tokens{Tokens::Newline, Tokens::Paragraph,
+		                      Tokens::Section, Tokens::Indent, Tokens::Dedent};
+		TokenizedDataReader expectedReader = chars.reader();
+		TokenizedDataReader reader = spans.reader();
+		Token expected;
+		Token token;
+		while (expectedReader.read(expected, tokens, WhitespaceMode::TRIM)) {
+			ASSERT_TRUE(reader.read(token, tokens, WhitespaceMode::TRIM));
+			EXPECT_EQ(expected.id, token.id);
+			EXPECT_EQ(expected.content, token.content);
+			EXPECT_EQ(expected.getLocation().getStart(),
+			          token.getLocation().getStart());
+			EXPECT_EQ(expected.getLocation().getEnd(),
+			          token.getLocation().getEnd());
+		}
+		assertEnd(reader);
+	}
 }
 
+TEST(TokenizedData, appendSpanProtected)
+{
+	TokenizedData data;
+	data.appendSpan("  a  ", 5, 0, true);
+	data.append("  b  ", 5);
+	data.protect(9);
+
+	TokenizedDataReader reader = data.reader();
+	assertText(reader, "  a    b  ", TokenSet{}, WhitespaceMode::TRIM, 0, 10);
+	assertEnd(reader);
+}
+}
@@ -16,6 +16,8 @@
     along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <sstream>
+
 #include <gtest/gtest.h>
 
 #include <core/common/CharReader.hpp>
@@ -585,5 +587,123 @@ TEST(Tokenizer, ambiguousTokens2)
 		ASSERT_FALSE(tokenizer.read(reader, token, data));
 	}
 }
+
+TEST(Tokenizer, maxDataSize)
+{
+	for (auto engine :
+	     {Tokenizer::Engine::LOOKUPS, Tokenizer::Engine::AHO_CORASICK}) {
+		CharReader reader{"aaaa\xc3\xa4\xc3\xa4" "bb{cc"};
+		//                 0123 4   5   6   7    8901 2
+		//                 0                       1
+		Tokenizer tokenizer{engine};
+		TokenId tBrace = tokenizer.registerToken("{");
+		tokenizer.setMaxDataSize(4);
+		ASSERT_EQ(4U, tokenizer.getMaxDataSize());
+
+		// Data tokens are ended once four characters have been read, but not
+		// inside a UTF-8 sequence
+		assertDataToken(reader, tokenizer, "aaaa", 0, 4, 0, 4);
+		assertDataToken(reader, tokenizer, "\xc3\xa4\xc3\xa4" "b", 4, 9, 4, 9);
+		assertDataToken(reader, tokenizer, "b", 9, 10, 9, 10);
+		assertPrimaryToken(reader, tokenizer, tBrace, "{", 10, 11);
+		assertDataToken(reader, tokenizer, "cc", 11, 13, 11, 13);
+
+		Token token;
+		TokenizedData data;
+		ASSERT_FALSE(tokenizer.read(reader, token, data));
+	}
+}
+
+namespace {
+/**
+ * Simple pseudo random number generator used by the differential test.
+ */
+struct Xorshift {
+	uint32_t v;
+
+	uint32_t operator()(uint32_t n)
+	{
+		v = v ^ (v << 13);
+		v = v ^ (v >> 17);
+		v = v ^ (v << 5);
+		return v % n;
+	}
+};
+
+/**
+ * Reads or peeks all tokens from the given string and serializes them --
+ * including the tokens and text stored in the TokenizedData -- into a string.
+ */
+std::string tokenizeAll(const Tokenizer &tokenizer, const std::string &text,
+                        const TokenSet &nonPrimary, bool peek)
+{
+	std::stringstream ss;
+	CharReader reader{text};
+	Token token;
+	while (true) {
+		TokenizedData data;
+		if (!(peek ? tokenizer.peek(reader, token, data)
+		           : tokenizer.read(reader, token, data))) {
+			break;
+		}
+		ss << token.id << ":" << token.content << "@"
+		   << token.location.getStart() << "-" << token.location.getEnd()
+		   << "[";
+		TokenizedDataReader dataReader = data.reader();
+		Token dataToken;
+		while (dataReader.read(dataToken, nonPrimary,
+		                       WhitespaceMode::PRESERVE)) {
+			ss << dataToken.id << ":" << dataToken.content << "@"
+			   << dataToken.location.getStart() << "-"
+			   << dataToken.location.getEnd() << " ";
+		}
+		ss << "] ";
+	}
+	return ss.str();
+}
 }
 
+TEST(Tokenizer, ahoCorasickDifferential)
+{
+	// Register random sets of overlapping primary and non-primary tokens with
+	// both engines and compare the results for random text
+	Xorshift rnd{0x9E3779B9};
+	const std::string alphabet = "ab\\{}<> \n";
+	for (size_t iteration = 0; iteration < 2000; iteration++) {
+		// Use fewer distinct characters in every other iteration to produce
+		// more overlapping tokens
+		const size_t chars = (iteration % 2) ? 3 : alphabet.size() - 2;
+		Tokenizer lookups{Tokenizer::Engine::LOOKUPS};
+		Tokenizer ahoCorasick{Tokenizer::Engine::AHO_CORASICK};
+		ASSERT_EQ(Tokenizer::Engine::AHO_CORASICK, ahoCorasick.getEngine());
+		TokenSet nonPrimary;
+		const size_t tokenCount = 1 + rnd(8);
+		for (size_t i = 0; i < tokenCount; i++) {
+			std::string str;
+			const size_t len = 1 + rnd(4);
+			for (size_t j = 0; j < len; j++) {
+				str.push_back(alphabet[rnd(chars)]);
+			}
+			const bool primary = rnd(2) == 0;
+			const TokenId id = lookups.registerToken(str, primary);
+			ASSERT_EQ(id, ahoCorasick.registerToken(str, primary));
+			if (id != Tokens::Empty && !primary) {
+				nonPrimary.insert(id);
+			}
+		}
+
+		std::string text;
+		const size_t textLen = rnd(64);
+		for (size_t i = 0; i < textLen; i++) {
+			text.push_back(rnd(8) ? alphabet[rnd(chars)]
+			                      : alphabet[rnd(alphabet.size())]);
+		}
+
+		for (bool peek : {false, true}) {
+			ASSERT_EQ(tokenizeAll(lookups, text, nonPrimary, peek),
+			          tokenizeAll(ahoCorasick, text, nonPrimary, peek))
+			    << "text \"" << text << "\"";
+		}
+	}
+}
+}
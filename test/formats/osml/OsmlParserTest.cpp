@@ -17,6 +17,7 @@
 */
 
 #include <iostream>
+#include <sstream>
 
 #include <gtest/gtest.h>
 
@@ -28,6 +29,8 @@
 #include <core/model/Node.hpp>
 #include <core/model/Project.hpp>
 #include <core/frontend/TerminalLogger.hpp>
+#include <core/resource/ResourceCache.hpp>
+#include <core/resource/ResourceLocator.hpp>
 #include <core/StandaloneEnvironment.hpp>
 
 #include <plugins/filesystem/FileLocator.hpp>
@@ -294,5 +297,156 @@ TEST(OsmlParser, syntaxDescription)
 	ASSERT_FALSE(structure->getShortToken().special);
 	ASSERT_EQ("~", structure->getShortToken().token);
 }
+
+/**
+ * Serializes the structure of the given document entity into a string.
+ */
+static void dumpEntity(Handle<StructureNode> node, std::ostream &os)
+{
+	if (node->isa(&RttiTypes::DocumentPrimitive)) {
+		os << node.cast<DocumentPrimitive>()->getContent();
+		return;
+	}
+	const StructuredEntity *entity =
+	    static_cast<const StructuredEntity *>(node.get());
+	os << entity->getDescriptor()->getName() << "{";
+	for (const auto &field : entity->getFields()) {
+		os << "[";
+		for (const auto &child : field) {
+			dumpEntity(child, os);
+		}
+		os << "]";
+	}
+	os << "}";
 }
 
+/**
+ * Parses the given document with the given resource cache and returns its
+ * structure.
+ */
+static std::string parseCached(StaticResourceLocator &locator,
+                               ResourceCache &cache, const std::string &path)
+{
+	OsmlStandaloneEnvironment env(logger);
+	env.registry.registerResourceLocator(&locator);
+	env.resourceManager.setCache(&cache);
+	logger.reset();
+
+	Rooted<Node> node = env.parse(path, "", "", RttiSet{&RttiTypes::Node});
+	EXPECT_FALSE(logger.hasError());
+	if (node == nullptr || !node->isa(&RttiTypes::Document)) {
+		ADD_FAILURE() << "Expected a document";
+		return std::string{};
+	}
+
+	std::stringstream ss;
+	Rooted<Document> document = node.cast<Document>();
+	for (auto ontology : document->getOntologies()) {
+		ss << ontology->getName() << " ";
+		for (auto structure : ontology->getStructureClasses()) {
+			ss << structure->getName() << " ";
+			for (auto attr : structure->getAttributesDescriptor()
+			                     ->getAttributes()) {
+				ss << attr->getName() << "=" << attr->getDefaultValue() << " ";
+			}
+		}
+	}
+	for (auto typesystem : document->getTypesystems()) {
+		ss << typesystem->getName() << " ";
+	}
+	dumpEntity(document->getRoot(), ss);
+	return ss.str();
+}
+
+TEST(OsmlParser, resourceCache)
+{
+	// Document importing an ontology which itself imports a typesystem and
+	// another ontology
+	StaticResourceLocator locator;
+	locator.store("types.osml",
+	              "\\typesystem#types\n"
+	              "\t\\struct#point\n"
+	              "\t\t\\field#x[type=int,default=1]\n"
+	              "\t\t\\field#y[type=int,default=2]\n"
+	              "\t\\constant#origin[type=point,value=[0,0]]\n");
+	locator.store("base.osml",
+	              "\\ontology#base\n"
+	              "\t\\struct#text[transparent=true]\n"
+	              "\t\t\\primitive[type=string]\n");
+	locator.store("main.osml",
+	              "\\ontology#main\n"
+	              "\t\\import[typesystem]{types.osml}\n"
+	              "\t\\import[ontology]{base.osml}\n"
+	              "\t\\struct#root[root=true]\n"
+	              "\t\t\\attributes\n"
+	              "\t\t\t\\attribute#pos[type=point,default=origin]\n"
+	              "\t\t\\field\n"
+	              "\t\t\t\\childRef[ref=para]\n"
+	              "\t\\struct#para\n"
+	              "\t\t\\field\n"
+	              "\t\t\t\\childRef[ref=text]\n");
+	locator.store("doc.osml",
+	              "\\begin{document}\n"
+	              "\\import[ontology]{main.osml}\n"
+	              "\\import[ontology]{base.osml}\n"
+	              "\\begin{root}\n"
+	              "\\para{Hello}\n"
+	              "\\para{World}\n"
+	              "\\end{root}\n"
+	              "\\end{document}\n");
+
+	// The first run parses and stores all imported resources, the second one
+	// reads them from the cache
+	StaticResourceCache cache;
+	std::string cold = parseCached(locator, cache, "doc.osml");
+	ASSERT_EQ(0U, cache.getHits());
+	ASSERT_EQ(3U, cache.getStores());
+	ASSERT_EQ(3U, cache.size());
+
+	std::string warm = parseCached(locator, cache, "doc.osml");
+	EXPECT_EQ(3U, cache.getHits());
+	EXPECT_EQ(3U, cache.getStores());
+	EXPECT_EQ(cold, warm);
+	EXPECT_NE(std::string::npos, cold.find("pos=["));
+	EXPECT_NE(std::string::npos, cold.find("para{[text{[\"World\"]}]}"));
+
+	// Changing an imported ontology invalidates its entry and the entry of
+	// the importing ontology, the typesystem is still read from the cache
+	locator.store("base.osml",
+	              "\\ontology#base\n"
+	              "\t\\struct#text[transparent=true]\n"
+	              "\t\t\\primitive[type=string]\n"
+	              "\t\\struct#unused\n");
+	std::string changed = parseCached(locator, cache, "doc.osml");
+	EXPECT_EQ(4U, cache.getHits());
+	EXPECT_EQ(5U, cache.getStores());
+	EXPECT_NE(std::string::npos, changed.find("unused"));
+}
+
+TEST(OsmlParser, resourceCacheErrors)
+{
+	// Resources which logged an error are not cached, as the error would not
+	// be reported again in the next run
+	StaticResourceLocator locator;
+	locator.store("main.osml",
+	              "\\ontology#main\n"
+	              "\t\\struct#root[root=true]\n"
+	              "\t\t\\field\n"
+	              "\t\t\t\\childRef[ref=missing]\n");
+
+	StaticResourceCache cache;
+	for (size_t i = 0; i < 2; i++) {
+		OsmlStandaloneEnvironment env(logger);
+		env.registry.registerResourceLocator(&locator);
+		env.resourceManager.setCache(&cache);
+		logger.reset();
+
+		Rooted<Node> node =
+		    env.parse("main.osml", "", "", RttiSet{&RttiTypes::Ontology});
+		ASSERT_TRUE(node != nullptr);
+		ASSERT_TRUE(logger.hasError());
+	}
+	EXPECT_EQ(0U, cache.getHits());
+	EXPECT_EQ(0U, cache.getStores());
+}
+}
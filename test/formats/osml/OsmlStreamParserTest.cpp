@@ -18,7 +18,12 @@
 
 #include <gtest/gtest.h>
 
+#include <fstream>
 #include <iostream>
+#include <memory>
+#include <string>
+
+#include <unistd.h>
 
 #include <core/common/CharReader.hpp>
 #include <core/common/Variant.hpp>
@@ -1465,5 +1470,161 @@ TEST(OsmlStreamParser, commandWithUnderscore)
 	assertData(parser, "_ a", 4, 7);
 	assertEnd(parser);
 }
+
+TEST(OsmlStreamParser, streamingChunks)
+{
+	const std::string text =
+	    "Lorem ipsum dolor sit amet, consetetur sadipscing elitr, sed diam "
+	    "nonumy eirmod tempor invidunt ut labore et dolore magna aliquyam";
+	const std::string testString = text + "\\cmd{" + text + "}";
+	const SourceOffset cmdStart = text.size();
+	const SourceOffset fieldStart = cmdStart + 4;
+
+	CharReader charReader(testString);
+	OsmlStreamParser parser(charReader, logger);
+	parser.setMaxDataChunkSize(16);
+	ASSERT_EQ(16U, parser.getMaxDataChunkSize());
+
+	// The text before the command and inside the field is split into chunks,
+	// the concatenated chunks must form the original text
+	for (size_t i = 0; i < 2; i++) {
+		SourceOffset offs = 0;
+		if (i == 1) {
+			assertCommand(parser, "cmd", cmdStart, fieldStart);
+			assertFieldStart(parser, false, fieldStart, fieldStart + 1);
+			offs = fieldStart + 1;
+		}
+		std::string chunks;
+		while (chunks.size() < text.size()) {
+			ASSERT_EQ(OsmlStreamParser::State::DATA, parser.parse());
+			const TokenizedData &data = parser.getData();
+			ASSERT_LE(data.size(), 16U);
+			EXPECT_EQ(offs, data.getLocation().getStart());
+			offs = data.getLocation().getEnd();
+
+			Token token;
+			TokenizedDataReader dataReader = data.reader();
+			ASSERT_TRUE(
+			    dataReader.read(token, TokenSet{}, WhitespaceMode::PRESERVE));
+			chunks += token.content;
+		}
+		EXPECT_EQ(text, chunks);
+	}
+	assertFieldEnd(parser, testString.size() - 1, testString.size());
+	assertEnd(parser);
+}
+
+#ifdef __linux__
+/**
+ * Returns the number of bytes currently held in physical memory by this
+ * process.
+ */
+static size_t residentSetSize()
+{
+	size_t pages = 0, resident = 0;
+	std::ifstream statm("/proc/self/statm");
+	statm >> pages >> resident;
+	return resident * sysconf(_SC_PAGESIZE);
+}
+
+namespace {
+/**
+ * Generates an OSML document consisting of sections, each of which starts
+ * with a command and contains 64 MiB of text without any command.
+ */
+struct OsmlGenerator {
+	static constexpr size_t BLOCKS_PER_SECTION = 64;
+
+	std::string header;
+	std::string block;
+	size_t blocks;
+	size_t blockIdx;
+	size_t offs;
+
+	OsmlGenerator(size_t size) : blockIdx(0), offs(0)
+	{
+		header = "\\section{Generated \\emph{section}}\n";
+		const std::string sentence =
+		    "Lorem ipsum dolor sit amet, consetetur sadipscing elitr, sed "
+		    "diam nonumy eirmod tempor invidunt ut labore et dolore magna.\n";
+		while (block.size() < 1024 * 1024) {
+			block += sentence;
+		}
+		blocks = size / block.size() + 1;
+	}
+
+	size_t size() const
+	{
+		const size_t sections =
+		    (blocks + BLOCKS_PER_SECTION - 1) / BLOCKS_PER_SECTION;
+		return blocks * block.size() + sections * header.size();
+	}
+
+	static size_t read(char *buf, size_t size, void *userData)
+	{
+		OsmlGenerator &gen = *static_cast<OsmlGenerator *>(userData);
+		size_t n = 0;
+		while (n < size && gen.blockIdx < gen.blocks) {
+			// Each section starts with the header, followed by the blocks
+			const bool hasHeader = gen.blockIdx % BLOCKS_PER_SECTION == 0;
+			const size_t headerSize = hasHeader ? gen.header.size() : 0;
+			const size_t m = std::min(
+			    size - n, headerSize + gen.block.size() - gen.offs);
+			for (size_t i = 0; i < m; i++, gen.offs++) {
+				buf[n + i] = gen.offs < headerSize
+				                 ? gen.header[gen.offs]
+				                 : gen.block[gen.offs - headerSize];
+			}
+			n += m;
+			if (gen.offs == headerSize + gen.block.size()) {
+				gen.blockIdx++;
+				gen.offs = 0;
+			}
+		}
+		return n;
+	}
+};
+}
+
+TEST(OsmlStreamParser, streamingMemoryBound)
+{
+	// Parse a generated 500 MB document in streaming mode, the resident set
+	// size must not grow by more than the given cap
+	const size_t MAX_CHUNK_SIZE = 64 * 1024;
+	const size_t RSS_CAP = 32 * 1024 * 1024;
+	OsmlGenerator gen{500 * 1024 * 1024};
+	const size_t size = gen.size();
+
+	const size_t rss0 = residentSetSize();
+	size_t maxRss = rss0;
+	{
+		CharReader charReader(
+		    std::make_shared<Buffer>(OsmlGenerator::read, &gen));
+		OsmlStreamParser parser(charReader, logger);
+		parser.setMaxDataChunkSize(MAX_CHUNK_SIZE);
+
+		size_t events = 0, chunks = 0, dataSize = 0;
+		OsmlStreamParser::State state;
+		while ((state = parser.parse()) != OsmlStreamParser::State::END) {
+			if (state == OsmlStreamParser::State::DATA) {
+				ASSERT_LE(parser.getData().size(), MAX_CHUNK_SIZE);
+				dataSize += parser.getData().size();
+				chunks++;
+			}
+			if (++events % 1024 == 0) {
+				maxRss = std::max(maxRss, residentSetSize());
+			}
+		}
+		maxRss = std::max(maxRss, residentSetSize());
+
+		// Almost all of the input is text, which must have been split into
+		// chunks
+		EXPECT_EQ(size, charReader.getOffset());
+		EXPECT_GT(dataSize, size * 9 / 10);
+		EXPECT_GT(chunks, size / MAX_CHUNK_SIZE);
+	}
+	EXPECT_LT(maxRss - rss0, RSS_CAP);
+}
+#endif
 }
 
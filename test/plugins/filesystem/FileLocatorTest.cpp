@@ -20,6 +20,7 @@
 
 #include <set>
 
+#include <core/common/CharReader.hpp>
 #include <plugins/filesystem/FileLocator.hpp>
 #include <plugins/filesystem/SpecialPaths.hpp>
 
@@ -211,6 +212,24 @@ TEST(FileLocator, testStream)
 	ASSERT_EQ("file a", line);
 }
 
+TEST(FileLocator, testBuffer)
+{
+	FileLocator locator;
+	locator.addUnittestSearchPath("filesystem");
+
+	Resource res;
+	locator.locate(res, "a.txt");
+
+	// Read the memory mapped file through a CharReader
+	CharReader reader{res.buffer()};
+	std::string content;
+	char c;
+	while (reader.read(c)) {
+		content.append(&c, 1);
+	}
+	ASSERT_EQ("file a\n", content);
+}
+
 TEST(FileLocator, testDefaultSearchPaths)
 {
 	FileLocator locator;
@@ -0,0 +1,95 @@
+/*
+    Ousía
+    Copyright (C) 2014, 2015  Benjamin Paaßen, Andreas Stöckel
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <gtest/gtest.h>
+
+#include <plugins/filesystem/FileResourceCache.hpp>
+
+#include <boost/filesystem.hpp>
+
+namespace fs = boost::filesystem;
+
+namespace ousia {
+
+static ResourceCache::Entry createEntry()
+{
+	ResourceCache::Entry entry;
+	entry.contentHash = 42;
+	entry.dependencies.push_back(
+	    ResourceCache::Dependency{"types.osml", "", "typesystem",
+	                              {"Typesystem"}, 0x0123456789ABCDEFULL});
+	entry.graph = std::string("graph\0data", 10);
+	return entry;
+}
+
+TEST(FileResourceCache, storeLoad)
+{
+	const fs::path dir = fs::temp_directory_path() /
+	                     fs::unique_path("ousia_cache_test_%%%%-%%%%-%%%%");
+	{
+		// The directory is created when the first entry is stored
+		FileResourceCache cache{(dir / "sub").string()};
+		ResourceCache::Entry entry;
+		ASSERT_FALSE(cache.load("/a/b.osml", "", 42, entry));
+		cache.store("/a/b.osml", "", createEntry());
+		ASSERT_TRUE(fs::is_directory(dir / "sub"));
+		ASSERT_EQ(1U, cache.getStores());
+	}
+
+	{
+		// The entry can be read by another instance
+		FileResourceCache cache{(dir / "sub").string()};
+		ResourceCache::Entry entry;
+		ASSERT_TRUE(cache.load("/a/b.osml", "", 42, entry));
+		ASSERT_EQ(42U, entry.contentHash);
+		ASSERT_EQ(std::string("graph\0data", 10), entry.graph);
+		ASSERT_EQ(1U, entry.dependencies.size());
+		EXPECT_EQ("types.osml", entry.dependencies[0].path);
+		EXPECT_EQ("", entry.dependencies[0].mimetype);
+		EXPECT_EQ("typesystem", entry.dependencies[0].rel);
+		EXPECT_EQ(std::vector<std::string>{"Typesystem"},
+		          entry.dependencies[0].supportedTypes);
+		EXPECT_EQ(0x0123456789ABCDEFULL, entry.dependencies[0].graphHash);
+
+		// Other content, locations or mimetypes do not match the entry
+		EXPECT_FALSE(cache.load("/a/b.osml", "", 43, entry));
+		EXPECT_FALSE(cache.load("/a/c.osml", "", 42, entry));
+		EXPECT_FALSE(cache.load("/a/b.osml", "text/vnd.ousia.osml", 42, entry));
+	}
+
+	{
+		// Entries written by another parser version are ignored
+		FileResourceCache cache{(dir / "sub").string(),
+		                        ResourceCache::PARSER_VERSION + 1};
+		ResourceCache::Entry entry;
+		EXPECT_FALSE(cache.load("/a/b.osml", "", 42, entry));
+	}
+
+	{
+		// Truncated entries are ignored
+		const fs::path file =
+		    dir / "sub" / ResourceCache::key("/a/b.osml", "");
+		fs::resize_file(file, fs::file_size(file) - 1);
+		FileResourceCache cache{(dir / "sub").string()};
+		ResourceCache::Entry entry;
+		EXPECT_FALSE(cache.load("/a/b.osml", "", 42, entry));
+	}
+
+	fs::remove_all(dir);
+}
+}
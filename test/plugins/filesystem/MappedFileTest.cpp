@@ -0,0 +1,58 @@
+/*
+    Ousía
+    Copyright (C) 2014, 2015  Benjamin Paaßen, Andreas Stöckel
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <gtest/gtest.h>
+
+#include <fstream>
+
+#include <core/common/Exceptions.hpp>
+#include <plugins/filesystem/MappedFile.hpp>
+
+#include <boost/filesystem.hpp>
+
+namespace fs = boost::filesystem;
+
+namespace ousia {
+TEST(MappedFile, map)
+{
+	const fs::path path = fs::temp_directory_path() /
+	                      fs::unique_path("ousia_mapped_file_%%%%-%%%%-%%%%");
+	const std::string content("binary\0content", 14);
+	{
+		std::ofstream os(path.string(), std::ios::binary);
+		os.write(content.data(), content.size());
+	}
+	{
+		MappedFile file{path.string()};
+		ASSERT_EQ(content.size(), file.getSize());
+		EXPECT_EQ(content, std::string(file.getData(), file.getSize()));
+	}
+
+	// Empty files are mapped to nullptr
+	fs::resize_file(path, 0);
+	{
+		MappedFile file{path.string()};
+		EXPECT_EQ(0U, file.getSize());
+		EXPECT_EQ(nullptr, file.getData());
+	}
+	fs::remove(path);
+
+	ASSERT_THROW(MappedFile{path.string()}, LoggableException);
+}
+}
+